@@ -0,0 +1,52 @@
+#ifndef __HL_BENCHMARK_H__
+#define __HL_BENCHMARK_H__
+
+#include <chrono>
+#include <stdio.h>
+
+// minimal timing helpers, every benchmark file exposes one Run*Benchmarks() entry point
+
+class BenchmarkTimer {
+public:
+	BenchmarkTimer()
+		: m_Start(std::chrono::high_resolution_clock::now())
+	{}
+
+	double ElapsedMs() const {
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - m_Start;
+		return elapsed.count();
+	}
+
+private:
+	std::chrono::high_resolution_clock::time_point m_Start;
+};
+
+// xorshift, so every scheme sees exactly the same sequence of requests
+class BenchmarkRandom {
+public:
+	explicit BenchmarkRandom(unsigned int seed)
+		: m_State(seed ? seed : 0x9e3779b9u)
+	{}
+
+	unsigned int Next() {
+		m_State ^= m_State << 13;
+		m_State ^= m_State >> 17;
+		m_State ^= m_State << 5;
+		return m_State;
+	}
+
+	unsigned int Range(unsigned int minValue, unsigned int maxValue) {
+		return minValue + Next() % (maxValue - minValue + 1);
+	}
+
+private:
+	unsigned int m_State;
+};
+
+void RunFragmentationBenchmarks();
+void RunHeaderLayoutBenchmarks();
+void RunSlabBenchmarks();
+void RunStdBenchmarks();
+void RunSamplingBenchmarks();
+
+#endif // __HL_BENCHMARK_H__
@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+// first-fit freelist vs tlsf, after the region has been fragmented by freeing a given
+// percentage of a long run of small allocations
+
+typedef allocator<freelist_scheme, no_tracking_policy>	FreelistAllocator;
+typedef allocator<tlsf_scheme, no_tracking_policy>		TLSFAllocator;
+
+static memory_manager									s_MemoryManager;
+static FreelistAllocator								s_FreelistAllocator;
+static TLSFAllocator									s_TLSFAllocator;
+
+static const unsigned int								k_FillCount = 20000;
+static const unsigned int								k_ChurnCount = 200000;
+
+template <class t_allocator>
+static double RunChurn(t_allocator& alloc, const unsigned int fragmentationPercent)
+{
+	BenchmarkRandom rng(1234);
+	std::vector<voidptr> live;
+	live.reserve(k_FillCount);
+
+	alloc.free_all();
+
+	// fill, then punch holes
+	for (unsigned int i = 0; i < k_FillCount; i++) {
+		live.push_back(alloc.allocate(rng.Range(16, 512)));
+	}
+	size_t kept = 0;
+	for (size_t i = 0; i < live.size(); i++) {
+		if (rng.Range(0, 99) < fragmentationPercent) {
+			alloc.free(live[i]);
+		} else {
+			live[kept++] = live[i];
+		}
+	}
+	live.resize(kept);
+
+	// steady state: every step allocates one block and releases a random live one
+	BenchmarkTimer timer;
+	for (unsigned int i = 0; i < k_ChurnCount; i++) {
+		voidptr p = alloc.allocate(rng.Range(16, 512));
+		if (p) {
+			live.push_back(p);
+		}
+		if (!live.empty()) {
+			size_t idx = rng.Next() % live.size();
+			alloc.free(live[idx]);
+			live[idx] = live.back();
+			live.pop_back();
+		}
+	}
+	return timer.ElapsedMs();
+}
+
+void RunFragmentationBenchmarks()
+{
+	s_MemoryManager.initialize(
+		memory_region<FreelistAllocator> { "bench/freelist", SIZE_MB(32), &s_FreelistAllocator },
+		memory_region<TLSFAllocator> { "bench/tlsf", SIZE_MB(32), &s_TLSFAllocator }
+	);
+
+	printf("[fragmentation] %u alloc/free pairs of 16..512 bytes\n", k_ChurnCount);
+	printf("%-16s %14s %14s\n", "holes", "freelist (ms)", "tlsf (ms)");
+	const unsigned int fragmentations[] = { 0, 25, 50, 75, 90 };
+	for (unsigned int i = 0; i < sizeof(fragmentations) / sizeof(fragmentations[0]); i++) {
+		double freelistMs = RunChurn(s_FreelistAllocator, fragmentations[i]);
+		double tlsfMs = RunChurn(s_TLSFAllocator, fragmentations[i]);
+		char label[16];
+		snprintf(label, sizeof(label), "%u%%", fragmentations[i]);
+		printf("%-16s %14.2f %14.2f\n", label, freelistMs, tlsfMs);
+	}
+}
@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+// bytes per object and alloc/free throughput of the full and compact header layouts
+
+typedef compact_header_policy<no_tracking_policy>						CompactPolicy;
+
+typedef fixed_allocator<pool_scheme, 27, no_tracking_policy>			FullPoolAllocator;
+typedef fixed_allocator<pool_scheme, 27, CompactPolicy>					CompactPoolAllocator;
+typedef allocator<stack_scheme, no_tracking_policy>						FullStackAllocator;
+typedef allocator<stack_scheme, CompactPolicy>							CompactStackAllocator;
+
+static memory_manager													s_MemoryManager;
+static FullPoolAllocator												s_FullPoolAllocator;
+static CompactPoolAllocator												s_CompactPoolAllocator;
+static FullStackAllocator												s_FullStackAllocator;
+static CompactStackAllocator											s_CompactStackAllocator;
+
+static const unsigned int												k_ObjectCount = 100000;
+static const unsigned int												k_Rounds = 20;
+
+template <class t_allocator>
+static double RunPool(t_allocator& allocator)
+{
+	// fixed_allocator hides the raw allocate() behind its typed overload
+	typename t_allocator::alloc_scheme_t& alloc = allocator;
+	std::vector<voidptr> objs(k_ObjectCount);
+	BenchmarkTimer timer;
+	for (unsigned int r = 0; r < k_Rounds; r++) {
+		for (unsigned int i = 0; i < k_ObjectCount; i++) {
+			objs[i] = alloc.allocate();
+		}
+		for (unsigned int i = 0; i < k_ObjectCount; i++) {
+			alloc.free(objs[i]);
+		}
+	}
+	return timer.ElapsedMs();
+}
+
+template <class t_allocator>
+static double RunStack(t_allocator& alloc)
+{
+	BenchmarkTimer timer;
+	for (unsigned int r = 0; r < k_Rounds; r++) {
+		for (unsigned int i = 0; i < k_ObjectCount; i++) {
+			alloc.allocate(27);
+		}
+		alloc.free_all();
+	}
+	return timer.ElapsedMs();
+}
+
+void RunHeaderLayoutBenchmarks()
+{
+	s_MemoryManager.initialize(
+		memory_region<FullPoolAllocator> { "bench/full_pool", SIZE_MB(16), &s_FullPoolAllocator },
+		memory_region<CompactPoolAllocator> { "bench/compact_pool", SIZE_MB(16), &s_CompactPoolAllocator },
+		memory_region<FullStackAllocator> { "bench/full_stack", SIZE_MB(16), &s_FullStackAllocator },
+		memory_region<CompactStackAllocator> { "bench/compact_stack", SIZE_MB(16), &s_CompactStackAllocator }
+	);
+
+	printf("[header layout] %u x %u allocations of 27 bytes\n", k_Rounds, k_ObjectCount);
+	printf("%-16s %16s %14s\n", "layout", "bytes/object", "time (ms)");
+	printf("%-16s %16zu %14.2f\n", "pool/full", s_FullPoolAllocator.get_element_size(), RunPool(s_FullPoolAllocator));
+	printf("%-16s %16zu %14.2f\n", "pool/compact", s_CompactPoolAllocator.get_element_size(), RunPool(s_CompactPoolAllocator));
+	printf("%-16s %16zu %14.2f\n", "stack/full", FullStackAllocator::get_real_data_size((size)27), RunStack(s_FullStackAllocator));
+	printf("%-16s %16zu %14.2f\n", "stack/compact", CompactStackAllocator::get_real_data_size((size)27), RunStack(s_CompactStackAllocator));
+}
@@ -0,0 +1,111 @@
+#include "Benchmark.h"
+
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+// cost of sampled_tracking_policy at its default interval next to no tracking at all, on the slab and
+// freelist churn of the slab benchmarks, and how close the live bytes estimate gets
+
+typedef allocator<slab_scheme, no_tracking_policy>					UntrackedSlabAllocator;
+typedef allocator<slab_scheme, sampled_tracking_policy>				SampledSlabAllocator;
+typedef allocator<freelist_scheme, no_tracking_policy>				UntrackedFreelistAllocator;
+typedef allocator<freelist_scheme, sampled_tracking_policy>			SampledFreelistAllocator;
+
+static memory_manager												s_MemoryManager;
+static UntrackedSlabAllocator										s_UntrackedSlabAllocator;
+static SampledSlabAllocator											s_SampledSlabAllocator;
+static UntrackedFreelistAllocator									s_UntrackedFreelistAllocator;
+static SampledFreelistAllocator										s_SampledFreelistAllocator;
+
+static const unsigned int											k_LiveCount = 10000;
+static const unsigned int											k_ChurnCount = 1000000;
+static const unsigned int											k_Runs = 5;
+
+static unsigned int NextSampledSize(BenchmarkRandom& rng)
+{
+	if (rng.Range(0, 3) != 0) {
+		return rng.Range(8, 256);
+	}
+	return rng.Range(257, 4096);
+}
+
+template <class t_allocator>
+static double RunChurn(t_allocator& alloc, size* o_liveBytes)
+{
+	BenchmarkRandom rng(8765);
+	std::vector<voidptr> live;
+	std::vector<unsigned int> liveSizes;
+	live.reserve(k_LiveCount + 1);
+	liveSizes.reserve(k_LiveCount + 1);
+
+	alloc.free_all();
+	for (unsigned int i = 0; i < k_LiveCount; i++) {
+		unsigned int bytes = NextSampledSize(rng);
+		live.push_back(alloc.allocate(bytes));
+		liveSizes.push_back(bytes);
+	}
+
+	BenchmarkTimer timer;
+	for (unsigned int i = 0; i < k_ChurnCount; i++) {
+		unsigned int bytes = NextSampledSize(rng);
+		voidptr p = alloc.allocate(bytes);
+		if (p) {
+			live.push_back(p);
+			liveSizes.push_back(bytes);
+		}
+		size_t idx = rng.Next() % live.size();
+		alloc.free(live[idx]);
+		live[idx] = live.back();
+		liveSizes[idx] = liveSizes.back();
+		live.pop_back();
+		liveSizes.pop_back();
+	}
+	double elapsedMs = timer.ElapsedMs();
+
+	*o_liveBytes = 0;
+	for (size_t i = 0; i < liveSizes.size(); i++) {
+		*o_liveBytes += liveSizes[i];
+	}
+	return elapsedMs;
+}
+
+// the machine is rarely quiet enough for a single run, best of k_Runs alternating runs
+template <class t_untracked, class t_sampled>
+static void RunPair(const char* name, t_untracked& untracked, t_sampled& sampled)
+{
+	size liveBytes = 0;
+	size estimate = 0;
+	double untrackedMs = 0.0;
+	double sampledMs = 0.0;
+	for (unsigned int r = 0; r < k_Runs; r++) {
+		const double runUntrackedMs = RunChurn(untracked, &liveBytes);
+		const size estimateBefore = sampled_tracking_policy::get_estimated_live_bytes();
+		const double runSampledMs = RunChurn(sampled, &liveBytes);
+		estimate = sampled_tracking_policy::get_estimated_live_bytes() - estimateBefore;
+
+		untrackedMs = (r == 0 || runUntrackedMs < untrackedMs) ? runUntrackedMs : untrackedMs;
+		sampledMs = (r == 0 || runSampledMs < sampledMs) ? runSampledMs : sampledMs;
+	}
+
+	printf("%-12s %14.2f %14.2f %9.2f%% %12zu %12zu\n", name, untrackedMs, sampledMs,
+		(sampledMs - untrackedMs) * 100.0 / untrackedMs, (size_t)liveBytes, (size_t)estimate);
+}
+
+void RunSamplingBenchmarks()
+{
+	s_MemoryManager.initialize(
+		memory_region<UntrackedSlabAllocator> { "bench/slab", SIZE_MB(64), &s_UntrackedSlabAllocator },
+		memory_region<SampledSlabAllocator> { "bench/sampled_slab", SIZE_MB(64), &s_SampledSlabAllocator },
+		memory_region<UntrackedFreelistAllocator> { "bench/freelist", SIZE_MB(64), &s_UntrackedFreelistAllocator },
+		memory_region<SampledFreelistAllocator> { "bench/sampled_freelist", SIZE_MB(64), &s_SampledFreelistAllocator }
+	);
+
+	printf("[sampling] %u alloc/free pairs, %u live blocks, one sample per %zu bytes\n", k_ChurnCount, k_LiveCount,
+		(size_t)sampled_tracking_policy::get_sample_interval());
+	printf("%-12s %14s %14s %10s %12s %12s\n", "scheme", "untracked (ms)", "sampled (ms)", "overhead", "live bytes", "estimate");
+	RunPair("slab", s_UntrackedSlabAllocator, s_SampledSlabAllocator);
+	RunPair("freelist", s_UntrackedFreelistAllocator, s_SampledFreelistAllocator);
+}
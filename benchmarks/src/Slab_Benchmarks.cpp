@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+// size-class slabs vs first-fit freelist, on a mixed 8..4096 bytes workload skewed towards small
+// blocks the way general purpose allocations usually are
+
+typedef allocator<slab_scheme, no_tracking_policy>		SlabAllocator;
+typedef allocator<freelist_scheme, no_tracking_policy>	FreelistAllocator;
+
+static memory_manager									s_MemoryManager;
+static SlabAllocator									s_SlabAllocator;
+static FreelistAllocator								s_FreelistAllocator;
+
+static const unsigned int								k_LiveCount = 10000;
+static const unsigned int								k_ChurnCount = 500000;
+
+static unsigned int NextMixedSize(BenchmarkRandom& rng)
+{
+	// 3/4 of the requests up to 256 bytes, the rest up to 4096
+	if (rng.Range(0, 3) != 0) {
+		return rng.Range(8, 256);
+	}
+	return rng.Range(257, 4096);
+}
+
+template <class t_allocator>
+static double RunMixed(t_allocator& alloc)
+{
+	BenchmarkRandom rng(4321);
+	std::vector<voidptr> live;
+	live.reserve(k_LiveCount + 1);
+
+	alloc.free_all();
+	for (unsigned int i = 0; i < k_LiveCount; i++) {
+		live.push_back(alloc.allocate(NextMixedSize(rng)));
+	}
+
+	BenchmarkTimer timer;
+	for (unsigned int i = 0; i < k_ChurnCount; i++) {
+		voidptr p = alloc.allocate(NextMixedSize(rng));
+		if (p) {
+			live.push_back(p);
+		}
+		size_t idx = rng.Next() % live.size();
+		alloc.free(live[idx]);
+		live[idx] = live.back();
+		live.pop_back();
+	}
+	double elapsedMs = timer.ElapsedMs();
+
+	for (size_t i = 0; i < live.size(); i++) {
+		alloc.free(live[i]);
+	}
+	return elapsedMs;
+}
+
+void RunSlabBenchmarks()
+{
+	s_MemoryManager.initialize(
+		memory_region<SlabAllocator> { "bench/slab", SIZE_MB(64), &s_SlabAllocator },
+		memory_region<FreelistAllocator> { "bench/freelist", SIZE_MB(64), &s_FreelistAllocator }
+	);
+
+	printf("[slab] %u alloc/free pairs of 8..4096 bytes, %u live blocks\n", k_ChurnCount, k_LiveCount);
+	printf("%-16s %14s\n", "scheme", "time (ms)");
+	printf("%-16s %14.2f\n", "freelist", RunMixed(s_FreelistAllocator));
+	printf("%-16s %14.2f\n", "slab", RunMixed(s_SlabAllocator));
+
+	u32 slabCount = 0;
+	for (u32 i = 0; i < SlabAllocator::k_class_count; i++) {
+		slabCount += s_SlabAllocator.get_class_stats(i).slab_count;
+	}
+	printf("slabs kept after the run: %u (%u KB)\n", slabCount, (u32)(slabCount * SlabAllocator::k_slab_size / 1024));
+}
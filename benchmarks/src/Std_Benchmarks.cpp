@@ -0,0 +1,99 @@
+#include "Benchmark.h"
+
+#include <helich.h>
+#include <helich/std_allocator.h>
+
+#include <list>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+using namespace helich;
+
+// std containers on helich regions through memory_resource<> vs the same containers on the default heap
+
+typedef allocator<stack_scheme, no_tracking_policy>					StackAllocator;
+typedef allocator<freelist_scheme, no_tracking_policy>				FreelistAllocator;
+typedef fixed_allocator<pool_scheme, 64, no_tracking_policy>		PoolAllocator;
+
+static memory_manager												s_MemoryManager;
+static StackAllocator												s_StackAllocator;
+static FreelistAllocator											s_FreelistAllocator;
+static PoolAllocator												s_PoolAllocator;
+
+static const unsigned int											k_Rounds = 50;
+static const unsigned int											k_VectorCount = 100000;
+static const unsigned int											k_MapCount = 20000;
+static const unsigned int											k_ListCount = 20000;
+
+// a growing vector only gives its last buffer back to the stack, roll the region back between rounds
+static void ResetStack()
+{
+	s_StackAllocator.free_all();
+}
+
+static double RunVector(std::pmr::memory_resource* resource)
+{
+	BenchmarkTimer timer;
+	for (unsigned int r = 0; r < k_Rounds; r++) {
+		{
+			std::pmr::vector<unsigned int> values(resource);
+			for (unsigned int i = 0; i < k_VectorCount; i++) {
+				values.push_back(i);
+			}
+		}
+		ResetStack();
+	}
+	return timer.ElapsedMs();
+}
+
+static double RunMap(std::pmr::memory_resource* resource)
+{
+	BenchmarkTimer timer;
+	for (unsigned int r = 0; r < k_Rounds; r++) {
+		BenchmarkRandom rng(1234 + r);
+		std::pmr::unordered_map<unsigned int, unsigned int> values(resource);
+		for (unsigned int i = 0; i < k_MapCount; i++) {
+			values[rng.Next()] = i;
+		}
+		for (unsigned int i = 0; i < k_MapCount / 2; i++) {
+			values.erase(values.begin());
+		}
+	}
+	return timer.ElapsedMs();
+}
+
+static double RunList(std::pmr::memory_resource* resource)
+{
+	BenchmarkTimer timer;
+	for (unsigned int r = 0; r < k_Rounds; r++) {
+		std::pmr::list<unsigned int> values(resource);
+		for (unsigned int i = 0; i < k_ListCount; i++) {
+			values.push_back(i);
+		}
+		for (std::pmr::list<unsigned int>::iterator it = values.begin(); it != values.end(); ) {
+			it = (*it & 1) ? values.erase(it) : std::next(it);
+		}
+	}
+	return timer.ElapsedMs();
+}
+
+void RunStdBenchmarks()
+{
+	s_MemoryManager.initialize(
+		memory_region<StackAllocator> { "bench/stack", SIZE_MB(16), &s_StackAllocator },
+		memory_region<FreelistAllocator> { "bench/freelist", SIZE_MB(16), &s_FreelistAllocator },
+		memory_region<PoolAllocator> { "bench/pool", SIZE_MB(4), &s_PoolAllocator }
+	);
+
+	memory_resource<StackAllocator> stackResource(&s_StackAllocator);
+	memory_resource<FreelistAllocator> freelistResource(&s_FreelistAllocator);
+	memory_resource<PoolAllocator> poolResource(&s_PoolAllocator);
+	std::pmr::memory_resource* heapResource = std::pmr::new_delete_resource();
+
+	printf("[std] %u rounds of pmr containers, helich region vs new/delete\n", k_Rounds);
+	printf("%-36s %14s %14s\n", "workload", "helich (ms)", "heap (ms)");
+	printf("%-36s %14.2f %14.2f\n", "vector push_back (stack)", RunVector(&stackResource), RunVector(heapResource));
+	printf("%-36s %14.2f %14.2f\n", "unordered_map insert/erase (freelist)", RunMap(&freelistResource), RunMap(heapResource));
+	printf("%-36s %14.2f %14.2f\n", "list push_back/erase (pool<64>)", RunList(&poolResource), RunList(heapResource));
+}
@@ -0,0 +1,13 @@
+#include "Benchmark.h"
+
+#include <helich.h>
+
+int main(int argc, char** argv)
+{
+	RunFragmentationBenchmarks();
+	RunHeaderLayoutBenchmarks();
+	RunSlabBenchmarks();
+	RunStdBenchmarks();
+	RunSamplingBenchmarks();
+	return 0;
+}
@@ -4,8 +4,15 @@
 #include <helich/utils.h>
 
 #include <helich/alloc_schemes.h>
+#include <helich/trace_table.h>
 #include <helich/tracking_policies.h>
+#include <helich/locking_policies.h>
 #include <helich/allocator.h>
+#include <helich/frame_allocator.h>
+#include <helich/scoped_stack_frame.h>
+#include <helich/numa_replicated_allocator.h>
+#include <helich/handle_pool.h>
+#include <helich/defrag_heap.h>
 
 #include <helich/memory_manager.h>
 #include <helich/memory_debug.h>
@@ -2,18 +2,29 @@
 
 #include <floral/stdaliases.h>
 
+#include <atomic>
+
 namespace helich
 {
 // ----------------------------------------------------------------------------
 
 /*
- * types of allocation header:
+ * types of allocation header (full layout):
  *	> VariableSize
  *		>> Tracked
  *		>> Untracked
  *	> FixedSize
  *		>> Tracked
  *		>> Untracked
+ *	> Coalescing (VariableSize + boundary tag)
+ *		>> Tracked
+ *		>> Untracked
+ *	> LockFree (FixedSize, no live-allocation list)
+ *		>> Tracked
+ *		>> Untracked
+ *
+ * the compact layout drops the description and the live-allocation list, only what the
+ * scheme itself needs to work is kept
  */
 
 template <class t_tracking_header>
@@ -37,6 +48,101 @@ struct variable_size_alloc_header : t_tracking_header
 	size										adjustment;
 };
 
+// boundary-tagged header for schemes which coalesce free blocks (freelist, tlsf): it also keeps
+// the physically preceding block and whether this block is currently free, so both physical
+// neighbours are reachable in O(1). while a block is free, 'next_alloc' and 'prev_alloc' link
+// it into the scheme's free list
+template <class t_tracking_header>
+struct coalescing_alloc_header : t_tracking_header
+{
+	coalescing_alloc_header*							next_alloc;
+	coalescing_alloc_header*							prev_alloc;
+	coalescing_alloc_header*							prev_phys_block;
+	c8											description[64];
+	size										frame_size;
+	size										adjustment;
+	bool										is_free;
+};
+
+// lock-free pools cannot maintain the doubly linked live-allocation list, so their slots only
+// carry the link of the free stack. it is atomic because a popping thread may read it while the
+// slot is being pushed back by another thread (the read value is then discarded by the CAS)
+template <class t_tracking_header>
+struct lockfree_alloc_header : t_tracking_header
+{
+	std::atomic<u32>							next_free;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// compact layout
+
+template <class t_tracking_header>
+struct compact_fixed_size_alloc_header : t_tracking_header
+{
+};
+
+template <class t_tracking_header>
+struct compact_variable_size_alloc_header : t_tracking_header
+{
+	size										frame_size;
+	size										adjustment;
+};
+
+// 'next_alloc' and 'prev_alloc' only link free blocks here
+template <class t_tracking_header>
+struct compact_coalescing_alloc_header : t_tracking_header
+{
+	compact_coalescing_alloc_header*			next_alloc;
+	compact_coalescing_alloc_header*			prev_alloc;
+	compact_coalescing_alloc_header*			prev_phys_block;
+	size										frame_size;
+	size										adjustment;
+	bool										is_free;
+};
+
+template <class t_alloc_header>
+struct alloc_header_traits
+{
+	static const bool							k_has_live_list = true;
+};
+
+template <class t_tracking_header>
+struct alloc_header_traits<compact_fixed_size_alloc_header<t_tracking_header> >
+{
+	static const bool							k_has_live_list = false;
+};
+
+template <class t_tracking_header>
+struct alloc_header_traits<compact_variable_size_alloc_header<t_tracking_header> >
+{
+	static const bool							k_has_live_list = false;
+};
+
+template <class t_tracking_header>
+struct alloc_header_traits<compact_coalescing_alloc_header<t_tracking_header> >
+{
+	static const bool							k_has_live_list = false;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// header layouts, selected through the tracking policy's 'header_layout_t'
+
+class full_header_layout
+{
+public:
+	template <class t_tracking_header> using fixed_size_header_t = fixed_size_alloc_header<t_tracking_header>;
+	template <class t_tracking_header> using variable_size_header_t = variable_size_alloc_header<t_tracking_header>;
+	template <class t_tracking_header> using coalescing_header_t = coalescing_alloc_header<t_tracking_header>;
+};
+
+class compact_header_layout
+{
+public:
+	template <class t_tracking_header> using fixed_size_header_t = compact_fixed_size_alloc_header<t_tracking_header>;
+	template <class t_tracking_header> using variable_size_header_t = compact_variable_size_alloc_header<t_tracking_header>;
+	template <class t_tracking_header> using coalescing_header_t = compact_coalescing_alloc_header<t_tracking_header>;
+};
+
 struct debug_entry;
 struct tracked_alloc_header
 {
@@ -47,5 +153,11 @@ struct untracked_alloc_header
 {
 };
 
+struct sample_entry;
+struct sampled_alloc_header
+{
+	sample_entry*								sample_info;			// nullptr unless the allocation was sampled
+};
+
 // ----------------------------------------------------------------------------
 }
@@ -2,39 +2,81 @@
 
 // self-provided headers
 #include "macros.h"
+#include "locking_policies.h"
 #include "detail/alloc_region.h"
+#include "detail/alloc_header_ops.h"
+#include "detail/thread_slot.h"
 #include "alloc_headers.h"
+#include "utils.h"
 
 // 3rd-party headers
 #include <floral.h>
 
+#include <atomic>
+#include <string.h>
+#include <type_traits>
+
 namespace helich {
 
-template <class t_tracking>
+template <class t_tracking, class t_locking>
 class stack_scheme : 
-	private detail::alloc_region<variable_size_alloc_header<typename t_tracking::alloc_header_t> > 
+	private detail::alloc_region<typename t_tracking::header_layout_t::template variable_size_header_t<typename t_tracking::alloc_header_t>, t_locking> 
 {
 public:
 	typedef typename t_tracking::alloc_header_t         	tracking_header_t;
-	typedef variable_size_alloc_header<tracking_header_t>	alloc_header_t;
-	typedef detail::alloc_region<alloc_header_t>        	alloc_region_t;
+	typedef typename t_tracking::header_layout_t::template variable_size_header_t<tracking_header_t>	alloc_header_t;
+	typedef detail::alloc_region<alloc_header_t, t_locking>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t			lock_guard_t;
+
+	// headers sit right before the data, so the data is never less aligned than the header
+	static const size						k_min_alignment = max_alignment(HL_ALIGNMENT, alignof(alloc_header_t));
+
+	// top of the stack at some point in time, see get_marker() / free_to_marker()
+	struct marker
+	{
+		p8									address;
+		alloc_header_t*						last_alloc;
+	};
 
 public:
 	stack_scheme();
 	
 	void									map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name);
+	// i_sizeInBytes are only reserved, the first i_committedBytes are backed by memory and the rest is committed
+	// through i_commitFunc as the stack grows
+	void									map_to_reserved(voidptr i_baseAddress, const size i_sizeInBytes, const size i_committedBytes,
+													commit_func_t i_commitFunc, const_cstr i_name);
 	voidptr									allocate(const size i_bytes, const_cstr i_desc = nullptr);
-	// NOTE 1: 'reallocate' function of 'stack_scheme' will not free the old data, it shall become wasted
-	// why? because it's stack scheme, we are not gonna check if the reallocating region is the top one in the stack
-	// though it's possible to do so
-	// NOTE 2: and please, only use reallocate() in transient allocators
+	// i_alignment must be a power of two, anything below k_min_alignment is rounded up to it
+	voidptr									allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc = nullptr);
+	// NOTE 1: the top frame of the stack grows or shrinks in place, any other frame is copied to a new
+	// frame and the old data shall become wasted (until the frames above it are freed)
+	// NOTE 2: and please, only use reallocate() on frames other than the top one in transient allocators
 	voidptr									reallocate(voidptr i_data, const size i_newBytes);
 	void									free(voidptr i_data);
+	// the caller knows the size (std allocators do): only the top frame is popped, any other frame is left
+	// in place without reading its header, until free_to_marker() / free_all() releases it
+	void									free_sized(voidptr i_data, const size i_bytes, const size i_alignment);
 
+	// release every allocation made after i_marker was taken, in O(1) unless the tracking policy
+	// has to unregister them one by one. NOTE: no destructor is called
+	const marker							get_marker();
+	void									free_to_marker(const marker& i_marker);
 	void									free_all();
+	// give the pages above the marker back to the OS, returns the bytes released
+	const size								trim();
 
 	//////////////////////////////////////////////////////////////////////////
-	static const size						get_real_data_size(const size i_dataSize)				{ return (i_dataSize + HL_ALIGNMENT + sizeof(alloc_header_t)); }
+	// worst case frame size at the default alignment, the actual padding depends on the stack marker
+	static const size						get_real_data_size(const size i_dataSize)				{ return (i_dataSize + k_min_alignment - 1 + sizeof(alloc_header_t)); }
+
+private:
+	// unlocked version, the public functions hold the lock
+	voidptr									allocate_frame(const size i_bytes, const size i_alignment, const_cstr i_desc);
+	void									free_frame(voidptr i_data);
+	// dispatched on whether the headers carry the live-allocation list
+	void									release_frames_to(const marker& i_marker, std::true_type);
+	void									release_frames_to(const marker& i_marker, std::false_type);
 
 	// NOTE: the destructor of policy class should be protected to prevent any attempts to delete
 	// the host class by using pointers to its derived class (which is the policy class here)
@@ -45,39 +87,166 @@ protected:
 	
 private:
 	p8										m_current_marker;
+	size									m_peak_used_bytes;
 	
 public:
 	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
 	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
 	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
-	const size									get_remain_bytes() const						{ return alloc_region_t::p_size_in_bytes - alloc_region_t::p_used_bytes - HL_ALIGNMENT - sizeof(alloc_header_t); }
+	const size									get_committed_bytes() const						{ return detail::get_committed_bytes((const alloc_region_t&)*this); }
+	// high-water mark since map_to(), it survives free_all() / free_to_marker()
+	const size									get_peak_used_bytes() const						{ return m_peak_used_bytes; }
+	const size									get_remain_bytes() const						{ return alloc_region_t::p_size_in_bytes - alloc_region_t::p_used_bytes - (k_min_alignment - 1) - sizeof(alloc_header_t); }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// two stacks sharing one region: the low end grows up (long-lived data), the high end grows
+// down (transient data), so neither has to be sized on its own. Each end is LIFO on its own.
+// allocate() / allocate_aligned() go to the low end, free() finds the end from the address.
+// NOTE: the live-allocation list is kept as [high allocations][low allocations] so that
+// rolling back either end only cuts the list at one point
+template <class t_tracking, class t_locking>
+class double_ended_stack_scheme :
+	private detail::alloc_region<typename t_tracking::header_layout_t::template variable_size_header_t<typename t_tracking::alloc_header_t>, t_locking>
+{
+public:
+	typedef typename t_tracking::alloc_header_t         	tracking_header_t;
+	typedef typename t_tracking::header_layout_t::template variable_size_header_t<tracking_header_t>	alloc_header_t;
+	typedef detail::alloc_region<alloc_header_t, t_locking>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t			lock_guard_t;
+
+	static const size						k_min_alignment = max_alignment(HL_ALIGNMENT, alignof(alloc_header_t));
+
+	struct marker
+	{
+		p8									address;
+		alloc_header_t*						last_alloc;
+	};
+
+public:
+	double_ended_stack_scheme();
+
+	void									map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name);
+	voidptr									allocate(const size i_bytes, const_cstr i_desc = nullptr);
+	voidptr									allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc = nullptr);
+	voidptr									allocate_low(const size i_bytes, const size i_alignment = k_min_alignment, const_cstr i_desc = nullptr);
+	voidptr									allocate_high(const size i_bytes, const size i_alignment = k_min_alignment, const_cstr i_desc = nullptr);
+	void									free(voidptr i_data);
+
+	const marker							get_low_marker();
+	const marker							get_high_marker();
+	void									free_to_low_marker(const marker& i_marker);
+	void									free_to_high_marker(const marker& i_marker);
+	void									free_all_low();
+	void									free_all_high();
+	void									free_all();
+	// give the pages between the two markers back to the OS
+	const size								trim();
+
+	//////////////////////////////////////////////////////////////////////////
+	static const size						get_real_data_size(const size i_dataSize)				{ return (i_dataSize + k_min_alignment - 1 + sizeof(alloc_header_t)); }
+
+private:
+	typedef std::integral_constant<bool, alloc_header_traits<alloc_header_t>::k_has_live_list>	has_live_list_t;
+
+	// unlocked versions, the public functions hold the lock
+	voidptr									allocate_low_frame(const size i_bytes, const size i_alignment, const_cstr i_desc);
+	voidptr									allocate_high_frame(const size i_bytes, const size i_alignment, const_cstr i_desc);
+	void									release_low_to(const marker& i_marker);
+	void									release_high_to(const marker& i_marker);
+
+	// live-allocation list bookkeeping, dispatched on whether the headers carry it
+	void									link_low(alloc_header_t* i_header, const_cstr i_desc, std::true_type);
+	void									link_low(alloc_header_t* i_header, const_cstr i_desc, std::false_type)	{}
+	void									link_high(alloc_header_t* i_header, const_cstr i_desc, std::true_type);
+	void									link_high(alloc_header_t* i_header, const_cstr i_desc, std::false_type)	{}
+	void									unlink_low(alloc_header_t* i_header, std::true_type);
+	void									unlink_low(alloc_header_t* i_header, std::false_type)					{}
+	void									unlink_high(alloc_header_t* i_header, std::true_type);
+	void									unlink_high(alloc_header_t* i_header, std::false_type)				{}
+	void									cut_low_list(const marker& i_marker, std::true_type);
+	void									cut_low_list(const marker& i_marker, std::false_type);
+	void									cut_high_list(const marker& i_marker, std::true_type);
+	void									cut_high_list(const marker& i_marker, std::false_type);
+
+protected:
+	~double_ended_stack_scheme();
+
+private:
+	p8										m_low_marker;
+	p8										m_high_marker;
+	alloc_header_t*							m_first_low_alloc;
+	alloc_header_t*							m_last_low_alloc;
+	alloc_header_t*							m_last_high_alloc;
+
+public:
+	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
+	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
+	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
+	const size									get_low_used_bytes() const						{ return (size)(m_low_marker - alloc_region_t::p_base_address); }
+	const size									get_high_used_bytes() const						{ return (size)(alloc_region_t::p_base_address + alloc_region_t::p_size_in_bytes - m_high_marker); }
+	const size									get_remain_bytes() const						{ return (size)(m_high_marker - m_low_marker); }
 };
 
 //////////////////////////////////////////////////////////////////////////
 
-template <size t_elem_size, class t_tracking>
+template <size t_elem_size, class t_tracking, class t_locking>
 class pool_scheme : 
-	private detail::alloc_region<fixed_size_alloc_header<typename t_tracking::alloc_header_t> >
+	private detail::alloc_region<typename t_tracking::header_layout_t::template fixed_size_header_t<typename t_tracking::alloc_header_t>, t_locking>
 {
 public:
 	typedef typename t_tracking::alloc_header_t				tracking_header_t;
-	typedef fixed_size_alloc_header<tracking_header_t>		alloc_header_t;
-	typedef detail::alloc_region<alloc_header_t>			alloc_region_t;
+	typedef typename t_tracking::header_layout_t::template fixed_size_header_t<tracking_header_t>	alloc_header_t;
+	typedef detail::alloc_region<alloc_header_t, t_locking>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t			lock_guard_t;
+
+	// slots are naturally aligned to their size (up to a cache line), so a pool of sizeof(T) always suits T
+	static const size						k_slot_alignment = max_alignment(natural_alignment(t_elem_size, HL_CACHE_LINE_SIZE),
+												max_alignment(HL_ALIGNMENT, alignof(alloc_header_t)));
 
 public:
 	pool_scheme();
 
 	void									map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name);
 	voidptr									allocate(const_cstr i_desc = nullptr);
+	// every slot has the same alignment, this only checks that it is enough
+	voidptr									allocate_aligned(const size i_alignment, const_cstr i_desc = nullptr);
 	void									free(voidptr i_data);
+	// every slot has the same size, so there is nothing to look up: this only checks that the size and
+	// alignment the caller gives back could have been served by the pool
+	void									free_sized(voidptr i_data, const size i_bytes, const size i_alignment);
+
+	// take the lock once for the whole batch, returns the number of slots actually allocated
+	const u32								allocate_bulk(const u32 i_count, voidptr* o_ptrs, const_cstr i_desc = nullptr);
+	void									free_bulk(voidptr* i_ptrs, const u32 i_count);
 
 	void									free_all();
+	// give the pages inside free slots back to the OS, only slots bigger than a page have any.
+	// the slot headers and free-list links stay intact
+	const size								trim();
+
+private:
+	static const size						k_header_size = align_size(detail::alloc_header_size<alloc_header_t>::value, k_slot_alignment);
+
+	// the link may be less aligned than a pointer (e.g. 4-byte slots of 12 bytes), hence the memcpy
+	static inline alloc_header_t*			get_next_free_slot(alloc_header_t* i_slot)				{ alloc_header_t* next; memcpy(&next, (p8)i_slot + k_header_size, sizeof(next)); return next; }
+	static inline void						set_next_free_slot(alloc_header_t* i_slot, alloc_header_t* i_next)	{ memcpy((p8)i_slot + k_header_size, &i_next, sizeof(i_next)); }
+
+	// unlocked versions, the public functions hold the lock
+	voidptr									allocate_slot(const_cstr i_desc);
+	void									free_slot(voidptr i_data);
+	// without the tracking, for the bulk functions which track the whole batch at once
+	alloc_header_t*							take_slot(const_cstr i_desc);
+	void									release_slot(alloc_header_t* i_slot);
+	void									reset_slots();
 
 protected:
 	~pool_scheme();
 
 private:
 	alloc_header_t*							m_next_free_slot;
+	p8										m_first_slot;
 	size									m_element_size;
 	u32										m_element_count;
 	
@@ -86,57 +255,578 @@ public:
 	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
 	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
 	const size									get_remain_bytes() const						{ return 0; }
+	const size									get_element_size() const						{ return m_element_size; }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// pool_scheme with a per-thread magazine of free slots in front of it: allocate / free only touch
+// the calling thread's magazine, the shared pool (and its mutex) is only hit to refill or flush
+// half a magazine at a time.
+// NOTE: cached slots stay allocated in the underlying pool (and in its debug info), they are
+// excluded from get_used_bytes(). A thread reusing the slot of an exited thread gets its magazine,
+// cache size included
+template <size t_elem_size, class t_tracking, class t_locking>
+class cached_pool_scheme :
+	public pool_scheme<t_elem_size, t_tracking, t_locking>
+{
+public:
+	typedef pool_scheme<t_elem_size, t_tracking, t_locking>	pool_scheme_t;
+
+public:
+	cached_pool_scheme();
+
+	voidptr									allocate(const_cstr i_desc = nullptr);
+	voidptr									allocate_aligned(const size i_alignment, const_cstr i_desc = nullptr);
+	void									free(voidptr i_data);
+
+	// only call this when no other thread is using the pool
+	void									free_all();
+	// the calling thread's magazine size, HL_MAX_MAGAZINE_SIZE by default, 0 disables its cache
+	void									set_thread_cache_size(const u32 i_slots);
+
+	// give the calling thread's cached slots back to the shared pool, e.g. before the thread exits
+	void									flush_thread_cache();
+
+protected:
+	~cached_pool_scheme();
+
+private:
+	struct alignas(HL_CACHE_LINE_SIZE) magazine
+	{
+		voidptr								slots[HL_MAX_MAGAZINE_SIZE];
+		std::atomic<u32>					count;						// only written by the owning thread
+		u32									size;
+	};
+
+	magazine								m_magazines[HL_MAX_THREAD_CACHES];
+
+public:
+	const size								get_used_bytes() const;
+	const size								get_cached_bytes() const;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// pool whose free slots form a Treiber stack: allocate / free are a single CAS on the stack head,
+// no mutex involved, so objects can be allocated on one thread and freed on another.
+// the head packs (slot index, tag) in 64 bits, the tag is bumped on every update to defeat ABA.
+// NOTE: there is no live-allocation list, the debug info only reports used bytes.
+// t_locking is unused, it is only there so this scheme plugs into fixed_allocator<>
+template <size t_elem_size, class t_tracking, class t_locking>
+class lockfree_pool_scheme :
+	private detail::alloc_region<lockfree_alloc_header<typename t_tracking::alloc_header_t>, t_locking>
+{
+public:
+	typedef typename t_tracking::alloc_header_t				tracking_header_t;
+	typedef lockfree_alloc_header<tracking_header_t>		alloc_header_t;
+	typedef detail::alloc_region<alloc_header_t, t_locking>	alloc_region_t;
+
+	static const u32						k_null_slot = 0xffffffffu;
+	// same slot alignment rules as pool_scheme
+	static const size						k_slot_alignment = max_alignment(natural_alignment(t_elem_size, HL_CACHE_LINE_SIZE),
+												max_alignment(HL_ALIGNMENT, alignof(alloc_header_t)));
+
+public:
+	lockfree_pool_scheme();
+
+	void									map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name);
+	voidptr									allocate(const_cstr i_desc = nullptr);
+	voidptr									allocate_aligned(const size i_alignment, const_cstr i_desc = nullptr);
+	void									free(voidptr i_data);
+
+	// only call this when no other thread is using the pool
+	void									free_all();
+	// nothing, free slots may be handed out concurrently
+	const size								trim()																{ return 0; }
+
+private:
+	static const size						k_header_size = align_size(sizeof(alloc_header_t), k_slot_alignment);
+
+	inline alloc_header_t*					get_slot(const u32 i_index) const;
+	void									reset_slots();
+
+protected:
+	~lockfree_pool_scheme();
+
+private:
+	std::atomic<u64>						m_free_head;				// [tag:32][slot index:32]
+	p8										m_first_slot;
+	size									m_element_size;
+	u32										m_element_count;
+
+public:
+	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
+	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
+	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes.load(std::memory_order_relaxed); }
+	const size									get_remain_bytes() const						{ return 0; }
+	const size									get_element_size() const						{ return m_element_size; }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// pool whose occupancy is a bitmap in front of the slots (1 bit per slot, set while it is live): slots carry
+// no header and no free-list link, so they are exactly t_elem_size bytes apart. A free slot is found by
+// scanning 64 slots per word from the lowest word which may have one, so live slots stay packed at the
+// front of the region, and for_each_live() visits them in address order.
+// NOTE: the tracking headers, if any, live in a table next to the bitmap. There is no live-allocation list,
+// the debug info only reports used bytes
+template <size t_elem_size, class t_tracking, class t_locking>
+class bitmap_pool_scheme :
+	private detail::alloc_region<compact_fixed_size_alloc_header<typename t_tracking::alloc_header_t>, t_locking>
+{
+public:
+	typedef typename t_tracking::alloc_header_t				tracking_header_t;
+	typedef compact_fixed_size_alloc_header<tracking_header_t>	alloc_header_t;
+	typedef detail::alloc_region<alloc_header_t, t_locking>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t			lock_guard_t;
+
+	// no header in between, the slots only keep the natural alignment of their size
+	static const size						k_slot_alignment = natural_alignment(t_elem_size, HL_CACHE_LINE_SIZE);
+	static const u32						k_null_slot = 0xffffffffu;
+
+public:
+	bitmap_pool_scheme();
+
+	void									map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name);
+	voidptr									allocate(const_cstr i_desc = nullptr);
+	// every slot has the same alignment, this only checks that it is enough
+	voidptr									allocate_aligned(const size i_alignment, const_cstr i_desc = nullptr);
+	void									free(voidptr i_data);
+
+	// take the lock once for the whole batch, returns the number of slots actually allocated
+	const u32								allocate_bulk(const u32 i_count, voidptr* o_ptrs, const_cstr i_desc = nullptr);
+	void									free_bulk(voidptr* i_ptrs, const u32 i_count);
+
+	void									free_all();
+	// give the whole pages inside runs of free slots back to the OS
+	const size								trim();
+
+	// calls i_fn(voidptr) for every live slot, in address order. The lock is held during the walk,
+	// i_fn must not allocate from or free to this pool
+	template <class t_functor>
+	void									for_each_live(t_functor i_fn);
+
+private:
+	static const size						k_header_stride = detail::alloc_header_size<alloc_header_t>::value;
+
+	inline p8								get_slot(const u32 i_index) const						{ return m_first_slot + (size)i_index * t_elem_size; }
+	inline alloc_header_t*					get_header(const u32 i_index) const						{ return (alloc_header_t*)(m_headers + (size)i_index * k_header_stride); }
+	inline const u32						get_slot_index(voidptr i_data) const;
+	// first slot at or after i_from which is live (or free), m_element_count if there is none
+	const u32								find_slot(const u32 i_from, const bool i_live) const;
+
+	// unlocked versions, the public functions hold the lock. The tracking is done by the callers
+	const u32								take_slot();
+	void									release_slot(const u32 i_index);
+	void									reset_slots();
+
+protected:
+	~bitmap_pool_scheme();
+
+private:
+	u64*									m_bitmap;
+	p8										m_headers;
+	p8										m_first_slot;
+	u32										m_element_count;
+	u32										m_word_count;
+	u32										m_search_word;				// no free slot in the words below
+	u32										m_live_count;
+
+public:
+	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
+	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
+	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
+	const size									get_remain_bytes() const						{ return (size)(m_element_count - m_live_count) * t_elem_size; }
+	const size									get_element_size() const						{ return t_elem_size; }
+	const u32									get_element_count() const						{ return m_element_count; }
+	const u32									get_live_count() const							{ return m_live_count; }
 };
 
 //////////////////////////////////////////////////////////////////////////
 
-template <class t_tracking>
+template <class t_tracking, class t_locking>
 class freelist_scheme : 
-	private detail::alloc_region<variable_size_alloc_header<typename t_tracking::alloc_header_t> >
+	private detail::alloc_region<typename t_tracking::header_layout_t::template coalescing_header_t<typename t_tracking::alloc_header_t>, t_locking>
 {
 public:
 	typedef typename t_tracking::alloc_header_t				tracking_header_t;
-	typedef variable_size_alloc_header<tracking_header_t>	alloc_header_t;
-	typedef detail::alloc_region<alloc_header_t>			alloc_region_t;
+	typedef typename t_tracking::header_layout_t::template coalescing_header_t<tracking_header_t>	alloc_header_t;
+	typedef detail::alloc_region<alloc_header_t, t_locking>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t			lock_guard_t;
+
+	// every block starts at a multiple of k_granularity and has a size multiple of k_granularity
+	static const size						k_granularity = max_alignment(HL_ALIGNMENT, alignof(alloc_header_t));
 
 public:
 	freelist_scheme();
 
 	void									map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name);
+	// i_sizeInBytes are only reserved, blocks are committed through i_commitFunc as they are carved
+	void									map_to_reserved(voidptr i_baseAddress, const size i_sizeInBytes, const size i_committedBytes,
+													commit_func_t i_commitFunc, const_cstr i_name);
 	voidptr									allocate(const size i_bytes, const_cstr i_desc = nullptr);
+	// i_alignment must be a power of two, the padding in front of the block is given back as a free block
+	voidptr									allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc = nullptr);
 	voidptr									reallocate(voidptr i_data, const size i_newBytes);
 	void									free(voidptr i_data);
+	// bytes usable at i_data, at least what was asked for
+	const size								get_usable_size(voidptr i_data) const;
+
+	// take the lock once for the whole batch, returns the number of blocks actually allocated
+	const u32								allocate_bulk(const u32 i_count, const size i_bytes, voidptr* o_ptrs, const_cstr i_desc = nullptr);
+	void									free_bulk(voidptr* i_ptrs, const u32 i_count);
 
 	void									free_all();
+	// give the pages inside free blocks back to the OS, the block headers stay intact
+	const size								trim();
 
 	//////////////////////////////////////////////////////////////////////////
-	static const size						get_real_data_size(const size i_dataSize)				{ return (i_dataSize + HL_ALIGNMENT + sizeof(alloc_header_t)); }
+	static const size						get_real_data_size(const size i_dataSize)				{ return align_size(i_dataSize + sizeof(alloc_header_t), k_granularity); }
 
 private:
-	static inline const bool				can_fit(alloc_header_t* i_header, const size i_bytes);
-	static inline const bool				can_create_new_block(alloc_header_t* i_header, const size i_bytes, const size i_minFrameSize);
+	static inline const size				get_frame_size(const size i_bytes);
+	inline const size						get_leading_gap(alloc_header_t* i_block, const size i_alignment);
+
+	inline alloc_header_t*					get_next_phys_block(alloc_header_t* i_block);
+	void									insert_free_block(alloc_header_t* i_block);
+	void									remove_free_block(alloc_header_t* i_block);
+	void									reset_blocks();
+	// give the tail of i_block beyond i_frameSize back as a free block, if it is big enough for one
+	void									trim_block(alloc_header_t* i_block, const size i_frameSize);
 
-	static void								free_block(alloc_header_t* i_block, alloc_header_t* i_prevFree, alloc_header_t* i_nextFree);
-	static const bool						join_blocks(alloc_header_t* i_leftBlock, alloc_header_t* i_rightBlock);
-	static const bool						can_join(alloc_header_t* i_leftBlock, alloc_header_t* i_rightBlock);
+	// unlocked versions, the public functions hold the lock
+	voidptr									allocate_block(const size i_bytes, const size i_alignment, const_cstr i_desc);
+	const bool								resize_block(alloc_header_t* i_block, const size i_newBytes);
+	void									free_block(alloc_header_t* i_block);
+	// without the tracking, for the bulk functions which track the whole batch at once
+	alloc_header_t*							carve_block(const size i_bytes, const size i_alignment, const_cstr i_desc);
+	void									release_block(alloc_header_t* i_block);
 
 protected:
 	~freelist_scheme();
 
 private:
 	const size								k_min_frame_size;
+	p8										m_first_block;
+	p8										m_end_address;
 	alloc_header_t*							m_first_free_block;
 
 public:
 	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
 	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
 	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
+	const size									get_committed_bytes() const						{ return detail::get_committed_bytes((const alloc_region_t&)*this); }
 	const size									get_remain_bytes() const						{ return 0; }
 
 	u32										p_alloc_count;
 	u32										p_free_count;
 };
 
+//////////////////////////////////////////////////////////////////////////
+
+// Two-Level Segregated Fit: free blocks are bucketed by (first-level = power of two,
+// second-level = linear subdivision of that power of two), both levels have an occupancy
+// bitmap so finding a suitable bucket is a couple of bit scans. Allocation and free are O(1)
+// in the worst case, no matter how fragmented the region is.
+template <class t_tracking, class t_locking>
+class tlsf_scheme :
+	private detail::alloc_region<typename t_tracking::header_layout_t::template coalescing_header_t<typename t_tracking::alloc_header_t>, t_locking>
+{
+public:
+	typedef typename t_tracking::alloc_header_t				tracking_header_t;
+	typedef typename t_tracking::header_layout_t::template coalescing_header_t<tracking_header_t>	alloc_header_t;
+	typedef detail::alloc_region<alloc_header_t, t_locking>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t			lock_guard_t;
+
+	static const size						k_granularity = sizeof(aptr) > HL_ALIGNMENT ? sizeof(aptr) : HL_ALIGNMENT;
+	static const u32						k_sl_index_count_log2 = 5;
+	static const u32						k_sl_index_count = 1u << k_sl_index_count_log2;
+	static const u32						k_fl_index_shift = k_sl_index_count_log2 + static_log2(k_granularity);
+	static const u32						k_fl_index_max = 40;					// 1 TB
+	static const u32						k_fl_index_count = k_fl_index_max - k_fl_index_shift + 1;
+	static const size						k_small_block_size = (size)1 << k_fl_index_shift;
+
+public:
+	tlsf_scheme();
+
+	void									map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name);
+	voidptr									allocate(const size i_bytes, const_cstr i_desc = nullptr);
+	// i_alignment must be a power of two, the padding in front of the block is given back as a free block
+	voidptr									allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc = nullptr);
+	// shrinks in place, grows into the next physical block if it is free, copies otherwise
+	voidptr									reallocate(voidptr i_data, const size i_newBytes);
+	void									free(voidptr i_data);
+	// bytes usable at i_data, at least what was asked for
+	const size								get_usable_size(voidptr i_data) const;
+
+	void									free_all();
+	// give the pages inside free blocks back to the OS, the block headers stay intact
+	const size								trim();
+
+	//////////////////////////////////////////////////////////////////////////
+	static const size						get_real_data_size(const size i_dataSize)				{ return (i_dataSize + k_granularity + sizeof(alloc_header_t)); }
+
+private:
+	static inline const size				get_frame_size(const size i_bytes);
+	static inline void						mapping_insert(const size i_frameSize, u32& o_fl, u32& o_sl);
+	static inline void						mapping_search(const size i_frameSize, u32& o_fl, u32& o_sl);
+	inline const size						get_leading_gap(alloc_header_t* i_block, const size i_alignment);
+
+	inline alloc_header_t*					find_suitable_block(u32& io_fl, u32& io_sl);
+	inline alloc_header_t*					get_next_phys_block(alloc_header_t* i_block);
+	void									insert_free_block(alloc_header_t* i_block);
+	void									remove_free_block(alloc_header_t* i_block);
+	// give the tail of i_block beyond i_frameSize back as a free block, if it is big enough for one
+	void									trim_block(alloc_header_t* i_block, const size i_frameSize);
+
+	// unlocked versions, the public functions hold the lock
+	voidptr									allocate_block(const size i_bytes, const size i_alignment, const_cstr i_desc);
+	const bool								resize_block(alloc_header_t* i_block, const size i_newBytes);
+	void									free_block(alloc_header_t* i_block);
+	void									reset_blocks();
+
+protected:
+	~tlsf_scheme();
+
+private:
+	const size								k_min_frame_size;
+	p8										m_first_block;
+	p8										m_end_address;
+	u64										m_fl_bitmap;
+	u32										m_sl_bitmap[k_fl_index_count];
+	alloc_header_t*							m_free_blocks[k_fl_index_count][k_sl_index_count];
+
+public:
+	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
+	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
+	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
+	const size									get_remain_bytes() const						{ return alloc_region_t::p_size_in_bytes - alloc_region_t::p_used_bytes; }
+
+	u32										p_alloc_count;
+	u32										p_free_count;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// general purpose small allocations: requests up to k_max_small_size are rounded up to one of k_class_count
+// size classes (16 bytes apart up to 128, then 4 classes per power of two) and served from a pool-style
+// slab of that class. Slabs are k_slab_size bytes, aligned to their size so a slot finds its slab by masking
+// its address, and are carved from the region on demand; a slab which becomes empty goes back to the
+// region and can be reused by any class.
+// NOTE: the region loses up to k_slab_size bytes to the alignment of the first slab
+template <class t_tracking, class t_locking>
+class slab_scheme :
+	private detail::alloc_region<typename t_tracking::header_layout_t::template fixed_size_header_t<typename t_tracking::alloc_header_t>, t_locking>
+{
+public:
+	typedef typename t_tracking::alloc_header_t				tracking_header_t;
+	typedef typename t_tracking::header_layout_t::template fixed_size_header_t<tracking_header_t>	alloc_header_t;
+	typedef detail::alloc_region<alloc_header_t, t_locking>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t			lock_guard_t;
+
+	static const u32						k_class_count = 29;
+	static const size						k_max_small_size = 4096;
+	static const size						k_slab_size = SIZE_KB(64);
+
+	struct class_stats
+	{
+		size								class_size;
+		size								slot_size;					// with the header
+		u32									slab_count;
+		u32									live_slots;
+		u64									alloc_count;
+		u64									free_count;
+	};
+
+public:
+	slab_scheme();
+
+	void									map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name);
+	// i_bytes must not exceed k_max_small_size
+	voidptr									allocate(const size i_bytes, const_cstr i_desc = nullptr);
+	// picks the smallest class whose slots are aligned enough, i_alignment must be a power of two
+	voidptr									allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc = nullptr);
+	// stays in place as long as i_newBytes maps to the same size class
+	voidptr									reallocate(voidptr i_data, const size i_newBytes);
+	void									free(voidptr i_data);
+	// the caller knows the size and alignment it allocated with (std allocators do): the size class comes
+	// from them instead of the slab header
+	void									free_sized(voidptr i_data, const size i_bytes, const size i_alignment);
+	// the size of the class i_data was served from
+	const size								get_usable_size(voidptr i_data) const;
+
+	void									free_all();
+	// give the pages of empty and never used slabs back to the OS
+	const size								trim();
+
+	const class_stats						get_class_stats(const u32 i_classIndex);
+
+	//////////////////////////////////////////////////////////////////////////
+	static inline const u32					get_class_index(const size i_bytes);
+	static inline const size				get_class_size(const u32 i_classIndex);
+	static const size						get_real_data_size(const size i_dataSize)				{ return get_slot_size(get_class_index(i_dataSize)); }
+
+private:
+	struct slab_header
+	{
+		slab_header*						next_slab;
+		slab_header*						prev_slab;
+		alloc_header_t*						free_slot;					// given back slots, linked through their data
+		p8									fresh_slot;					// slots from here on were never handed out
+		u32									class_index;
+		u32									used_slots;
+		u32									slot_count;
+	};
+
+	struct size_class
+	{
+		slab_header*						partial_slabs;				// slabs with at least one free slot
+		u32									slab_count;
+		u32									live_slots;
+		u64									alloc_count;
+		u64									free_count;
+	};
+
+	static const size						k_slot_alignment = max_alignment(8, alignof(alloc_header_t));
+	static const size						k_header_size = align_size(detail::alloc_header_size<alloc_header_t>::value, k_slot_alignment);
+
+	// the slots are padded to the natural alignment of their class (up to a cache line), whatever the size of
+	// the header: the first data of a slab starts on a cache line, so every slot of the class stays as aligned
+	static inline const size				get_slot_size(const u32 i_classIndex)
+	{
+		const size classSize = get_class_size(i_classIndex);
+		return align_size(k_header_size + classSize, natural_alignment(classSize, HL_CACHE_LINE_SIZE));
+	}
+	static inline slab_header*				get_slab(alloc_header_t* i_slot)						{ return (slab_header*)((aptr)i_slot & ~(aptr)(k_slab_size - 1)); }
+	static inline alloc_header_t*			get_next_free_slot(alloc_header_t* i_slot)				{ alloc_header_t* next; memcpy(&next, (p8)i_slot + k_header_size, sizeof(next)); return next; }
+	static inline void						set_next_free_slot(alloc_header_t* i_slot, alloc_header_t* i_next)	{ memcpy((p8)i_slot + k_header_size, &i_next, sizeof(i_next)); }
+
+	slab_header*							acquire_slab(const u32 i_classIndex);
+	void									release_slab(slab_header* i_slab);
+	void									insert_partial_slab(size_class& io_class, slab_header* i_slab);
+	void									remove_partial_slab(size_class& io_class, slab_header* i_slab);
+	void									reset_slabs();
+
+	// the smallest class whose slots are aligned to i_alignment, k_class_count if there is none
+	static inline const u32					get_aligned_class_index(const size i_bytes, const size i_alignment);
+
+	// unlocked versions, the public functions hold the lock
+	voidptr									allocate_slot(const u32 i_classIndex, const size i_bytes, const_cstr i_desc);
+	void									free_slot(voidptr i_data, const u32 i_classIndex);
+
+protected:
+	~slab_scheme();
+
+private:
+	p8										m_first_slab;
+	p8										m_end_slab;
+	p8										m_next_fresh_slab;
+	slab_header*							m_free_slabs;
+	u32										m_free_slab_count;
+	size_class								m_classes[k_class_count];
+
+public:
+	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
+	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
+	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
+	// slabs no class has claimed yet
+	const size									get_remain_bytes() const						{ return (size)(m_end_slab - m_next_fresh_slab) + m_free_slab_count * k_slab_size; }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// medium buffers: requests are rounded up to a power of two multiple of k_min_block_size (order 0) up to
+// k_max_block_size (order k_max_order). A free block is split in halves until it matches the order, a freed
+// block merges with its buddy as long as the buddy is free too, both in O(k_order_count). Free blocks are
+// kept per order in a list and in a bitmap, the bitmap answers "is my buddy free" without touching it.
+// Headers and block orders live in a table at the front of the region rather than inside the blocks, so
+// a 4KB request takes exactly one 4KB block and every block starts on a k_min_block_size boundary.
+// NOTE: the frame address reported for a live block is the block itself, not its header
+template <class t_tracking, class t_locking>
+class buddy_scheme :
+	private detail::alloc_region<typename t_tracking::header_layout_t::template fixed_size_header_t<typename t_tracking::alloc_header_t>, t_locking>
+{
+public:
+	typedef typename t_tracking::alloc_header_t				tracking_header_t;
+	typedef typename t_tracking::header_layout_t::template fixed_size_header_t<tracking_header_t>	alloc_header_t;
+	typedef detail::alloc_region<alloc_header_t, t_locking>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t			lock_guard_t;
+
+	static const size						k_min_block_size = SIZE_KB(4);
+	static const u32						k_max_order = 12;								// 16MB
+	static const u32						k_order_count = k_max_order + 1;
+	static const size						k_max_block_size = k_min_block_size << k_max_order;
+
+public:
+	buddy_scheme();
+
+	void									map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name);
+	// i_bytes must not exceed k_max_block_size
+	voidptr									allocate(const size i_bytes, const_cstr i_desc = nullptr);
+	// i_alignment must be a power of two, alignments above k_min_block_size round the request up to a block of that size.
+	// nullptr when the first block itself is not aligned to i_alignment
+	voidptr									allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc = nullptr);
+	// stays in place as long as i_newBytes maps to the same order
+	voidptr									reallocate(voidptr i_data, const size i_newBytes);
+	void									free(voidptr i_data);
+
+	void									free_all();
+	// give the pages of free blocks back to the OS, the free list links stay intact
+	const size								trim();
+
+	const u32								get_free_block_count(const u32 i_order);
+	// the largest request which can still be served, 0 when the region is full
+	const size								get_largest_free_block();
+
+	//////////////////////////////////////////////////////////////////////////
+	static inline const u32					get_order(const size i_bytes);
+	static const size						get_block_size(const u32 i_order)						{ return k_min_block_size << i_order; }
+	static const size						get_real_data_size(const size i_dataSize)				{ return get_block_size(get_order(i_dataSize)); }
+
+private:
+	struct free_block
+	{
+		free_block*							next_block;
+		free_block*							prev_block;
+	};
+
+	static const u8							k_no_order = 0xFF;
+	static const size						k_header_stride = detail::alloc_header_size<alloc_header_t>::value;
+
+	inline p8								get_block(const size i_blockIndex) const				{ return m_first_block + i_blockIndex * k_min_block_size; }
+	inline alloc_header_t*					get_header(const size i_blockIndex) const				{ return (alloc_header_t*)(m_headers + i_blockIndex * k_header_stride); }
+	inline const bool						is_free(const u32 i_order, const size i_blockIndex) const;
+
+	void									push_free_block(const u32 i_order, const size i_blockIndex);
+	void									remove_free_block(const u32 i_order, const size i_blockIndex);
+	void									reset_blocks();
+
+	// unlocked versions, the public functions hold the lock
+	voidptr									allocate_block(const u32 i_order, const size i_bytes, const_cstr i_desc);
+	void									free_block_at(voidptr i_data);
+
+protected:
+	~buddy_scheme();
+
+private:
+	p8										m_headers;
+	u8*										m_block_orders;					// order of the live block starting at each index
+	u64*									m_free_bitmaps[k_order_count];	// bit i: block i (in blocks of that order) is free
+	free_block*								m_free_lists[k_order_count];
+	u32										m_free_counts[k_order_count];
+	u32										m_free_order_mask;				// bit o: m_free_lists[o] is not empty
+	p8										m_first_block;
+	size									m_block_count;					// in k_min_block_size blocks
+
+public:
+	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
+	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
+	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
+	// blocks only, the header table in front of them is not counted
+	const size									get_remain_bytes() const						{ return m_block_count * k_min_block_size - alloc_region_t::p_used_bytes; }
+};
+
 }
 
 #include "alloc_schemes.hpp"
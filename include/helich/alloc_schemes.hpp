@@ -6,6 +6,7 @@
 #include <floral/math/utils.h>
 
 #include <cassert>
+#include <new>
 #include <string.h>
 
 // WARNING: enable this will make sure that the memory region which is allocated or freed will be zero out before
@@ -18,50 +19,75 @@ namespace helich
 
 //////////////////////////////////////////////////////////////////////////
 // Stack Allocation Scheme
-template <class t_tracking>
-stack_scheme<t_tracking>::stack_scheme()
+template <class t_tracking, class t_locking>
+stack_scheme<t_tracking, t_locking>::stack_scheme()
 	: alloc_region_t()
+	, m_current_marker(nullptr)
+	, m_peak_used_bytes(0)
 {
 
 }
 
-template <class t_tracking>
-stack_scheme<t_tracking>::~stack_scheme()
+template <class t_tracking, class t_locking>
+stack_scheme<t_tracking, t_locking>::~stack_scheme()
 {
 	alloc_region_t::p_base_address = nullptr;
 	m_current_marker = nullptr;
 	alloc_region_t::p_size_in_bytes = 0;
 }
 
-template <class t_tracking>
-void stack_scheme<t_tracking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+template <class t_tracking, class t_locking>
+void stack_scheme<t_tracking, t_locking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
 	alloc_region_t::p_base_address = (p8)i_baseAddress;
 	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
 	m_current_marker = (p8)i_baseAddress;
+	m_peak_used_bytes = 0;
 }
 
-template <class t_tracking>
-voidptr stack_scheme<t_tracking>::allocate(const size i_bytes, const_cstr i_desc /* = nullptr */)
+template <class t_tracking, class t_locking>
+void stack_scheme<t_tracking, t_locking>::map_to_reserved(voidptr i_baseAddress, const size i_sizeInBytes, const size i_committedBytes,
+		commit_func_t i_commitFunc, const_cstr i_name)
+{
+	map_to(i_baseAddress, i_sizeInBytes, i_name);
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	alloc_region_t::p_committed_bytes = i_committedBytes;
+	alloc_region_t::p_commit_func = i_commitFunc;
+}
+
+template <class t_tracking, class t_locking>
+voidptr stack_scheme<t_tracking, t_locking>::allocate(const size i_bytes, const_cstr i_desc /* = nullptr */)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_frame(i_bytes, k_min_alignment, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr stack_scheme<t_tracking, t_locking>::allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment), "Alignment must be a power of two");
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_frame(i_bytes, max_alignment(i_alignment, k_min_alignment), i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr stack_scheme<t_tracking, t_locking>::allocate_frame(const size i_bytes, const size i_alignment, const_cstr i_desc)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
 	// the whole stack frame size, count all headers, displacement, data, ...
-	// ....[A..A][H..H][D..D][A'..A']
-	// A: aligning-bytes    : always >= 1 byte
+	// ....[A..A][H..H][D..D]
+	// A: aligning-bytes    : >= 0 bytes, only as many as needed to align D to i_alignment
 	// H: header
 	// D: data
-	// [A'..A']: not-free region but contains nothing   : >= 0 bytes
-	// sizeof([A..A]) + sizeof([A'..A']) == HL_ALIGNMENT
-	// stack header's ([H..H]) size always equals to HL_ALIGNMENT (min = 4 bytes)
-	size frame_size = i_bytes + HL_ALIGNMENT + sizeof(alloc_header_t);
+	p8 orgAddr = m_current_marker;
+	p8 dataAddr = (p8)align_address(orgAddr + sizeof(alloc_header_t), i_alignment);
+	p8 headerAddr = dataAddr - sizeof(alloc_header_t);
+	size frame_size = (aptr)(dataAddr + i_bytes) - (aptr)orgAddr;
 	// out of memory check
 	assert((aptr)m_current_marker + frame_size <= (aptr)alloc_region_t::p_base_address + alloc_region_t::p_size_in_bytes);
-	// start address of the frame
-	p8 orgAddr = m_current_marker;
+	if (!detail::commit_to((alloc_region_t&)*this, orgAddr + frame_size))
+		return nullptr;
 
-	p8 headerAddr = (p8)align_address(orgAddr);    // forward align, this is address of the header
-	p8 dataAddr = headerAddr + sizeof(alloc_header_t);       // sure-align address, this is the start of the data
 	// reset data memory region
 #if defined(ZERO_OUT_MEMORY)
 	memset(dataAddr, 0, i_bytes);
@@ -70,58 +96,84 @@ voidptr stack_scheme<t_tracking>::allocate(const size i_bytes, const_cstr i_desc
 	// save info about displacement and allocated frame size
 	size displacement = (aptr)headerAddr - (aptr)orgAddr;
 	alloc_header_t* header = (alloc_header_t*)headerAddr;
-	header->next_alloc = nullptr;
-	header->prev_alloc = alloc_region_t::p_last_alloc;
 	header->frame_size = frame_size;
-	if (i_desc)
-	{
-		strcpy(header->description, i_desc);
-	}
-	else
-	{
-		memset(header->description, 0, 64);
-	}
 	header->adjustment = displacement;
-	if (alloc_region_t::p_last_alloc != nullptr) {
-		alloc_region_t::p_last_alloc->next_alloc = header;
-	}
-
-	alloc_region_t::p_last_alloc = header;
+	detail::link_allocation((alloc_region_t&)*this, header, i_desc);
 
 	// increase marker
 	m_current_marker += frame_size;
 
 	alloc_region_t::p_used_bytes += frame_size;
+	if (alloc_region_t::p_used_bytes > m_peak_used_bytes)
+		m_peak_used_bytes = alloc_region_t::p_used_bytes;
 
 	// register allocation
-	t_tracking::register_allocation(header, i_bytes, "no-desc", __FILE__, __LINE__);
+	t_tracking::register_allocation(header, i_bytes, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
 
 	return static_cast<voidptr>(dataAddr);
 }
 
-template <class t_tracking>
-voidptr stack_scheme<t_tracking>::reallocate(voidptr i_data, const size i_newBytes)
+template <class t_tracking, class t_locking>
+voidptr stack_scheme<t_tracking, t_locking>::reallocate(voidptr i_data, const size i_newBytes)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
-	voidptr newAllocation = allocate(i_newBytes);
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	if (i_data == nullptr)
+		return allocate_frame(i_newBytes, k_min_alignment, nullptr);
+
+	alloc_header_t* oldHeader = (alloc_header_t*)i_data - 1;
+	p8 orgAddr = (p8)oldHeader - oldHeader->adjustment;
+
+	// top of the stack: just move the marker
+	if (orgAddr + oldHeader->frame_size == m_current_marker)
+	{
+		size newFrameSize = (size)((p8)i_data + i_newBytes - orgAddr);
+		if (orgAddr + newFrameSize <= alloc_region_t::p_base_address + alloc_region_t::p_size_in_bytes
+			&& detail::commit_to((alloc_region_t&)*this, orgAddr + newFrameSize))
+		{
+			alloc_region_t::p_used_bytes = alloc_region_t::p_used_bytes - oldHeader->frame_size + newFrameSize;
+			if (alloc_region_t::p_used_bytes > m_peak_used_bytes)
+				m_peak_used_bytes = alloc_region_t::p_used_bytes;
+			oldHeader->frame_size = newFrameSize;
+			m_current_marker = orgAddr + newFrameSize;
+			t_tracking::resize_allocation(oldHeader, i_newBytes);
+			return i_data;
+		}
+		return nullptr;
+	}
+
+	voidptr newAllocation = allocate_frame(i_newBytes, k_min_alignment, nullptr);
 
 	if (newAllocation != nullptr)
 	{
-		alloc_header_t* oldHeader = (alloc_header_t*)i_data - 1;
-		size dataSizeBytes = oldHeader->frame_size - sizeof(alloc_header_t) - HL_ALIGNMENT;
+		size dataSizeBytes = oldHeader->frame_size - oldHeader->adjustment - sizeof(alloc_header_t);
 
 		// memcpy
-		memcpy(newAllocation, i_data, dataSizeBytes);
+		memcpy(newAllocation, i_data, floral::min(i_newBytes, dataSizeBytes));
 
 		return newAllocation;
 	}
 	return nullptr;
 }
 
-template <class t_tracking>
-void stack_scheme<t_tracking>::free(voidptr i_data)
+template <class t_tracking, class t_locking>
+void stack_scheme<t_tracking, t_locking>::free(voidptr i_data)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	free_frame(i_data);
+}
+
+template <class t_tracking, class t_locking>
+void stack_scheme<t_tracking, t_locking>::free_sized(voidptr i_data, const size i_bytes, const size i_alignment)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	// frames end right after their data
+	if ((p8)i_data + i_bytes == m_current_marker)
+		free_frame(i_data);
+}
+
+template <class t_tracking, class t_locking>
+void stack_scheme<t_tracking, t_locking>::free_frame(voidptr i_data)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
 	// get the header position
 	alloc_header_t* header = (alloc_header_t*)i_data - 1;
 	// now, we can get the frame size
@@ -135,14 +187,11 @@ void stack_scheme<t_tracking>::free(voidptr i_data)
 	FLORAL_ASSERT_MSG(orgAddr == lastAllocAddr, "Invalid free: not in allocation order");
 
 	// adjust header
-	if (header->prev_alloc)
-		header->prev_alloc->next_alloc = nullptr;
+	detail::unlink_allocation((alloc_region_t&)*this, header);
 
 	// unregister allocation
 	t_tracking::unregister_allocation(header);
 
-	alloc_region_t::p_last_alloc = header->prev_alloc;
-
 	// reset memory region
 #if defined(ZERO_OUT_MEMORY)
 	memset(orgAddr, 0, frame_size);
@@ -153,424 +202,2603 @@ void stack_scheme<t_tracking>::free(voidptr i_data)
 	alloc_region_t::p_used_bytes -= frame_size;
 }
 
-template <class t_tracking>
-void stack_scheme<t_tracking>::free_all()
+template <class t_tracking, class t_locking>
+const typename stack_scheme<t_tracking, t_locking>::marker stack_scheme<t_tracking, t_locking>::get_marker()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	marker currMarker;
+	currMarker.address = m_current_marker;
+	currMarker.last_alloc = alloc_region_t::p_last_alloc;
+	return currMarker;
+}
+
+template <class t_tracking, class t_locking>
+void stack_scheme<t_tracking, t_locking>::free_to_marker(const marker& i_marker)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	FLORAL_ASSERT_MSG(i_marker.address >= alloc_region_t::p_base_address && i_marker.address <= m_current_marker,
+			"Invalid marker: already released or not from this stack");
+
+	release_frames_to(i_marker, std::integral_constant<bool, alloc_header_traits<alloc_header_t>::k_has_live_list>());
+
+#if defined(ZERO_OUT_MEMORY)
+	memset(i_marker.address, 0, m_current_marker - i_marker.address);
+#endif
+	// frames are contiguous from the base address, so the used bytes are just the marker offset
+	m_current_marker = i_marker.address;
+	alloc_region_t::p_used_bytes = (size)(m_current_marker - alloc_region_t::p_base_address);
+}
+
+template <class t_tracking, class t_locking>
+void stack_scheme<t_tracking, t_locking>::release_frames_to(const marker& i_marker, std::true_type)
+{
+	alloc_header_t* lastAlloc = alloc_region_t::p_last_alloc;
+	if (t_tracking::k_tracks_allocations)
+	{
+		while (lastAlloc != i_marker.last_alloc)
+		{
+			t_tracking::unregister_allocation(lastAlloc);
+			lastAlloc = lastAlloc->prev_alloc;
+		}
+	}
+
+	// cut the live list right after the marker's allocation
+	alloc_region_t::p_last_alloc = i_marker.last_alloc;
+	if (i_marker.last_alloc)
+		i_marker.last_alloc->next_alloc = nullptr;
+}
+
+template <class t_tracking, class t_locking>
+void stack_scheme<t_tracking, t_locking>::release_frames_to(const marker& i_marker, std::false_type)
+{
+	// compact headers: there is no way back to the released frames
+	static_assert(!t_tracking::k_tracks_allocations, "free_to_marker() needs the live-allocation list to unregister tracked allocations");
+}
+
+template <class t_tracking, class t_locking>
+void stack_scheme<t_tracking, t_locking>::free_all()
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	detail::unregister_live_allocations<t_tracking>((alloc_region_t&)*this);
 	m_current_marker = alloc_region_t::p_base_address;
 	alloc_region_t::p_last_alloc = nullptr;
 	alloc_region_t::p_used_bytes = 0;
 #if defined(ZERO_OUT_MEMORY)
-	memset(alloc_region_t::p_base_address, 0, alloc_region_t::p_size_in_bytes);
+	memset(alloc_region_t::p_base_address, 0, detail::get_committed_bytes((alloc_region_t&)*this));
 #endif
 }
 
-//////////////////////////////////////////////////////////////////////////
-// Pool Allocation Scheme
+template <class t_tracking, class t_locking>
+const size stack_scheme<t_tracking, t_locking>::trim()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return detail::purge_range((alloc_region_t&)*this, m_current_marker, alloc_region_t::p_base_address + alloc_region_t::p_size_in_bytes);
+}
 
-template <size t_elem_size, class t_tracking>
-pool_scheme<t_elem_size, t_tracking>::pool_scheme()
-	: alloc_region_t()//alloc_region_t::p_last_alloc(nullptr)
-	, m_next_free_slot(nullptr)
-	, m_element_size(0)
-	, m_element_count(0)
+//////////////////////////////////////////////////////////////////////////
+// Double-Ended Stack Allocation Scheme
+template <class t_tracking, class t_locking>
+double_ended_stack_scheme<t_tracking, t_locking>::double_ended_stack_scheme()
+	: alloc_region_t()
+	, m_low_marker(nullptr)
+	, m_high_marker(nullptr)
+	, m_first_low_alloc(nullptr)
+	, m_last_low_alloc(nullptr)
+	, m_last_high_alloc(nullptr)
 {
 
 }
 
-template <size t_elem_size, class t_tracking>
-pool_scheme<t_elem_size, t_tracking>::~pool_scheme()
+template <class t_tracking, class t_locking>
+double_ended_stack_scheme<t_tracking, t_locking>::~double_ended_stack_scheme()
 {
 
 }
 
-template <size t_elem_size, class t_tracking>
-void pool_scheme<t_elem_size, t_tracking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
-	m_element_size = ((t_elem_size - 1) / HL_ALIGNMENT + 1) * HL_ALIGNMENT + sizeof(alloc_header_t);
-	m_element_count = (u32)(i_sizeInBytes / m_element_size);
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
 	alloc_region_t::p_base_address = (p8)i_baseAddress;
 	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
-	// fill the assoc list
-	for (u32 i = 0; i < m_element_count - 1; i++) {
-		p8 addr = alloc_region_t::p_base_address + i * m_element_size;
-		p8 nextAddr = alloc_region_t::p_base_address + (i + 1) * m_element_size;
-		alloc_header_t* header = (alloc_header_t*)addr;
-		header->next_alloc = (alloc_header_t*)nextAddr;
-		header->frame_size = m_element_size;
-		header->adjustment = 0;
-	}
-	m_next_free_slot = (alloc_header_t*)alloc_region_t::p_base_address;
+	m_low_marker = (p8)i_baseAddress;
+	m_high_marker = (p8)i_baseAddress + i_sizeInBytes;
 }
 
-template <size t_elem_size, class t_tracking>
-voidptr pool_scheme<t_elem_size, t_tracking>::allocate(const_cstr i_desc /* = nullptr */)
+template <class t_tracking, class t_locking>
+voidptr double_ended_stack_scheme<t_tracking, t_locking>::allocate(const size i_bytes, const_cstr i_desc /* = nullptr */)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
-	// TODO: out of memory assertion
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_low_frame(i_bytes, k_min_alignment, i_desc);
+}
 
-	// we have return address right-away, the memory region was pre-aligned already
-	//p8 headerAddr = (p8)((aptr)alloc_region_t::p_base_address + (aptr)m_next_free_slot);
-	p8 headerAddr = (p8)m_next_free_slot;
-	p8 dataAddr = headerAddr + sizeof(alloc_header_t);
-	// next free slot is contained inside pooled element, update it by them
-	// update header and next free slot
-	alloc_header_t* header = (alloc_header_t*)headerAddr;
-	m_next_free_slot = header->next_alloc;
-	header->next_alloc = nullptr;
-	header->prev_alloc = alloc_region_t::p_last_alloc;
-	if (i_desc)
+template <class t_tracking, class t_locking>
+voidptr double_ended_stack_scheme<t_tracking, t_locking>::allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	return allocate_low(i_bytes, i_alignment, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr double_ended_stack_scheme<t_tracking, t_locking>::allocate_low(const size i_bytes, const size i_alignment /* = k_min_alignment */, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment), "Alignment must be a power of two");
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_low_frame(i_bytes, max_alignment(i_alignment, k_min_alignment), i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr double_ended_stack_scheme<t_tracking, t_locking>::allocate_high(const size i_bytes, const size i_alignment /* = k_min_alignment */, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment), "Alignment must be a power of two");
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_high_frame(i_bytes, max_alignment(i_alignment, k_min_alignment), i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr double_ended_stack_scheme<t_tracking, t_locking>::allocate_low_frame(const size i_bytes, const size i_alignment, const_cstr i_desc)
+{
+	// same frame as stack_scheme: ....[A..A][H..H][D..D], growing up
+	p8 orgAddr = m_low_marker;
+	p8 dataAddr = (p8)align_address(orgAddr + sizeof(alloc_header_t), i_alignment);
+	if (dataAddr + i_bytes > m_high_marker)
 	{
-		strcpy(header->description, i_desc);
+		FLORAL_ASSERT_MSG(false, "Out of memory: the two ends of the stack met");
+		return nullptr;
 	}
-	else
+
+	alloc_header_t* header = (alloc_header_t*)(dataAddr - sizeof(alloc_header_t));
+	size frame_size = (size)(dataAddr + i_bytes - orgAddr);
+	header->frame_size = frame_size;
+	header->adjustment = (size)((p8)header - orgAddr);
+	link_low(header, i_desc, has_live_list_t());
+
+	m_low_marker += frame_size;
+	alloc_region_t::p_used_bytes += frame_size;
+
+	t_tracking::register_allocation(header, i_bytes, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+#if defined(ZERO_OUT_MEMORY)
+	memset(dataAddr, 0, i_bytes);
+#endif
+	return dataAddr;
+}
+
+template <class t_tracking, class t_locking>
+voidptr double_ended_stack_scheme<t_tracking, t_locking>::allocate_high_frame(const size i_bytes, const size i_alignment, const_cstr i_desc)
+{
+	// mirrored frame: [H..H][D..D][A..A].... growing down, the frame starts at its header
+	if ((size)(m_high_marker - m_low_marker) < i_bytes + sizeof(alloc_header_t))
 	{
-		memset(header->description, 0, 64);
+		FLORAL_ASSERT_MSG(false, "Out of memory: the two ends of the stack met");
+		return nullptr;
 	}
-	if (alloc_region_t::p_last_alloc != nullptr)
+	p8 dataAddr = (p8)((aptr)(m_high_marker - i_bytes) & ~(aptr)(i_alignment - 1));
+	p8 headerAddr = dataAddr - sizeof(alloc_header_t);
+	if (headerAddr < m_low_marker)
 	{
-		alloc_region_t::p_last_alloc->next_alloc = header;
+		FLORAL_ASSERT_MSG(false, "Out of memory: the two ends of the stack met");
+		return nullptr;
 	}
 
-	t_tracking::register_allocation(headerAddr, m_element_size, "no-desc", __FILE__, __LINE__);
+	alloc_header_t* header = (alloc_header_t*)headerAddr;
+	size frame_size = (size)(m_high_marker - headerAddr);
+	header->frame_size = frame_size;
+	header->adjustment = 0;
+	link_high(header, i_desc, has_live_list_t());
 
-	alloc_region_t::p_last_alloc = header;
-	// reset memory region
+	m_high_marker = headerAddr;
+	alloc_region_t::p_used_bytes += frame_size;
+
+	t_tracking::register_allocation(header, i_bytes, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
 #if defined(ZERO_OUT_MEMORY)
-	memset(dataAddr, 0, t_elem_size);
+	memset(dataAddr, 0, i_bytes);
 #endif
-
-	alloc_region_t::p_used_bytes += m_element_size;
-
 	return dataAddr;
 }
 
-template <size t_elem_size, class t_tracking>
-void pool_scheme<t_elem_size, t_tracking>::free(voidptr i_data)
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::free(voidptr i_data)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
-	// calculate position of the will-be-freed slot
-	alloc_header_t* header = (alloc_header_t*)((p8)i_data - sizeof(alloc_header_t));
-
-	// unregister tracking info
-	t_tracking::unregister_allocation(header);
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	alloc_header_t* header = (alloc_header_t*)i_data - 1;
+	size frame_size = header->frame_size;
 
-	if (header->next_alloc) {
-		header->next_alloc->prev_alloc = header->prev_alloc;
-	}
-	if (header->prev_alloc) {
-		header->prev_alloc->next_alloc = header->next_alloc;
+	if ((p8)i_data < m_low_marker)
+	{
+		p8 orgAddr = (p8)header - header->adjustment;
+		FLORAL_ASSERT_MSG(orgAddr == m_low_marker - frame_size, "Invalid free: not in allocation order");
+		unlink_low(header, has_live_list_t());
+		t_tracking::unregister_allocation(header);
+		m_low_marker = orgAddr;
 	}
-	// are we freeing the last allocation?
-	if (header == alloc_region_t::p_last_alloc) {
-		// yes, then update the list's tail element
-		alloc_region_t::p_last_alloc = header->prev_alloc;
+	else
+	{
+		FLORAL_ASSERT_MSG((p8)header == m_high_marker, "Invalid free: not in allocation order");
+		unlink_high(header, has_live_list_t());
+		t_tracking::unregister_allocation(header);
+		m_high_marker += frame_size;
 	}
 
-#if defined(ZERO_OUT_MEMORY)
-	memset(header, 0, m_element_size);
-#endif
+	alloc_region_t::p_used_bytes -= frame_size;
+}
 
-	// update this slot's next free slot to next free slot
-	header->next_alloc = m_next_free_slot;
-	header->frame_size = m_element_size;
-	header->adjustment = 0;
-	//*((u32*)headerAddr) = m_NextFreeIdx;
+template <class t_tracking, class t_locking>
+const typename double_ended_stack_scheme<t_tracking, t_locking>::marker double_ended_stack_scheme<t_tracking, t_locking>::get_low_marker()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	marker currMarker;
+	currMarker.address = m_low_marker;
+	currMarker.last_alloc = m_last_low_alloc;
+	return currMarker;
+}
 
-	// update next free slot to this slot's index
-	//m_NextFreeIdx = idx;
-	m_next_free_slot = header;
+template <class t_tracking, class t_locking>
+const typename double_ended_stack_scheme<t_tracking, t_locking>::marker double_ended_stack_scheme<t_tracking, t_locking>::get_high_marker()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	marker currMarker;
+	currMarker.address = m_high_marker;
+	currMarker.last_alloc = m_last_high_alloc;
+	return currMarker;
+}
 
-	alloc_region_t::p_used_bytes -= m_element_size;
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::free_to_low_marker(const marker& i_marker)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	FLORAL_ASSERT_MSG(i_marker.address >= alloc_region_t::p_base_address && i_marker.address <= m_low_marker,
+			"Invalid marker: already released or not from the low end");
+	release_low_to(i_marker);
 }
 
-template <size t_elem_size, class t_tracking>
-void pool_scheme<t_elem_size, t_tracking>::free_all()
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::free_to_high_marker(const marker& i_marker)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
-	alloc_region_t::p_last_alloc = nullptr;
-	alloc_region_t::p_used_bytes = 0;
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	FLORAL_ASSERT_MSG(i_marker.address <= alloc_region_t::p_base_address + alloc_region_t::p_size_in_bytes && i_marker.address >= m_high_marker,
+			"Invalid marker: already released or not from the high end");
+	release_high_to(i_marker);
 }
 
-//////////////////////////////////////////////////////////////////////////
-// Freelist Allocation Scheme
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::free_all_low()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	marker baseMarker;
+	baseMarker.address = alloc_region_t::p_base_address;
+	baseMarker.last_alloc = nullptr;
+	release_low_to(baseMarker);
+}
 
-template <class t_tracking>
-freelist_scheme<t_tracking>::freelist_scheme()
-	: alloc_region_t()
-	, k_min_frame_size(sizeof(alloc_header_t) + HL_ALIGNMENT + 1)
-	, m_first_free_block(nullptr)
-	//, alloc_region_t::p_last_alloc(nullptr)
-	, p_alloc_count(0)
-	, p_free_count(0)
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::free_all_high()
 {
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	marker endMarker;
+	endMarker.address = alloc_region_t::p_base_address + alloc_region_t::p_size_in_bytes;
+	endMarker.last_alloc = nullptr;
+	release_high_to(endMarker);
+}
 
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::free_all()
+{
+	free_all_low();
+	free_all_high();
 }
 
-template <class t_tracking>
-freelist_scheme<t_tracking>::~freelist_scheme()
+template <class t_tracking, class t_locking>
+const size double_ended_stack_scheme<t_tracking, t_locking>::trim()
 {
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return detail::purge_range((alloc_region_t&)*this, m_low_marker, m_high_marker);
+}
 
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::release_low_to(const marker& i_marker)
+{
+	cut_low_list(i_marker, has_live_list_t());
+#if defined(ZERO_OUT_MEMORY)
+	memset(i_marker.address, 0, m_low_marker - i_marker.address);
+#endif
+	alloc_region_t::p_used_bytes -= (size)(m_low_marker - i_marker.address);
+	m_low_marker = i_marker.address;
 }
 
-template <class t_tracking>
-void freelist_scheme<t_tracking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::release_high_to(const marker& i_marker)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
-	alloc_region_t::p_base_address = (p8)i_baseAddress;
-	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+	cut_high_list(i_marker, has_live_list_t());
+#if defined(ZERO_OUT_MEMORY)
+	memset(m_high_marker, 0, i_marker.address - m_high_marker);
+#endif
+	alloc_region_t::p_used_bytes -= (size)(i_marker.address - m_high_marker);
+	m_high_marker = i_marker.address;
+}
 
-	m_first_free_block = (alloc_header_t*)alloc_region_t::p_base_address;
-	m_first_free_block->frame_size = alloc_region_t::p_size_in_bytes;
-	m_first_free_block->adjustment = 0;
-	m_first_free_block->next_alloc = nullptr;
-	m_first_free_block->prev_alloc = nullptr;
+// the low allocations are the tail of the live list
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::link_low(alloc_header_t* i_header, const_cstr i_desc, std::true_type)
+{
+	detail::link_allocation((alloc_region_t&)*this, i_header, i_desc);
+	if (m_first_low_alloc == nullptr)
+		m_first_low_alloc = i_header;
+	m_last_low_alloc = i_header;
 }
 
-// inline services for allocation
-template <class t_tracking>
-const bool freelist_scheme<t_tracking>::can_fit(alloc_header_t* i_header, const size i_bytes)
+// the high allocations go right in front of the first low allocation
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::link_high(alloc_header_t* i_header, const_cstr i_desc, std::true_type)
 {
-	return (i_header->frame_size - HL_ALIGNMENT - sizeof(alloc_header_t) >= i_bytes);
+	detail::set_description(i_header, i_desc);
+	i_header->prev_alloc = m_last_high_alloc;
+	i_header->next_alloc = m_first_low_alloc;
+	if (m_last_high_alloc)
+		m_last_high_alloc->next_alloc = i_header;
+	if (m_first_low_alloc)
+		m_first_low_alloc->prev_alloc = i_header;
+	else
+		alloc_region_t::p_last_alloc = i_header;
+	m_last_high_alloc = i_header;
 }
 
-template <class t_tracking>
-const bool freelist_scheme<t_tracking>::can_create_new_block(alloc_header_t* i_header, const size i_bytes, const size i_minFrameSize)
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::unlink_low(alloc_header_t* i_header, std::true_type)
 {
-	size remaining = i_header->frame_size - HL_ALIGNMENT - sizeof(alloc_header_t) - i_bytes;
-	return (remaining >= i_minFrameSize);
+	// high headers always sit above low headers
+	alloc_header_t* prevAlloc = i_header->prev_alloc;
+	m_last_low_alloc = (prevAlloc && (p8)prevAlloc < (p8)i_header) ? prevAlloc : nullptr;
+	if (m_last_low_alloc == nullptr)
+		m_first_low_alloc = nullptr;
+	detail::unlink_allocation((alloc_region_t&)*this, i_header);
 }
 
-template <class t_tracking>
-voidptr freelist_scheme<t_tracking>::allocate(const size i_bytes, const_cstr i_desc /* = nullptr */)
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::unlink_high(alloc_header_t* i_header, std::true_type)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
-	// first-fit strategy
-	alloc_header_t* currBlock = m_first_free_block;
-	// search
-	while (currBlock && !can_fit(currBlock, i_bytes)) {
-		currBlock = currBlock->next_alloc;
+	m_last_high_alloc = i_header->prev_alloc;
+	detail::unlink_allocation((alloc_region_t&)*this, i_header);
+}
+
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::cut_low_list(const marker& i_marker, std::true_type)
+{
+	if (t_tracking::k_tracks_allocations)
+	{
+		// the first low allocation is preceded by the last high one
+		alloc_header_t* stopAlloc = i_marker.last_alloc ? i_marker.last_alloc : m_last_high_alloc;
+		// no low allocation at all: m_last_low_alloc is null and the walk must not start
+		for (alloc_header_t* currAlloc = m_last_low_alloc; currAlloc && currAlloc != stopAlloc; currAlloc = currAlloc->prev_alloc)
+			t_tracking::unregister_allocation(currAlloc);
 	}
 
-	if (currBlock) { // found it!
-		voidptr dataAddr = (p8)currBlock + sizeof(alloc_header_t);
-		// C1: a new free block needs to be created
-		if (can_create_new_block(currBlock, i_bytes, k_min_frame_size)) {
-			size oldFrameSize = currBlock->frame_size;
-			// update frame_size of currBlock
-			size currFrameSize = sizeof(alloc_header_t) + i_bytes + HL_ALIGNMENT;
-			size disp = currBlock->adjustment;
-			currBlock->frame_size = currFrameSize;
-
-			// create new free block
-			p8 unalignedNBStart = (p8)currBlock - disp + currBlock->frame_size;
-			//p8 unalignedNBStart = (p8)currBlock + currBlock->frame_size;
-			p8 nbStart = (p8)align_address(unalignedNBStart);
-			aptr nbDisp = (aptr)nbStart - (aptr)unalignedNBStart;
-			size nbFrameSize = oldFrameSize - currFrameSize;
-			alloc_header_t* newBlock = (alloc_header_t*)nbStart;
-			// update pointers of new free block
-			newBlock->next_alloc = currBlock->next_alloc;
-			newBlock->prev_alloc = currBlock->prev_alloc;
-			//newBlock->TrackingInfo = nullptr;
-			newBlock->frame_size = nbFrameSize;
-			newBlock->adjustment = nbDisp;
-
-			// delete pointers on currBlock as it's already occupied
-			currBlock->next_alloc = nullptr;
-			currBlock->prev_alloc = nullptr;
-
-			// update linked list
-			if (newBlock->prev_alloc) {
-				newBlock->prev_alloc->next_alloc = newBlock;
-			}
-			if (newBlock->next_alloc) {
-				newBlock->next_alloc->prev_alloc = newBlock;
-			}
-
-			// update first free block
-			if (currBlock == m_first_free_block) {
-				m_first_free_block = newBlock;
-			}
-		}
-		else {
-			// C2: we can use all of this block
-			if (currBlock->prev_alloc) {
-				currBlock->prev_alloc->next_alloc = currBlock->next_alloc;
-			}
-			if (currBlock->next_alloc) {
-				currBlock->next_alloc->prev_alloc = currBlock->prev_alloc;
-			}
-			// update first free block?
-			if (m_first_free_block == currBlock) {
-				m_first_free_block = currBlock->next_alloc;
-			}
-
-			// delete pointers
-			currBlock->next_alloc = nullptr;
-			currBlock->prev_alloc = nullptr;
-		}
+	m_last_low_alloc = i_marker.last_alloc;
+	if (m_last_low_alloc == nullptr)
+	{
+		m_first_low_alloc = nullptr;
+		if (m_last_high_alloc)
+			m_last_high_alloc->next_alloc = nullptr;
+		alloc_region_t::p_last_alloc = m_last_high_alloc;
+	}
+	else
+	{
+		m_last_low_alloc->next_alloc = nullptr;
+		alloc_region_t::p_last_alloc = m_last_low_alloc;
+	}
+}
 
-		currBlock->next_alloc = nullptr;
-		currBlock->prev_alloc = alloc_region_t::p_last_alloc;
-		if (i_desc)
-		{
-			strcpy(currBlock->description, i_desc);
-		}
-		else
-		{
-			memset(currBlock->description, 0, 64);
-		}
-		if (alloc_region_t::p_last_alloc != nullptr)
-			alloc_region_t::p_last_alloc->next_alloc = currBlock;
-		alloc_region_t::p_last_alloc = currBlock;
-		t_tracking::register_allocation(currBlock, i_bytes, "no-desc", __FILE__, __LINE__);
-		alloc_region_t::p_used_bytes += currBlock->frame_size;
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::cut_low_list(const marker& i_marker, std::false_type)
+{
+	static_assert(!t_tracking::k_tracks_allocations, "Rolling back needs the live-allocation list to unregister tracked allocations");
+}
 
-		p_alloc_count++;
-		return dataAddr;
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::cut_high_list(const marker& i_marker, std::true_type)
+{
+	if (t_tracking::k_tracks_allocations)
+	{
+		for (alloc_header_t* currAlloc = m_last_high_alloc; currAlloc && currAlloc != i_marker.last_alloc; currAlloc = currAlloc->prev_alloc)
+			t_tracking::unregister_allocation(currAlloc);
 	}
-	// nothing found, cannot allocate anything
-	return nullptr;
+
+	m_last_high_alloc = i_marker.last_alloc;
+	if (m_last_high_alloc)
+		m_last_high_alloc->next_alloc = m_first_low_alloc;
+	if (m_first_low_alloc)
+		m_first_low_alloc->prev_alloc = m_last_high_alloc;
+	else
+		alloc_region_t::p_last_alloc = m_last_high_alloc;
 }
 
-template <class t_tracking>
-voidptr freelist_scheme<t_tracking>::reallocate(voidptr i_data, const size i_newBytes)
+template <class t_tracking, class t_locking>
+void double_ended_stack_scheme<t_tracking, t_locking>::cut_high_list(const marker& i_marker, std::false_type)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
-	voidptr newAllocation = allocate(i_newBytes);
+	static_assert(!t_tracking::k_tracks_allocations, "Rolling back needs the live-allocation list to unregister tracked allocations");
+}
 
-	if (newAllocation != nullptr) {
-		alloc_header_t* releaseBlock = (alloc_header_t*)((p8)i_data - sizeof(alloc_header_t));
-		size dataSizeBytes = releaseBlock->frame_size - sizeof(alloc_header_t) - HL_ALIGNMENT;
+//////////////////////////////////////////////////////////////////////////
+// Pool Allocation Scheme
 
-		// NOTE: sometimes, the reallocated size is smaller than the previously allocated size.
-		memcpy(newAllocation, i_data, floral::min(i_newBytes, dataSizeBytes));
+template <size t_elem_size, class t_tracking, class t_locking>
+pool_scheme<t_elem_size, t_tracking, t_locking>::pool_scheme()
+	: alloc_region_t()//alloc_region_t::p_last_alloc(nullptr)
+	, m_next_free_slot(nullptr)
+	, m_first_slot(nullptr)
+	, m_element_size(0)
+	, m_element_count(0)
+{
 
-		// now we can free the old data
-		// FIXME: this will trigger the recursive mutex mechanism, it's BAD. Please google.
-		free(i_data);
+}
 
-		return newAllocation;
+template <size t_elem_size, class t_tracking, class t_locking>
+pool_scheme<t_elem_size, t_tracking, t_locking>::~pool_scheme()
+{
+
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void pool_scheme<t_elem_size, t_tracking, t_locking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	// a free slot keeps the link to the next free slot in its data
+	const size dataSize = (t_elem_size > sizeof(voidptr)) ? t_elem_size : sizeof(voidptr);
+	m_element_size = align_size(dataSize, k_slot_alignment) + k_header_size;
+	// k_header_size is a multiple of the slot alignment, aligning the header aligns the data
+	m_first_slot = (p8)align_address(i_baseAddress, k_slot_alignment);
+	const size usableBytes = i_sizeInBytes - (size)(m_first_slot - (p8)i_baseAddress);
+	m_element_count = (u32)(usableBytes / m_element_size);
+	alloc_region_t::p_base_address = (p8)i_baseAddress;
+	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+	reset_slots();
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void pool_scheme<t_elem_size, t_tracking, t_locking>::reset_slots()
+{
+	// fill the assoc list
+	for (u32 i = 0; i < m_element_count; i++) {
+		p8 addr = m_first_slot + i * m_element_size;
+		p8 nextAddr = m_first_slot + (i + 1) * m_element_size;
+		alloc_header_t* header = (alloc_header_t*)addr;
+		set_next_free_slot(header, (i + 1 < m_element_count) ? (alloc_header_t*)nextAddr : nullptr);
+		detail::set_frame_info(header, m_element_size, 0);
 	}
-	return nullptr;
+	m_next_free_slot = (m_element_count > 0) ? (alloc_header_t*)m_first_slot : nullptr;
 }
 
-// free a block, update the free list
-template <class t_tracking>
-void freelist_scheme<t_tracking>::free_block(alloc_header_t* i_block, alloc_header_t* i_prevFree, alloc_header_t* i_nextFree)
+template <size t_elem_size, class t_tracking, class t_locking>
+typename pool_scheme<t_elem_size, t_tracking, t_locking>::alloc_header_t* pool_scheme<t_elem_size, t_tracking, t_locking>::take_slot(const_cstr i_desc)
 {
+	// out of memory
+	if (m_next_free_slot == nullptr)
+		return nullptr;
+
+	// we have return address right-away, the memory region was pre-aligned already
+	// next free slot is contained inside pooled element, update it by them
+	// update header and next free slot
+	alloc_header_t* header = m_next_free_slot;
+	m_next_free_slot = get_next_free_slot(header);
+	detail::link_allocation((alloc_region_t&)*this, header, i_desc);
+
+	// reset memory region
 #if defined(ZERO_OUT_MEMORY)
-	// erase its content
-	p8 pData = (p8)i_block + sizeof(alloc_header_t);
-	memset(pData, 0, i_block->frame_size - HL_ALIGNMENT - sizeof(alloc_header_t));
+	memset((p8)header + k_header_size, 0, t_elem_size);
 #endif
-	i_block->next_alloc = nullptr;
-	i_block->prev_alloc = nullptr;
 
-	// adjust pointers
-	if (i_prevFree) {
-		i_block->prev_alloc = i_prevFree;
-		i_prevFree->next_alloc = i_block;
-	}
-	if (i_nextFree) {
-		i_block->next_alloc = i_nextFree;
-		i_nextFree->prev_alloc = i_block;
-	}
+	alloc_region_t::p_used_bytes += m_element_size;
+	return header;
 }
 
-// check if 2 blocks can be joined
-template <class t_tracking>
-const bool freelist_scheme<t_tracking>::can_join(alloc_header_t* i_leftBlock, alloc_header_t* i_rightBlock)
+template <size t_elem_size, class t_tracking, class t_locking>
+void pool_scheme<t_elem_size, t_tracking, t_locking>::release_slot(alloc_header_t* i_slot)
 {
-	aptr leftEnd = (aptr)i_leftBlock - i_leftBlock->adjustment + i_leftBlock->frame_size;
-	aptr rightStart = (aptr)i_rightBlock - i_rightBlock->adjustment;
-	return (leftEnd == rightStart);
+	detail::unlink_allocation((alloc_region_t&)*this, i_slot);
+
+#if defined(ZERO_OUT_MEMORY)
+	memset((p8)i_slot + k_header_size, 0, m_element_size - k_header_size);
+#endif
+
+	// update this slot's next free slot to next free slot
+	set_next_free_slot(i_slot, m_next_free_slot);
+	detail::set_frame_info(i_slot, m_element_size, 0);
+
+	// update next free slot to this slot
+	m_next_free_slot = i_slot;
+
+	alloc_region_t::p_used_bytes -= m_element_size;
 }
 
-// join 2 *free* blocks together
-template <class t_tracking>
-const bool freelist_scheme<t_tracking>::join_blocks(alloc_header_t* i_leftBlock, alloc_header_t* i_rightBlock)
+template <size t_elem_size, class t_tracking, class t_locking>
+voidptr pool_scheme<t_elem_size, t_tracking, t_locking>::allocate_slot(const_cstr i_desc)
 {
-	if (!i_leftBlock || !i_rightBlock)
-		return false;
+	alloc_header_t* header = take_slot(i_desc);
+	if (header == nullptr)
+		return nullptr;
 
-	if (can_join(i_leftBlock, i_rightBlock)) {
-		// adjust left block's pointers
-		i_leftBlock->next_alloc = i_rightBlock->next_alloc;
-
-		// update frame_size of left block
-		i_leftBlock->frame_size += i_rightBlock->frame_size;
+	t_tracking::register_allocation(header, m_element_size, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+	return (p8)header + k_header_size;
+}
 
-		if (i_rightBlock->next_alloc)
-			i_rightBlock->next_alloc->prev_alloc = i_leftBlock;
+template <size t_elem_size, class t_tracking, class t_locking>
+void pool_scheme<t_elem_size, t_tracking, t_locking>::free_slot(voidptr i_data)
+{
+	// calculate position of the will-be-freed slot
+	alloc_header_t* header = (alloc_header_t*)((p8)i_data - k_header_size);
 
-		// erase right block header as we don't need it anymore
-#if defined(ZERO_OUT_MEMORY)
-		memset(i_rightBlock, 0, sizeof(alloc_header_t));
-#endif
-		return true;
-	}
-	else return false;
+	// unregister tracking info
+	t_tracking::unregister_allocation(header);
+	release_slot(header);
 }
 
-template <class t_tracking>
-void freelist_scheme<t_tracking>::free(voidptr i_data)
+template <size t_elem_size, class t_tracking, class t_locking>
+voidptr pool_scheme<t_elem_size, t_tracking, t_locking>::allocate(const_cstr i_desc /* = nullptr */)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
-	alloc_header_t* releaseBlock = (alloc_header_t*)((p8)i_data - sizeof(alloc_header_t));
-	alloc_region_t::p_used_bytes -= releaseBlock->frame_size;
-	t_tracking::unregister_allocation(releaseBlock);
-	p_free_count++;
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_slot(i_desc);
+}
 
-	if (releaseBlock->next_alloc)
-		releaseBlock->next_alloc->prev_alloc = releaseBlock->prev_alloc;
-	if (releaseBlock->prev_alloc)
-		releaseBlock->prev_alloc->next_alloc = releaseBlock->next_alloc;
-	if (releaseBlock == alloc_region_t::p_last_alloc) {
-		alloc_region_t::p_last_alloc = releaseBlock->prev_alloc;
-	}
+template <size t_elem_size, class t_tracking, class t_locking>
+voidptr pool_scheme<t_elem_size, t_tracking, t_locking>::allocate_aligned(const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment) && i_alignment <= k_slot_alignment, "Pool slots are not aligned enough");
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_slot(i_desc);
+}
 
-	// search for nearest-after free block
-	alloc_header_t* nextFree = m_first_free_block;
-	while (nextFree &&
-		((aptr)nextFree <= (aptr)releaseBlock)) {
-		nextFree = nextFree->next_alloc;
+template <size t_elem_size, class t_tracking, class t_locking>
+const u32 pool_scheme<t_elem_size, t_tracking, t_locking>::allocate_bulk(const u32 i_count, voidptr* o_ptrs, const_cstr i_desc /* = nullptr */)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	u32 allocated = 0;
+	while (allocated < i_count)
+	{
+		alloc_header_t* header = take_slot(i_desc);
+		if (header == nullptr)
+			break;
+		o_ptrs[allocated++] = (p8)header + k_header_size;
 	}
-	alloc_header_t* prevFree = nextFree->prev_alloc;
 
-	// free releaseBlock
-	free_block(releaseBlock, prevFree, nextFree);
+	t_tracking::register_allocations(o_ptrs, allocated, k_header_size, m_element_size, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+	return allocated;
+}
 
-	// update first free block
-	if ((aptr)releaseBlock < (aptr)m_first_free_block) {
-		m_first_free_block = releaseBlock;
-	}
-	// join blocks if possible
-	if (join_blocks(prevFree, releaseBlock))
-		join_blocks(prevFree, nextFree);
-	else join_blocks(releaseBlock, nextFree);
+template <size t_elem_size, class t_tracking, class t_locking>
+void pool_scheme<t_elem_size, t_tracking, t_locking>::free(voidptr i_data)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	free_slot(i_data);
 }
 
-template <class t_tracking>
-void freelist_scheme<t_tracking>::free_all()
+template <size t_elem_size, class t_tracking, class t_locking>
+void pool_scheme<t_elem_size, t_tracking, t_locking>::free_sized(voidptr i_data, const size i_bytes, const size i_alignment)
 {
-	floral::lock_guard memGuard(alloc_region_t::m_alloc_mutex);
+	FLORAL_ASSERT_MSG(i_bytes <= m_element_size - k_header_size && is_power_of_two(i_alignment) && i_alignment <= k_slot_alignment,
+		"Invalid free: the pool cannot have served this size or alignment");
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	free_slot(i_data);
+}
 
-	alloc_region_t::p_last_alloc = nullptr;
-	alloc_region_t::p_used_bytes = 0;
+template <size t_elem_size, class t_tracking, class t_locking>
+void pool_scheme<t_elem_size, t_tracking, t_locking>::free_bulk(voidptr* i_ptrs, const u32 i_count)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	t_tracking::unregister_allocations(i_ptrs, i_count, k_header_size);
+	for (u32 i = 0; i < i_count; i++)
+	{
+		release_slot((alloc_header_t*)((p8)i_ptrs[i] - k_header_size));
+	}
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void pool_scheme<t_elem_size, t_tracking, t_locking>::free_all()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	detail::unregister_live_allocations<t_tracking>((alloc_region_t&)*this);
+	alloc_region_t::p_last_alloc = nullptr;
+	alloc_region_t::p_used_bytes = 0;
+	reset_slots();
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+const size pool_scheme<t_elem_size, t_tracking, t_locking>::trim()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	// keep the header and the link of every free slot
+	const size keptBytes = k_header_size + sizeof(voidptr);
+	if (m_element_size - keptBytes < get_system_page_size())
+		return 0;
+
+	size releasedBytes = 0;
+	for (alloc_header_t* slot = m_next_free_slot; slot; slot = get_next_free_slot(slot))
+	{
+		releasedBytes += detail::purge_range((alloc_region_t&)*this, (p8)slot + keptBytes, (p8)slot + m_element_size);
+	}
+	return releasedBytes;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Thread-Cached Pool Allocation Scheme
+
+template <size t_elem_size, class t_tracking, class t_locking>
+cached_pool_scheme<t_elem_size, t_tracking, t_locking>::cached_pool_scheme()
+	: pool_scheme_t()
+{
+	for (u32 i = 0; i < HL_MAX_THREAD_CACHES; i++)
+	{
+		m_magazines[i].count.store(0, std::memory_order_relaxed);
+		m_magazines[i].size = HL_MAX_MAGAZINE_SIZE;
+	}
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+cached_pool_scheme<t_elem_size, t_tracking, t_locking>::~cached_pool_scheme()
+{
+
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+voidptr cached_pool_scheme<t_elem_size, t_tracking, t_locking>::allocate(const_cstr i_desc /* = nullptr */)
+{
+	const u32 threadSlot = detail::get_thread_slot();
+	if (threadSlot >= HL_MAX_THREAD_CACHES || m_magazines[threadSlot].size == 0)
+	{
+		return pool_scheme_t::allocate(i_desc);
+	}
+
+	magazine& mag = m_magazines[threadSlot];
+	u32 count = mag.count.load(std::memory_order_relaxed);
+	if (count == 0)
+	{
+		// refill half a magazine at once
+		count = pool_scheme_t::allocate_bulk((mag.size + 1) / 2, mag.slots, i_desc);
+		if (count == 0)
+			return nullptr;
+	}
+
+	count--;
+	mag.count.store(count, std::memory_order_relaxed);
+	return mag.slots[count];
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+voidptr cached_pool_scheme<t_elem_size, t_tracking, t_locking>::allocate_aligned(const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment) && i_alignment <= pool_scheme_t::k_slot_alignment, "Pool slots are not aligned enough");
+	return allocate(i_desc);
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void cached_pool_scheme<t_elem_size, t_tracking, t_locking>::free(voidptr i_data)
+{
+	const u32 threadSlot = detail::get_thread_slot();
+	if (threadSlot >= HL_MAX_THREAD_CACHES || m_magazines[threadSlot].size == 0)
+	{
+		pool_scheme_t::free(i_data);
+		return;
+	}
+
+	magazine& mag = m_magazines[threadSlot];
+	u32 count = mag.count.load(std::memory_order_relaxed);
+	if (count >= mag.size)
+	{
+		// flush the coldest slots (bottom of the magazine), keep the recently freed ones
+		const u32 keepCount = mag.size / 2;
+		const u32 flushCount = count - keepCount;
+		pool_scheme_t::free_bulk(mag.slots, flushCount);
+		memmove(mag.slots, mag.slots + flushCount, keepCount * sizeof(voidptr));
+		count = keepCount;
+	}
+
+	mag.slots[count] = i_data;
+	mag.count.store(count + 1, std::memory_order_relaxed);
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void cached_pool_scheme<t_elem_size, t_tracking, t_locking>::flush_thread_cache()
+{
+	const u32 threadSlot = detail::get_thread_slot();
+	if (threadSlot >= HL_MAX_THREAD_CACHES)
+		return;
+
+	magazine& mag = m_magazines[threadSlot];
+	pool_scheme_t::free_bulk(mag.slots, mag.count.load(std::memory_order_relaxed));
+	mag.count.store(0, std::memory_order_relaxed);
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void cached_pool_scheme<t_elem_size, t_tracking, t_locking>::free_all()
+{
+	for (u32 i = 0; i < HL_MAX_THREAD_CACHES; i++)
+	{
+		m_magazines[i].count.store(0, std::memory_order_relaxed);
+	}
+	pool_scheme_t::free_all();
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void cached_pool_scheme<t_elem_size, t_tracking, t_locking>::set_thread_cache_size(const u32 i_slots)
+{
+	FLORAL_ASSERT_MSG(i_slots <= HL_MAX_MAGAZINE_SIZE, "Thread cache size is bigger than HL_MAX_MAGAZINE_SIZE");
+	const u32 threadSlot = detail::get_thread_slot();
+	if (threadSlot >= HL_MAX_THREAD_CACHES)
+		return;
+
+	magazine& mag = m_magazines[threadSlot];
+	mag.size = floral::min(i_slots, (u32)HL_MAX_MAGAZINE_SIZE);
+
+	// the coldest slots which do not fit anymore go back to the pool
+	const u32 count = mag.count.load(std::memory_order_relaxed);
+	if (count > mag.size)
+	{
+		const u32 flushCount = count - mag.size;
+		pool_scheme_t::free_bulk(mag.slots, flushCount);
+		memmove(mag.slots, mag.slots + flushCount, mag.size * sizeof(voidptr));
+		mag.count.store(mag.size, std::memory_order_relaxed);
+	}
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+const size cached_pool_scheme<t_elem_size, t_tracking, t_locking>::get_cached_bytes() const
+{
+	size cachedSlots = 0;
+	for (u32 i = 0; i < HL_MAX_THREAD_CACHES; i++)
+	{
+		cachedSlots += m_magazines[i].count.load(std::memory_order_relaxed);
+	}
+	return cachedSlots * pool_scheme_t::get_element_size();
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+const size cached_pool_scheme<t_elem_size, t_tracking, t_locking>::get_used_bytes() const
+{
+	return pool_scheme_t::get_used_bytes() - get_cached_bytes();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Lock-Free Pool Allocation Scheme
+
+template <size t_elem_size, class t_tracking, class t_locking>
+lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::lockfree_pool_scheme()
+	: alloc_region_t()
+	, m_free_head(k_null_slot)
+	, m_first_slot(nullptr)
+	, m_element_size(0)
+	, m_element_count(0)
+{
+
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::~lockfree_pool_scheme()
+{
+
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+{
+	// every slot header is aligned for its atomic link, and k_header_size keeps the data slot-aligned
+	m_element_size = align_size(t_elem_size, k_slot_alignment) + k_header_size;
+
+	p8 firstSlot = (p8)align_address(i_baseAddress, k_slot_alignment);
+	size usableBytes = i_sizeInBytes - (size)(firstSlot - (p8)i_baseAddress);
+	FLORAL_ASSERT_MSG(usableBytes / m_element_size < k_null_slot, "Too many slots for lockfree_pool_scheme");
+	m_element_count = (u32)(usableBytes / m_element_size);
+
+	alloc_region_t::p_base_address = (p8)i_baseAddress;
+	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+	m_first_slot = firstSlot;
+	reset_slots();
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+typename lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::alloc_header_t* lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::get_slot(const u32 i_index) const
+{
+	return (alloc_header_t*)(m_first_slot + (size)i_index * m_element_size);
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::reset_slots()
+{
+	for (u32 i = 0; i < m_element_count; i++)
+	{
+		alloc_header_t* header = new (get_slot(i)) alloc_header_t();
+		header->next_free.store((i + 1 < m_element_count) ? i + 1 : k_null_slot, std::memory_order_relaxed);
+	}
+	alloc_region_t::p_used_bytes.store(0, std::memory_order_relaxed);
+	m_free_head.store((m_element_count > 0) ? 0 : k_null_slot, std::memory_order_release);
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+voidptr lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::allocate(const_cstr i_desc /* = nullptr */)
+{
+	// pop
+	u64 head = m_free_head.load(std::memory_order_acquire);
+	alloc_header_t* header = nullptr;
+	while (true)
+	{
+		const u32 slot = (u32)head;
+		if (slot == k_null_slot)
+		{
+			// out of memory
+			return nullptr;
+		}
+
+		header = get_slot(slot);
+		const u64 nextTag = ((head >> 32) + 1) << 32;
+		const u64 newHead = nextTag | header->next_free.load(std::memory_order_relaxed);
+		if (m_free_head.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+			break;
+	}
+
+	p8 dataAddr = (p8)header + k_header_size;
+	t_tracking::register_allocation(header, m_element_size, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+#if defined(ZERO_OUT_MEMORY)
+	memset(dataAddr, 0, t_elem_size);
+#endif
+	alloc_region_t::p_used_bytes.fetch_add(m_element_size, std::memory_order_relaxed);
+	return dataAddr;
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+voidptr lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::allocate_aligned(const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment) && i_alignment <= k_slot_alignment, "Pool slots are not aligned enough");
+	return allocate(i_desc);
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::free(voidptr i_data)
+{
+	alloc_header_t* header = (alloc_header_t*)((p8)i_data - k_header_size);
+	const u32 slot = (u32)(((p8)header - m_first_slot) / m_element_size);
+	FLORAL_ASSERT_MSG(slot < m_element_count && get_slot(slot) == header, "Invalid free: not a slot of this pool");
+
+	t_tracking::unregister_allocation(header);
+#if defined(ZERO_OUT_MEMORY)
+	memset(i_data, 0, t_elem_size);
+#endif
+	alloc_region_t::p_used_bytes.fetch_sub(m_element_size, std::memory_order_relaxed);
+
+	// push
+	u64 head = m_free_head.load(std::memory_order_relaxed);
+	while (true)
+	{
+		header->next_free.store((u32)head, std::memory_order_relaxed);
+		const u64 nextTag = ((head >> 32) + 1) << 32;
+		if (m_free_head.compare_exchange_weak(head, nextTag | slot, std::memory_order_release, std::memory_order_relaxed))
+			break;
+	}
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void lockfree_pool_scheme<t_elem_size, t_tracking, t_locking>::free_all()
+{
+	// no live list: the free slots are marked through the free stack, the others are live
+	if (t_tracking::k_tracks_allocations)
+	{
+		const u32 freeMark = k_null_slot - 1;
+		u32 slot = (u32)m_free_head.load(std::memory_order_acquire);
+		while (slot != k_null_slot)
+		{
+			alloc_header_t* header = get_slot(slot);
+			slot = header->next_free.load(std::memory_order_relaxed);
+			header->next_free.store(freeMark, std::memory_order_relaxed);
+		}
+
+		for (u32 i = 0; i < m_element_count; i++)
+		{
+			alloc_header_t* header = get_slot(i);
+			if (header->next_free.load(std::memory_order_relaxed) != freeMark)
+				t_tracking::unregister_allocation(header);
+		}
+	}
+	reset_slots();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Bitmap Pool Allocation Scheme
+
+template <size t_elem_size, class t_tracking, class t_locking>
+bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::bitmap_pool_scheme()
+	: alloc_region_t()
+	, m_bitmap(nullptr)
+	, m_headers(nullptr)
+	, m_first_slot(nullptr)
+	, m_element_count(0)
+	, m_word_count(0)
+	, m_search_word(0)
+	, m_live_count(0)
+{
+
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::~bitmap_pool_scheme()
+{
+
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	alloc_region_t::p_base_address = (p8)i_baseAddress;
+	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+
+	// bitmap and header table are sized for every slot the whole region could hold, the slots left after them are fewer
+	size maxCount = i_sizeInBytes / t_elem_size;
+	if (maxCount > k_null_slot)
+		maxCount = k_null_slot;
+	p8 endAddress = (p8)i_baseAddress + i_sizeInBytes;
+	m_bitmap = (u64*)align_address(i_baseAddress, sizeof(u64));
+	m_headers = (p8)align_address(m_bitmap + (maxCount + 63) / 64, max_alignment(alignof(alloc_header_t), sizeof(u64)));
+	m_first_slot = (p8)align_address(m_headers + maxCount * k_header_stride, k_slot_alignment);
+	FLORAL_ASSERT_MSG(m_first_slot + t_elem_size <= endAddress, "Region is too small for bitmap_pool_scheme");
+
+	const size elementCount = (size)(endAddress - m_first_slot) / t_elem_size;
+	m_element_count = (u32)(elementCount < maxCount ? elementCount : maxCount);
+	m_word_count = (m_element_count + 63) / 64;
+
+	reset_slots();
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::reset_slots()
+{
+	memset(m_bitmap, 0, m_word_count * sizeof(u64));
+	// the bits past the last slot look live forever, so the search never hands them out
+	const u32 tailBits = m_element_count & 63;
+	if (tailBits != 0)
+		m_bitmap[m_word_count - 1] = ~(((u64)1 << tailBits) - 1);
+	m_search_word = 0;
+	m_live_count = 0;
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+const u32 bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::get_slot_index(voidptr i_data) const
+{
+	const size offset = (size)((p8)i_data - m_first_slot);
+	FLORAL_ASSERT_MSG((p8)i_data >= m_first_slot && offset % t_elem_size == 0 && offset / t_elem_size < m_element_count,
+			"Invalid free: not a slot of this pool");
+	return (u32)(offset / t_elem_size);
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+const u32 bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::find_slot(const u32 i_from, const bool i_live) const
+{
+	u32 wordIndex = i_from >> 6;
+	if (wordIndex >= m_word_count)
+		return m_element_count;
+
+	// bits below i_from in its word are ignored
+	u64 word = (i_live ? m_bitmap[wordIndex] : ~m_bitmap[wordIndex]) & (~(u64)0 << (i_from & 63));
+	while (word == 0)
+	{
+		if (++wordIndex == m_word_count)
+			return m_element_count;
+		word = i_live ? m_bitmap[wordIndex] : ~m_bitmap[wordIndex];
+	}
+
+	const u32 slotIndex = (wordIndex << 6) + bit_scan_forward(word);
+	return slotIndex < m_element_count ? slotIndex : m_element_count;
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+const u32 bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::take_slot()
+{
+	for (u32 wordIndex = m_search_word; wordIndex < m_word_count; wordIndex++)
+	{
+		const u64 freeBits = ~m_bitmap[wordIndex];
+		if (freeBits != 0)
+		{
+			m_search_word = wordIndex;
+			m_bitmap[wordIndex] |= freeBits & (~freeBits + 1);
+			m_live_count++;
+			alloc_region_t::p_used_bytes += t_elem_size;
+			return (wordIndex << 6) + bit_scan_forward(freeBits);
+		}
+	}
+
+	// out of memory
+	m_search_word = m_word_count;
+	return k_null_slot;
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::release_slot(const u32 i_index)
+{
+	const u32 wordIndex = i_index >> 6;
+	const u64 bit = (u64)1 << (i_index & 63);
+	FLORAL_ASSERT_MSG((m_bitmap[wordIndex] & bit) != 0, "Invalid free: the slot is not live");
+	m_bitmap[wordIndex] &= ~bit;
+	if (wordIndex < m_search_word)
+		m_search_word = wordIndex;
+	m_live_count--;
+	alloc_region_t::p_used_bytes -= t_elem_size;
+
+#if defined(ZERO_OUT_MEMORY)
+	memset(get_slot(i_index), 0, t_elem_size);
+#endif
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+voidptr bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::allocate(const_cstr i_desc /* = nullptr */)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	const u32 slotIndex = take_slot();
+	if (slotIndex == k_null_slot)
+		return nullptr;
+
+	t_tracking::register_allocation(get_header(slotIndex), t_elem_size, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+	return get_slot(slotIndex);
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+voidptr bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::allocate_aligned(const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment), "Alignment must be a power of two");
+	FLORAL_ASSERT_MSG(i_alignment <= k_slot_alignment, "Pool slots are not aligned enough");
+	return allocate(i_desc);
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::free(voidptr i_data)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	const u32 slotIndex = get_slot_index(i_data);
+	t_tracking::unregister_allocation(get_header(slotIndex));
+	release_slot(slotIndex);
+}
+
+// the tracking headers are not at a fixed offset from the slots, the batches go through a local array of them
+template <size t_elem_size, class t_tracking, class t_locking>
+const u32 bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::allocate_bulk(const u32 i_count, voidptr* o_ptrs, const_cstr i_desc /* = nullptr */)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	voidptr headers[64];
+	u32 allocated = 0;
+	while (allocated < i_count)
+	{
+		u32 batchCount = 0;
+		while (batchCount < 64 && allocated < i_count)
+		{
+			const u32 slotIndex = take_slot();
+			if (slotIndex == k_null_slot)
+				break;
+			headers[batchCount++] = get_header(slotIndex);
+			o_ptrs[allocated++] = get_slot(slotIndex);
+		}
+
+		t_tracking::register_allocations(headers, batchCount, 0, t_elem_size, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+		if (batchCount < 64)
+			break;
+	}
+	return allocated;
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::free_bulk(voidptr* i_ptrs, const u32 i_count)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	voidptr headers[64];
+	for (u32 first = 0; first < i_count; first += 64)
+	{
+		const u32 batchCount = (i_count - first < 64) ? (i_count - first) : 64;
+		for (u32 i = 0; i < batchCount; i++)
+			headers[i] = get_header(get_slot_index(i_ptrs[first + i]));
+		t_tracking::unregister_allocations(headers, batchCount, 0);
+
+		for (u32 i = 0; i < batchCount; i++)
+			release_slot(get_slot_index(i_ptrs[first + i]));
+	}
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+void bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::free_all()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	// no live list, the bitmap knows the live slots
+	if (t_tracking::k_tracks_allocations)
+	{
+		for (u32 slotIndex = find_slot(0, true); slotIndex < m_element_count; slotIndex = find_slot(slotIndex + 1, true))
+			t_tracking::unregister_allocation(get_header(slotIndex));
+	}
+	alloc_region_t::p_last_alloc = nullptr;
+	alloc_region_t::p_used_bytes = 0;
+#if defined(ZERO_OUT_MEMORY)
+	memset(m_first_slot, 0, (size)m_element_count * t_elem_size);
+#endif
+	reset_slots();
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+const size bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::trim()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	size releasedBytes = 0;
+	u32 slotIndex = find_slot(0, false);
+	while (slotIndex < m_element_count)
+	{
+		const u32 runEnd = find_slot(slotIndex, true);
+		releasedBytes += detail::purge_range((alloc_region_t&)*this, get_slot(slotIndex), get_slot(runEnd));
+		slotIndex = find_slot(runEnd, false);
+	}
+	return releasedBytes;
+}
+
+template <size t_elem_size, class t_tracking, class t_locking>
+template <class t_functor>
+void bitmap_pool_scheme<t_elem_size, t_tracking, t_locking>::for_each_live(t_functor i_fn)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	for (u32 wordIndex = 0; wordIndex < m_word_count; wordIndex++)
+	{
+		u64 word = m_bitmap[wordIndex];
+		if (wordIndex == m_word_count - 1 && (m_element_count & 63) != 0)
+			word &= ((u64)1 << (m_element_count & 63)) - 1;
+
+		while (word != 0)
+		{
+			i_fn((voidptr)get_slot((wordIndex << 6) + bit_scan_forward(word)));
+			word &= word - 1;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Freelist Allocation Scheme
+
+template <class t_tracking, class t_locking>
+freelist_scheme<t_tracking, t_locking>::freelist_scheme()
+	: alloc_region_t()
+	, k_min_frame_size(sizeof(alloc_header_t) + k_granularity)
+	, m_first_block(nullptr)
+	, m_end_address(nullptr)
+	, m_first_free_block(nullptr)
+	//, alloc_region_t::p_last_alloc(nullptr)
+	, p_alloc_count(0)
+	, p_free_count(0)
+{
+
+}
+
+template <class t_tracking, class t_locking>
+freelist_scheme<t_tracking, t_locking>::~freelist_scheme()
+{
+
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	alloc_region_t::p_base_address = (p8)i_baseAddress;
+	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+
+	// blocks tile [m_first_block, m_end_address) without any gap, so they need no adjustment
+	aptr firstBlock = (aptr)align_address(i_baseAddress, k_granularity);
+	aptr endAddress = ((aptr)i_baseAddress + i_sizeInBytes) & ~(aptr)(k_granularity - 1);
+	FLORAL_ASSERT_MSG(endAddress > firstBlock && endAddress - firstBlock >= k_min_frame_size, "Region is too small for freelist_scheme");
+	m_first_block = (p8)firstBlock;
+	m_end_address = (p8)endAddress;
+
+	reset_blocks();
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::map_to_reserved(voidptr i_baseAddress, const size i_sizeInBytes, const size i_committedBytes,
+		commit_func_t i_commitFunc, const_cstr i_name)
+{
+	// the first block header has to be in the committed part
+	FLORAL_ASSERT_MSG(i_committedBytes >= k_granularity + sizeof(alloc_header_t), "Not enough committed bytes for freelist_scheme");
+	map_to(i_baseAddress, i_sizeInBytes, i_name);
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	alloc_region_t::p_committed_bytes = i_committedBytes;
+	alloc_region_t::p_commit_func = i_commitFunc;
+}
+
+template <class t_tracking, class t_locking>
+const size freelist_scheme<t_tracking, t_locking>::trim()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	size releasedBytes = 0;
+	for (alloc_header_t* block = m_first_free_block; block; block = block->next_alloc)
+	{
+		releasedBytes += detail::purge_range((alloc_region_t&)*this, (p8)block + sizeof(alloc_header_t), (p8)block + block->frame_size);
+	}
+	return releasedBytes;
+}
+
+// inline services for allocation
+template <class t_tracking, class t_locking>
+const size freelist_scheme<t_tracking, t_locking>::get_frame_size(const size i_bytes)
+{
+	return align_size(sizeof(alloc_header_t) + (i_bytes > 0 ? i_bytes : 1), k_granularity);
+}
+
+// bytes to skip at the front of i_block so that the data right after the header is aligned to i_alignment,
+// either 0 or big enough to be left behind as a free block on its own
+template <class t_tracking, class t_locking>
+const size freelist_scheme<t_tracking, t_locking>::get_leading_gap(alloc_header_t* i_block, const size i_alignment)
+{
+	if (i_alignment <= k_granularity)
+		return 0;
+
+	aptr dataAddr = (aptr)i_block + sizeof(alloc_header_t);
+	size gap = align_size(dataAddr, i_alignment) - dataAddr;
+	if (gap != 0 && gap < k_min_frame_size)
+		gap = align_size(dataAddr + k_min_frame_size, i_alignment) - dataAddr;
+	return gap;
+}
+
+template <class t_tracking, class t_locking>
+typename freelist_scheme<t_tracking, t_locking>::alloc_header_t* freelist_scheme<t_tracking, t_locking>::get_next_phys_block(alloc_header_t* i_block)
+{
+	p8 nextBlock = (p8)i_block + i_block->frame_size;
+	return (nextBlock < m_end_address) ? (alloc_header_t*)nextBlock : nullptr;
+}
+
+// free blocks are kept in LIFO order, physical neighbours are found through the boundary tags
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::insert_free_block(alloc_header_t* i_block)
+{
+	i_block->is_free = true;
+	i_block->prev_alloc = nullptr;
+	i_block->next_alloc = m_first_free_block;
+	if (m_first_free_block)
+		m_first_free_block->prev_alloc = i_block;
+	m_first_free_block = i_block;
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::remove_free_block(alloc_header_t* i_block)
+{
+	if (i_block->prev_alloc)
+		i_block->prev_alloc->next_alloc = i_block->next_alloc;
+	if (i_block->next_alloc)
+		i_block->next_alloc->prev_alloc = i_block->prev_alloc;
+	if (m_first_free_block == i_block)
+		m_first_free_block = i_block->next_alloc;
+
+	i_block->is_free = false;
+	i_block->next_alloc = nullptr;
+	i_block->prev_alloc = nullptr;
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::reset_blocks()
+{
+	m_first_free_block = nullptr;
+
+	alloc_header_t* block = (alloc_header_t*)m_first_block;
+	block->frame_size = (size)(m_end_address - m_first_block);
+	block->adjustment = 0;
+	block->prev_phys_block = nullptr;
+	insert_free_block(block);
+}
+
+template <class t_tracking, class t_locking>
+voidptr freelist_scheme<t_tracking, t_locking>::allocate(const size i_bytes, const_cstr i_desc /* = nullptr */)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_block(i_bytes, k_granularity, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr freelist_scheme<t_tracking, t_locking>::allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment), "Alignment must be a power of two");
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_block(i_bytes, i_alignment, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr freelist_scheme<t_tracking, t_locking>::allocate_block(const size i_bytes, const size i_alignment, const_cstr i_desc)
+{
+	alloc_header_t* block = carve_block(i_bytes, i_alignment, i_desc);
+	if (block == nullptr)
+		return nullptr;
+
+	t_tracking::register_allocation(block, i_bytes, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+	return (p8)block + sizeof(alloc_header_t);
+}
+
+template <class t_tracking, class t_locking>
+typename freelist_scheme<t_tracking, t_locking>::alloc_header_t* freelist_scheme<t_tracking, t_locking>::carve_block(const size i_bytes, const size i_alignment, const_cstr i_desc)
+{
+	const size frameSize = get_frame_size(i_bytes);
+
+	// first-fit strategy
+	alloc_header_t* currBlock = m_first_free_block;
+	size leadingGap = 0;
+	// search
+	while (currBlock) {
+		leadingGap = get_leading_gap(currBlock, i_alignment);
+		if (currBlock->frame_size >= leadingGap + frameSize)
+			break;
+		currBlock = currBlock->next_alloc;
+	}
+
+	if (currBlock) { // found it!
+		// reserved regions: commit the frame and the header of the free block trimmed after it
+		p8 commitEnd = (p8)currBlock + leadingGap + frameSize + sizeof(alloc_header_t);
+		p8 blockEnd = (p8)currBlock + currBlock->frame_size;
+		if (!detail::commit_to((alloc_region_t&)*this, commitEnd < blockEnd ? commitEnd : blockEnd))
+			return nullptr;
+
+		remove_free_block(currBlock);
+
+		// C0: the front of the block is only padding, it stays free on its own
+		if (leadingGap > 0) {
+			alloc_header_t* alignedBlock = (alloc_header_t*)((p8)currBlock + leadingGap);
+			alignedBlock->frame_size = currBlock->frame_size - leadingGap;
+			alignedBlock->adjustment = 0;
+			alignedBlock->is_free = false;
+			alignedBlock->prev_phys_block = currBlock;
+			alloc_header_t* nextBlock = get_next_phys_block(alignedBlock);
+			if (nextBlock)
+				nextBlock->prev_phys_block = alignedBlock;
+			currBlock->frame_size = leadingGap;
+			insert_free_block(currBlock);
+			currBlock = alignedBlock;
+		}
+
+		// C1: a new free block needs to be created
+		// C2: else, we can use all of this block
+		trim_block(currBlock, frameSize);
+
+		detail::link_allocation((alloc_region_t&)*this, currBlock, i_desc);
+		alloc_region_t::p_used_bytes += currBlock->frame_size;
+
+		p_alloc_count++;
+		return currBlock;
+	}
+	// nothing found, cannot allocate anything
+	return nullptr;
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::trim_block(alloc_header_t* i_block, const size i_frameSize)
+{
+	if (i_block->frame_size - i_frameSize < k_min_frame_size)
+		return;
+
+	alloc_header_t* newBlock = (alloc_header_t*)((p8)i_block + i_frameSize);
+	newBlock->frame_size = i_block->frame_size - i_frameSize;
+	newBlock->adjustment = 0;
+	i_block->frame_size = i_frameSize;
+
+	// update boundary tags, a shrinking allocation may be followed by a free block
+	newBlock->prev_phys_block = i_block;
+	alloc_header_t* nextBlock = get_next_phys_block(newBlock);
+	if (nextBlock && nextBlock->is_free) {
+		remove_free_block(nextBlock);
+		newBlock->frame_size += nextBlock->frame_size;
+		nextBlock = get_next_phys_block(newBlock);
+	}
+	if (nextBlock)
+		nextBlock->prev_phys_block = newBlock;
+
+	insert_free_block(newBlock);
+}
+
+// grow into the next physical block if it is free and big enough, or shrink, without moving the data
+template <class t_tracking, class t_locking>
+const bool freelist_scheme<t_tracking, t_locking>::resize_block(alloc_header_t* i_block, const size i_newBytes)
+{
+	const size newFrameSize = get_frame_size(i_newBytes);
+	const size oldFrameSize = i_block->frame_size;
+
+	if (newFrameSize > oldFrameSize) {
+		alloc_header_t* nextBlock = get_next_phys_block(i_block);
+		if (nextBlock == nullptr || !nextBlock->is_free || oldFrameSize + nextBlock->frame_size < newFrameSize)
+			return false;
+
+		p8 commitEnd = (p8)i_block + newFrameSize + sizeof(alloc_header_t);
+		p8 blockEnd = (p8)nextBlock + nextBlock->frame_size;
+		if (!detail::commit_to((alloc_region_t&)*this, commitEnd < blockEnd ? commitEnd : blockEnd))
+			return false;
+
+		remove_free_block(nextBlock);
+		i_block->frame_size += nextBlock->frame_size;
+		alloc_header_t* afterBlock = get_next_phys_block(i_block);
+		if (afterBlock)
+			afterBlock->prev_phys_block = i_block;
+	}
+
+	trim_block(i_block, newFrameSize);
+	alloc_region_t::p_used_bytes = alloc_region_t::p_used_bytes - oldFrameSize + i_block->frame_size;
+	return true;
+}
+
+template <class t_tracking, class t_locking>
+voidptr freelist_scheme<t_tracking, t_locking>::reallocate(voidptr i_data, const size i_newBytes)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	if (i_data == nullptr)
+		return allocate_block(i_newBytes, k_granularity, nullptr);
+
+	alloc_header_t* oldBlock = (alloc_header_t*)((p8)i_data - sizeof(alloc_header_t));
+	FLORAL_ASSERT_MSG(!oldBlock->is_free, "Invalid reallocate: block is already free");
+	if (resize_block(oldBlock, i_newBytes)) {
+		t_tracking::resize_allocation(oldBlock, i_newBytes);
+		return i_data;
+	}
+
+	// fall back to a copy
+	voidptr newAllocation = allocate_block(i_newBytes, k_granularity, nullptr);
+
+	if (newAllocation != nullptr) {
+		size dataSizeBytes = oldBlock->frame_size - sizeof(alloc_header_t);
+
+		// NOTE: sometimes, the reallocated size is smaller than the previously allocated size.
+		memcpy(newAllocation, i_data, floral::min(i_newBytes, dataSizeBytes));
+
+		// now we can free the old data, we already hold the lock
+		free_block(oldBlock);
+
+		return newAllocation;
+	}
+	return nullptr;
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::free(voidptr i_data)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	alloc_header_t* releaseBlock = (alloc_header_t*)((p8)i_data - sizeof(alloc_header_t));
+	FLORAL_ASSERT_MSG(!releaseBlock->is_free, "Invalid free: block is already free");
+	free_block(releaseBlock);
+}
+
+template <class t_tracking, class t_locking>
+const size freelist_scheme<t_tracking, t_locking>::get_usable_size(voidptr i_data) const
+{
+	const alloc_header_t* block = (const alloc_header_t*)((p8)i_data - sizeof(alloc_header_t));
+	return block->frame_size - sizeof(alloc_header_t);
+}
+
+template <class t_tracking, class t_locking>
+const u32 freelist_scheme<t_tracking, t_locking>::allocate_bulk(const u32 i_count, const size i_bytes, voidptr* o_ptrs, const_cstr i_desc /* = nullptr */)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	u32 allocated = 0;
+	while (allocated < i_count)
+	{
+		alloc_header_t* block = carve_block(i_bytes, k_granularity, i_desc);
+		if (block == nullptr)
+			break;
+		o_ptrs[allocated++] = (p8)block + sizeof(alloc_header_t);
+	}
+
+	t_tracking::register_allocations(o_ptrs, allocated, sizeof(alloc_header_t), i_bytes, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+	return allocated;
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::free_bulk(voidptr* i_ptrs, const u32 i_count)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	t_tracking::unregister_allocations(i_ptrs, i_count, sizeof(alloc_header_t));
+	for (u32 i = 0; i < i_count; i++)
+	{
+		alloc_header_t* releaseBlock = (alloc_header_t*)((p8)i_ptrs[i] - sizeof(alloc_header_t));
+		FLORAL_ASSERT_MSG(!releaseBlock->is_free, "Invalid free: block is already free");
+		release_block(releaseBlock);
+	}
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::free_block(alloc_header_t* i_block)
+{
+	t_tracking::unregister_allocation(i_block);
+	release_block(i_block);
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::release_block(alloc_header_t* i_block)
+{
+	alloc_header_t* releaseBlock = i_block;
+	alloc_region_t::p_used_bytes -= releaseBlock->frame_size;
+	p_free_count++;
+
+	detail::unlink_allocation((alloc_region_t&)*this, releaseBlock);
+
+#if defined(ZERO_OUT_MEMORY)
+	// erase its content
+	p8 pData = (p8)releaseBlock + sizeof(alloc_header_t);
+	memset(pData, 0, releaseBlock->frame_size - sizeof(alloc_header_t));
+#endif
+
+	// join with the physical neighbours if they are free, no need to search the free list
+	alloc_header_t* prevBlock = releaseBlock->prev_phys_block;
+	if (prevBlock && prevBlock->is_free) {
+		remove_free_block(prevBlock);
+		prevBlock->frame_size += releaseBlock->frame_size;
+		releaseBlock = prevBlock;
+	}
+
+	alloc_header_t* nextBlock = get_next_phys_block(releaseBlock);
+	if (nextBlock && nextBlock->is_free) {
+		remove_free_block(nextBlock);
+		releaseBlock->frame_size += nextBlock->frame_size;
+		nextBlock = get_next_phys_block(releaseBlock);
+	}
+
+	if (nextBlock)
+		nextBlock->prev_phys_block = releaseBlock;
+
+	insert_free_block(releaseBlock);
+}
+
+template <class t_tracking, class t_locking>
+void freelist_scheme<t_tracking, t_locking>::free_all()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+
+	detail::unregister_live_allocations<t_tracking>((alloc_region_t&)*this);
+	alloc_region_t::p_last_alloc = nullptr;
+	alloc_region_t::p_used_bytes = 0;
+	p_alloc_count = 0;
+	p_free_count = 0;
+#if defined(ZERO_OUT_MEMORY)
+	memset(alloc_region_t::p_base_address, 0, detail::get_committed_bytes((alloc_region_t&)*this));
+#endif
+
+	reset_blocks();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// TLSF Allocation Scheme
+
+template <class t_tracking, class t_locking>
+tlsf_scheme<t_tracking, t_locking>::tlsf_scheme()
+	: alloc_region_t()
+	, k_min_frame_size(sizeof(alloc_header_t) + k_granularity)
+	, m_first_block(nullptr)
+	, m_end_address(nullptr)
+	, m_fl_bitmap(0)
+	, p_alloc_count(0)
+	, p_free_count(0)
+{
+	memset(m_sl_bitmap, 0, sizeof(m_sl_bitmap));
+	memset(m_free_blocks, 0, sizeof(m_free_blocks));
+}
+
+template <class t_tracking, class t_locking>
+tlsf_scheme<t_tracking, t_locking>::~tlsf_scheme()
+{
+
+}
+
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	FLORAL_ASSERT_MSG(i_sizeInBytes < ((size)1 << k_fl_index_max), "Region is too big for tlsf_scheme");
+	alloc_region_t::p_base_address = (p8)i_baseAddress;
+	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+
+	// every block starts at a multiple of k_granularity and has a size multiple of k_granularity,
+	// so blocks are always physically contiguous and need no adjustment
+	aptr firstBlock = ((aptr)i_baseAddress + k_granularity - 1) & ~(aptr)(k_granularity - 1);
+	aptr endAddress = ((aptr)i_baseAddress + i_sizeInBytes) & ~(aptr)(k_granularity - 1);
+	FLORAL_ASSERT_MSG(endAddress > firstBlock && endAddress - firstBlock >= k_min_frame_size, "Region is too small for tlsf_scheme");
+	m_first_block = (p8)firstBlock;
+	m_end_address = (p8)endAddress;
+
+	reset_blocks();
+}
+
+template <class t_tracking, class t_locking>
+const size tlsf_scheme<t_tracking, t_locking>::get_frame_size(const size i_bytes)
+{
+	size frameSize = (sizeof(alloc_header_t) + i_bytes + k_granularity - 1) & ~(k_granularity - 1);
+	return (frameSize < sizeof(alloc_header_t) + k_granularity) ? sizeof(alloc_header_t) + k_granularity : frameSize;
+}
+
+// (fl, sl) of the bucket which a block of i_frameSize belongs to
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::mapping_insert(const size i_frameSize, u32& o_fl, u32& o_sl)
+{
+	if (i_frameSize < k_small_block_size)
+	{
+		// small blocks are linearly spread over the second-level of the first bucket
+		o_fl = 0;
+		o_sl = (u32)(i_frameSize / (k_small_block_size / k_sl_index_count));
+	}
+	else
+	{
+		u32 fl = bit_scan_reverse(i_frameSize);
+		o_sl = (u32)(i_frameSize >> (fl - k_sl_index_count_log2)) ^ k_sl_index_count;
+		o_fl = fl - (k_fl_index_shift - 1);
+	}
+}
+
+// (fl, sl) of the first bucket whose every block is big enough for i_frameSize,
+// this rounds the size up to the next second-level boundary so we never have to walk a bucket
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::mapping_search(const size i_frameSize, u32& o_fl, u32& o_sl)
+{
+	size frameSize = i_frameSize;
+	if (frameSize >= k_small_block_size)
+	{
+		frameSize += ((size)1 << (bit_scan_reverse(frameSize) - k_sl_index_count_log2)) - 1;
+	}
+	mapping_insert(frameSize, o_fl, o_sl);
+}
+
+template <class t_tracking, class t_locking>
+typename tlsf_scheme<t_tracking, t_locking>::alloc_header_t* tlsf_scheme<t_tracking, t_locking>::find_suitable_block(u32& io_fl, u32& io_sl)
+{
+	if (io_fl >= k_fl_index_count)
+		return nullptr;
+
+	// first look for a non-empty bucket in the same first-level...
+	u32 slMap = m_sl_bitmap[io_fl] & (~0u << io_sl);
+	if (!slMap)
+	{
+		// ...then in the bigger first-levels
+		u64 flMap = m_fl_bitmap & (~(u64)0 << (io_fl + 1));
+		if (!flMap)
+			return nullptr;
+
+		io_fl = bit_scan_forward(flMap);
+		slMap = m_sl_bitmap[io_fl];
+	}
+	io_sl = bit_scan_forward(slMap);
+	return m_free_blocks[io_fl][io_sl];
+}
+
+template <class t_tracking, class t_locking>
+typename tlsf_scheme<t_tracking, t_locking>::alloc_header_t* tlsf_scheme<t_tracking, t_locking>::get_next_phys_block(alloc_header_t* i_block)
+{
+	p8 nextBlock = (p8)i_block + i_block->frame_size;
+	return (nextBlock < m_end_address) ? (alloc_header_t*)nextBlock : nullptr;
+}
+
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::insert_free_block(alloc_header_t* i_block)
+{
+	u32 fl = 0, sl = 0;
+	mapping_insert(i_block->frame_size, fl, sl);
+
+	alloc_header_t* head = m_free_blocks[fl][sl];
+	i_block->is_free = true;
+	i_block->next_alloc = head;
+	i_block->prev_alloc = nullptr;
+	if (head)
+		head->prev_alloc = i_block;
+	m_free_blocks[fl][sl] = i_block;
+
+	m_fl_bitmap |= (u64)1 << fl;
+	m_sl_bitmap[fl] |= 1u << sl;
+}
+
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::remove_free_block(alloc_header_t* i_block)
+{
+	u32 fl = 0, sl = 0;
+	mapping_insert(i_block->frame_size, fl, sl);
+
+	if (i_block->next_alloc)
+		i_block->next_alloc->prev_alloc = i_block->prev_alloc;
+	if (i_block->prev_alloc)
+		i_block->prev_alloc->next_alloc = i_block->next_alloc;
+
+	if (m_free_blocks[fl][sl] == i_block)
+	{
+		m_free_blocks[fl][sl] = i_block->next_alloc;
+		if (m_free_blocks[fl][sl] == nullptr)
+		{
+			m_sl_bitmap[fl] &= ~(1u << sl);
+			if (m_sl_bitmap[fl] == 0)
+				m_fl_bitmap &= ~((u64)1 << fl);
+		}
+	}
+
+	i_block->is_free = false;
+	i_block->next_alloc = nullptr;
+	i_block->prev_alloc = nullptr;
+}
+
+// bytes to skip at the front of i_block so that the data right after the header is aligned to i_alignment,
+// either 0 or big enough to be left behind as a free block on its own
+template <class t_tracking, class t_locking>
+const size tlsf_scheme<t_tracking, t_locking>::get_leading_gap(alloc_header_t* i_block, const size i_alignment)
+{
+	if (i_alignment <= k_granularity)
+		return 0;
+
+	aptr dataAddr = (aptr)i_block + sizeof(alloc_header_t);
+	size gap = align_size(dataAddr, i_alignment) - dataAddr;
+	if (gap != 0 && gap < k_min_frame_size)
+		gap = align_size(dataAddr + k_min_frame_size, i_alignment) - dataAddr;
+	return gap;
+}
+
+template <class t_tracking, class t_locking>
+voidptr tlsf_scheme<t_tracking, t_locking>::allocate_block(const size i_bytes, const size i_alignment, const_cstr i_desc)
+{
+	const size frameSize = get_frame_size(i_bytes);
+	// an over-aligned request is looked up with room for the worst leading gap, so any block found fits
+	const size searchSize = (i_alignment > k_granularity) ? frameSize + i_alignment + k_min_frame_size : frameSize;
+	u32 fl = 0, sl = 0;
+	mapping_search(searchSize, fl, sl);
+
+	alloc_header_t* block = find_suitable_block(fl, sl);
+	if (block == nullptr)
+	{
+		// nothing found, cannot allocate anything
+		return nullptr;
+	}
+
+	remove_free_block(block);
+
+	// give the padding in front of an over-aligned block back as a free block
+	const size leadingGap = get_leading_gap(block, i_alignment);
+	if (leadingGap > 0)
+	{
+		alloc_header_t* alignedBlock = (alloc_header_t*)((p8)block + leadingGap);
+		alignedBlock->frame_size = block->frame_size - leadingGap;
+		alignedBlock->adjustment = 0;
+		alignedBlock->is_free = false;
+		alignedBlock->prev_phys_block = block;
+		alloc_header_t* nextBlock = get_next_phys_block(alignedBlock);
+		if (nextBlock)
+			nextBlock->prev_phys_block = alignedBlock;
+		block->frame_size = leadingGap;
+		insert_free_block(block);
+		block = alignedBlock;
+	}
+
+	// split off the tail of the block if it can hold another block
+	trim_block(block, frameSize);
+
+	detail::link_allocation((alloc_region_t&)*this, block, i_desc);
+	t_tracking::register_allocation(block, i_bytes, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+	alloc_region_t::p_used_bytes += block->frame_size;
+
+	p8 dataAddr = (p8)block + sizeof(alloc_header_t);
+#if defined(ZERO_OUT_MEMORY)
+	memset(dataAddr, 0, i_bytes);
+#endif
+
+	p_alloc_count++;
+	return dataAddr;
+}
+
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::trim_block(alloc_header_t* i_block, const size i_frameSize)
+{
+	if (i_block->frame_size - i_frameSize < k_min_frame_size)
+		return;
+
+	alloc_header_t* remainBlock = (alloc_header_t*)((p8)i_block + i_frameSize);
+	remainBlock->frame_size = i_block->frame_size - i_frameSize;
+	remainBlock->adjustment = 0;
+	remainBlock->prev_phys_block = i_block;
+	i_block->frame_size = i_frameSize;
+
+	// a shrinking allocation may be followed by a free block
+	alloc_header_t* nextBlock = get_next_phys_block(remainBlock);
+	if (nextBlock && nextBlock->is_free)
+	{
+		remove_free_block(nextBlock);
+		remainBlock->frame_size += nextBlock->frame_size;
+		nextBlock = get_next_phys_block(remainBlock);
+	}
+	if (nextBlock)
+		nextBlock->prev_phys_block = remainBlock;
+
+	insert_free_block(remainBlock);
+}
+
+// grow into the next physical block if it is free and big enough, or shrink, without moving the data
+template <class t_tracking, class t_locking>
+const bool tlsf_scheme<t_tracking, t_locking>::resize_block(alloc_header_t* i_block, const size i_newBytes)
+{
+	const size newFrameSize = get_frame_size(i_newBytes);
+	const size oldFrameSize = i_block->frame_size;
+
+	if (newFrameSize > oldFrameSize)
+	{
+		alloc_header_t* nextBlock = get_next_phys_block(i_block);
+		if (nextBlock == nullptr || !nextBlock->is_free || oldFrameSize + nextBlock->frame_size < newFrameSize)
+			return false;
+
+		remove_free_block(nextBlock);
+		i_block->frame_size += nextBlock->frame_size;
+		alloc_header_t* afterBlock = get_next_phys_block(i_block);
+		if (afterBlock)
+			afterBlock->prev_phys_block = i_block;
+	}
+
+	trim_block(i_block, newFrameSize);
+	alloc_region_t::p_used_bytes = alloc_region_t::p_used_bytes - oldFrameSize + i_block->frame_size;
+	return true;
+}
+
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::free_block(alloc_header_t* i_block)
+{
+	alloc_region_t::p_used_bytes -= i_block->frame_size;
+	t_tracking::unregister_allocation(i_block);
+	p_free_count++;
+
+	detail::unlink_allocation((alloc_region_t&)*this, i_block);
+
+#if defined(ZERO_OUT_MEMORY)
+	memset((p8)i_block + sizeof(alloc_header_t), 0, i_block->frame_size - sizeof(alloc_header_t));
+#endif
+
+	// coalesce with both physical neighbours, no list walking needed
+	alloc_header_t* block = i_block;
+	alloc_header_t* prevBlock = block->prev_phys_block;
+	if (prevBlock && prevBlock->is_free)
+	{
+		remove_free_block(prevBlock);
+		prevBlock->frame_size += block->frame_size;
+		block = prevBlock;
+	}
+
+	alloc_header_t* nextBlock = get_next_phys_block(block);
+	if (nextBlock && nextBlock->is_free)
+	{
+		remove_free_block(nextBlock);
+		block->frame_size += nextBlock->frame_size;
+		nextBlock = get_next_phys_block(block);
+	}
+
+	if (nextBlock)
+		nextBlock->prev_phys_block = block;
+
+	insert_free_block(block);
+}
+
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::reset_blocks()
+{
+	m_fl_bitmap = 0;
+	memset(m_sl_bitmap, 0, sizeof(m_sl_bitmap));
+	memset(m_free_blocks, 0, sizeof(m_free_blocks));
+
+	alloc_header_t* block = (alloc_header_t*)m_first_block;
+	block->frame_size = (size)(m_end_address - m_first_block);
+	block->adjustment = 0;
+	block->prev_phys_block = nullptr;
+	insert_free_block(block);
+}
+
+template <class t_tracking, class t_locking>
+voidptr tlsf_scheme<t_tracking, t_locking>::allocate(const size i_bytes, const_cstr i_desc /* = nullptr */)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_block(i_bytes, k_granularity, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr tlsf_scheme<t_tracking, t_locking>::allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment), "Alignment must be a power of two");
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_block(i_bytes, i_alignment, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr tlsf_scheme<t_tracking, t_locking>::reallocate(voidptr i_data, const size i_newBytes)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	if (i_data == nullptr)
+		return allocate_block(i_newBytes, k_granularity, nullptr);
+
+	alloc_header_t* releaseBlock = (alloc_header_t*)((p8)i_data - sizeof(alloc_header_t));
+	FLORAL_ASSERT_MSG(!releaseBlock->is_free, "Invalid reallocate: block is already free");
+	if (resize_block(releaseBlock, i_newBytes)) {
+		t_tracking::resize_allocation(releaseBlock, i_newBytes);
+		return i_data;
+	}
+
+	// fall back to a copy
+	voidptr newAllocation = allocate_block(i_newBytes, k_granularity, nullptr);
+
+	if (newAllocation != nullptr) {
+		size dataSizeBytes = releaseBlock->frame_size - sizeof(alloc_header_t);
+
+		memcpy(newAllocation, i_data, floral::min(i_newBytes, dataSizeBytes));
+		free_block(releaseBlock);
+
+		return newAllocation;
+	}
+	return nullptr;
+}
+
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::free(voidptr i_data)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	alloc_header_t* releaseBlock = (alloc_header_t*)((p8)i_data - sizeof(alloc_header_t));
+	FLORAL_ASSERT_MSG(!releaseBlock->is_free, "Invalid free: block is already free");
+	free_block(releaseBlock);
+}
+
+template <class t_tracking, class t_locking>
+const size tlsf_scheme<t_tracking, t_locking>::get_usable_size(voidptr i_data) const
+{
+	const alloc_header_t* block = (const alloc_header_t*)((p8)i_data - sizeof(alloc_header_t));
+	return block->frame_size - sizeof(alloc_header_t);
+}
+
+template <class t_tracking, class t_locking>
+void tlsf_scheme<t_tracking, t_locking>::free_all()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+
+	detail::unregister_live_allocations<t_tracking>((alloc_region_t&)*this);
+	alloc_region_t::p_last_alloc = nullptr;
+	alloc_region_t::p_used_bytes = 0;
 	p_alloc_count = 0;
 	p_free_count = 0;
 #if defined(ZERO_OUT_MEMORY)
 	memset(alloc_region_t::p_base_address, 0, alloc_region_t::p_size_in_bytes);
 #endif
 
-	m_first_free_block = (alloc_header_t*)alloc_region_t::p_base_address;
-	m_first_free_block->frame_size = alloc_region_t::p_size_in_bytes;
-	m_first_free_block->adjustment = 0;
-	m_first_free_block->next_alloc = nullptr;
-	m_first_free_block->prev_alloc = nullptr;
+	reset_blocks();
+}
+
+template <class t_tracking, class t_locking>
+const size tlsf_scheme<t_tracking, t_locking>::trim()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	size releasedBytes = 0;
+	for (alloc_header_t* block = (alloc_header_t*)m_first_block; block; block = get_next_phys_block(block))
+	{
+		if (block->is_free)
+			releasedBytes += detail::purge_range((alloc_region_t&)*this, (p8)block + sizeof(alloc_header_t), (p8)block + block->frame_size);
+	}
+	return releasedBytes;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Slab Allocation Scheme
+
+template <class t_tracking, class t_locking>
+slab_scheme<t_tracking, t_locking>::slab_scheme()
+	: alloc_region_t()
+	, m_first_slab(nullptr)
+	, m_end_slab(nullptr)
+	, m_next_fresh_slab(nullptr)
+	, m_free_slabs(nullptr)
+	, m_free_slab_count(0)
+{
+
+}
+
+template <class t_tracking, class t_locking>
+slab_scheme<t_tracking, t_locking>::~slab_scheme()
+{
+
+}
+
+// [8], [16, 32 .. 128] every 16 bytes, then 4 classes per power of two up to 4096
+template <class t_tracking, class t_locking>
+const u32 slab_scheme<t_tracking, t_locking>::get_class_index(const size i_bytes)
+{
+	if (i_bytes <= 8)
+		return 0;
+	if (i_bytes <= 128)
+		return (u32)((i_bytes + 15) >> 4);
+
+	const size lastByte = i_bytes - 1;
+	const u32 powerOfTwo = bit_scan_reverse(lastByte);
+	return 9 + (powerOfTwo - 7) * 4 + (u32)((lastByte >> (powerOfTwo - 2)) & 3);
+}
+
+template <class t_tracking, class t_locking>
+const size slab_scheme<t_tracking, t_locking>::get_class_size(const u32 i_classIndex)
+{
+	if (i_classIndex < 9)
+		return (i_classIndex == 0) ? 8 : ((size)i_classIndex << 4);
+
+	const u32 group = (i_classIndex - 9) >> 2;
+	const u32 step = (i_classIndex - 9) & 3;
+	return ((size)128 << group) + (step + 1) * ((size)32 << group);
+}
+
+template <class t_tracking, class t_locking>
+const u32 slab_scheme<t_tracking, t_locking>::get_aligned_class_index(const size i_bytes, const size i_alignment)
+{
+	u32 classIndex = get_class_index(i_bytes);
+	while (classIndex < k_class_count && natural_alignment(get_slot_size(classIndex), HL_CACHE_LINE_SIZE) < i_alignment)
+		classIndex++;
+	return classIndex;
+}
+
+template <class t_tracking, class t_locking>
+void slab_scheme<t_tracking, t_locking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	alloc_region_t::p_base_address = (p8)i_baseAddress;
+	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+
+	aptr firstSlab = align_size((aptr)i_baseAddress, k_slab_size);
+	aptr endSlab = ((aptr)i_baseAddress + i_sizeInBytes) & ~(aptr)(k_slab_size - 1);
+	FLORAL_ASSERT_MSG(endSlab > firstSlab, "Region is too small for slab_scheme, it needs at least one aligned slab");
+	m_first_slab = (p8)firstSlab;
+	m_end_slab = (p8)endSlab;
+
+	reset_slabs();
+}
+
+template <class t_tracking, class t_locking>
+void slab_scheme<t_tracking, t_locking>::reset_slabs()
+{
+	m_next_fresh_slab = m_first_slab;
+	m_free_slabs = nullptr;
+	m_free_slab_count = 0;
+	memset(m_classes, 0, sizeof(m_classes));
+}
+
+template <class t_tracking, class t_locking>
+typename slab_scheme<t_tracking, t_locking>::slab_header* slab_scheme<t_tracking, t_locking>::acquire_slab(const u32 i_classIndex)
+{
+	slab_header* slab = nullptr;
+	if (m_free_slabs)
+	{
+		slab = m_free_slabs;
+		m_free_slabs = slab->next_slab;
+		m_free_slab_count--;
+	}
+	else if (m_next_fresh_slab < m_end_slab)
+	{
+		slab = (slab_header*)m_next_fresh_slab;
+		m_next_fresh_slab += k_slab_size;
+	}
+	else
+	{
+		// out of memory
+		return nullptr;
+	}
+
+	// the data of the first slot starts on a cache line, so does every slot whose size is a multiple of it
+	const size slotSize = get_slot_size(i_classIndex);
+	p8 firstData = (p8)align_address((p8)slab + sizeof(slab_header) + k_header_size, HL_CACHE_LINE_SIZE);
+	slab->fresh_slot = firstData - k_header_size;
+	slab->slot_count = (u32)(((p8)slab + k_slab_size - slab->fresh_slot) / slotSize);
+	slab->free_slot = nullptr;
+	slab->class_index = i_classIndex;
+	slab->used_slots = 0;
+
+	size_class& sizeClass = m_classes[i_classIndex];
+	insert_partial_slab(sizeClass, slab);
+	sizeClass.slab_count++;
+	return slab;
+}
+
+template <class t_tracking, class t_locking>
+void slab_scheme<t_tracking, t_locking>::release_slab(slab_header* i_slab)
+{
+	size_class& sizeClass = m_classes[i_slab->class_index];
+	remove_partial_slab(sizeClass, i_slab);
+	sizeClass.slab_count--;
+
+	i_slab->next_slab = m_free_slabs;
+	m_free_slabs = i_slab;
+	m_free_slab_count++;
+}
+
+template <class t_tracking, class t_locking>
+void slab_scheme<t_tracking, t_locking>::insert_partial_slab(size_class& io_class, slab_header* i_slab)
+{
+	i_slab->prev_slab = nullptr;
+	i_slab->next_slab = io_class.partial_slabs;
+	if (io_class.partial_slabs)
+		io_class.partial_slabs->prev_slab = i_slab;
+	io_class.partial_slabs = i_slab;
+}
+
+template <class t_tracking, class t_locking>
+void slab_scheme<t_tracking, t_locking>::remove_partial_slab(size_class& io_class, slab_header* i_slab)
+{
+	if (i_slab->prev_slab)
+		i_slab->prev_slab->next_slab = i_slab->next_slab;
+	if (i_slab->next_slab)
+		i_slab->next_slab->prev_slab = i_slab->prev_slab;
+	if (io_class.partial_slabs == i_slab)
+		io_class.partial_slabs = i_slab->next_slab;
+	i_slab->next_slab = nullptr;
+	i_slab->prev_slab = nullptr;
+}
+
+template <class t_tracking, class t_locking>
+voidptr slab_scheme<t_tracking, t_locking>::allocate(const size i_bytes, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(i_bytes <= k_max_small_size, "slab_scheme only serves small allocations");
+	if (i_bytes > k_max_small_size)
+		return nullptr;
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_slot(get_class_index(i_bytes), i_bytes, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr slab_scheme<t_tracking, t_locking>::allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment), "Alignment must be a power of two");
+	FLORAL_ASSERT_MSG(i_bytes <= k_max_small_size, "slab_scheme only serves small allocations");
+	if (i_bytes > k_max_small_size)
+		return nullptr;
+
+	const u32 classIndex = get_aligned_class_index(i_bytes, i_alignment);
+	FLORAL_ASSERT_MSG(classIndex < k_class_count, "No size class is aligned enough");
+	if (classIndex == k_class_count)
+		return nullptr;
+
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_slot(classIndex, i_bytes, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr slab_scheme<t_tracking, t_locking>::allocate_slot(const u32 i_classIndex, const size i_bytes, const_cstr i_desc)
+{
+	size_class& sizeClass = m_classes[i_classIndex];
+	slab_header* slab = sizeClass.partial_slabs;
+	if (slab == nullptr)
+	{
+		slab = acquire_slab(i_classIndex);
+		if (slab == nullptr)
+			return nullptr;
+	}
+
+	const size slotSize = get_slot_size(i_classIndex);
+	alloc_header_t* header = slab->free_slot;
+	if (header)
+	{
+		slab->free_slot = get_next_free_slot(header);
+	}
+	else
+	{
+		header = (alloc_header_t*)slab->fresh_slot;
+		slab->fresh_slot += slotSize;
+	}
+
+	// full slabs leave the partial list until one of their slots is freed
+	slab->used_slots++;
+	if (slab->used_slots == slab->slot_count)
+		remove_partial_slab(sizeClass, slab);
+
+	detail::set_frame_info(header, slotSize, 0);
+	detail::link_allocation((alloc_region_t&)*this, header, i_desc);
+	t_tracking::register_allocation(header, i_bytes, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+
+	alloc_region_t::p_used_bytes += slotSize;
+	sizeClass.live_slots++;
+	sizeClass.alloc_count++;
+
+	voidptr dataAddr = (p8)header + k_header_size;
+#if defined(ZERO_OUT_MEMORY)
+	memset(dataAddr, 0, get_class_size(i_classIndex));
+#endif
+	return dataAddr;
+}
+
+template <class t_tracking, class t_locking>
+voidptr slab_scheme<t_tracking, t_locking>::reallocate(voidptr i_data, const size i_newBytes)
+{
+	FLORAL_ASSERT_MSG(i_newBytes <= k_max_small_size, "slab_scheme only serves small allocations");
+	if (i_newBytes > k_max_small_size)
+		return nullptr;
+
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	const u32 newClassIndex = get_class_index(i_newBytes);
+	if (i_data == nullptr)
+		return allocate_slot(newClassIndex, i_newBytes, nullptr);
+
+	alloc_header_t* oldHeader = (alloc_header_t*)((p8)i_data - k_header_size);
+	const u32 oldClassIndex = get_slab(oldHeader)->class_index;
+	if (newClassIndex == oldClassIndex)
+	{
+		t_tracking::resize_allocation(oldHeader, i_newBytes);
+		return i_data;
+	}
+
+	voidptr newAllocation = allocate_slot(newClassIndex, i_newBytes, nullptr);
+	if (newAllocation != nullptr)
+	{
+		memcpy(newAllocation, i_data, floral::min(i_newBytes, get_class_size(oldClassIndex)));
+		free_slot(i_data, oldClassIndex);
+	}
+	return newAllocation;
+}
+
+template <class t_tracking, class t_locking>
+void slab_scheme<t_tracking, t_locking>::free(voidptr i_data)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	free_slot(i_data, get_slab((alloc_header_t*)((p8)i_data - k_header_size))->class_index);
+}
+
+template <class t_tracking, class t_locking>
+void slab_scheme<t_tracking, t_locking>::free_sized(voidptr i_data, const size i_bytes, const size i_alignment)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment), "Alignment must be a power of two");
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	// the same class allocate_aligned() picked for this size and alignment
+	free_slot(i_data, get_aligned_class_index(i_bytes, i_alignment));
+}
+
+template <class t_tracking, class t_locking>
+const size slab_scheme<t_tracking, t_locking>::get_usable_size(voidptr i_data) const
+{
+	return get_class_size(get_slab((alloc_header_t*)((p8)i_data - k_header_size))->class_index);
+}
+
+template <class t_tracking, class t_locking>
+void slab_scheme<t_tracking, t_locking>::free_slot(voidptr i_data, const u32 i_classIndex)
+{
+	alloc_header_t* header = (alloc_header_t*)((p8)i_data - k_header_size);
+	slab_header* slab = get_slab(header);
+	FLORAL_ASSERT_MSG((p8)slab >= m_first_slab && (p8)slab < m_next_fresh_slab && slab->used_slots > 0, "Invalid free: not a live slab allocation");
+	FLORAL_ASSERT_MSG(slab->class_index == i_classIndex, "Invalid free: the size does not match the allocation");
+	size_class& sizeClass = m_classes[i_classIndex];
+
+	t_tracking::unregister_allocation(header);
+	detail::unlink_allocation((alloc_region_t&)*this, header);
+
+#if defined(ZERO_OUT_MEMORY)
+	memset(i_data, 0, get_class_size(i_classIndex));
+#endif
+
+	if (slab->used_slots == slab->slot_count)
+		insert_partial_slab(sizeClass, slab);
+
+	set_next_free_slot(header, slab->free_slot);
+	slab->free_slot = header;
+	slab->used_slots--;
+
+	alloc_region_t::p_used_bytes -= get_slot_size(i_classIndex);
+	sizeClass.live_slots--;
+	sizeClass.free_count++;
+
+	// keep the last partial slab of the class, so a class going back and forth around a slab boundary
+	// does not acquire and release it every time
+	if (slab->used_slots == 0 && (sizeClass.partial_slabs != slab || slab->next_slab != nullptr))
+		release_slab(slab);
+}
+
+template <class t_tracking, class t_locking>
+void slab_scheme<t_tracking, t_locking>::free_all()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	detail::unregister_live_allocations<t_tracking>((alloc_region_t&)*this);
+	alloc_region_t::p_last_alloc = nullptr;
+	alloc_region_t::p_used_bytes = 0;
+#if defined(ZERO_OUT_MEMORY)
+	memset(m_first_slab, 0, m_next_fresh_slab - m_first_slab);
+#endif
+	reset_slabs();
+}
+
+template <class t_tracking, class t_locking>
+const size slab_scheme<t_tracking, t_locking>::trim()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	// free slabs keep their header, it links them
+	size releasedBytes = 0;
+	for (slab_header* slab = m_free_slabs; slab; slab = slab->next_slab)
+	{
+		releasedBytes += detail::purge_range((alloc_region_t&)*this, (p8)slab + sizeof(slab_header), (p8)slab + k_slab_size);
+	}
+	releasedBytes += detail::purge_range((alloc_region_t&)*this, m_next_fresh_slab, m_end_slab);
+	return releasedBytes;
+}
+
+template <class t_tracking, class t_locking>
+const typename slab_scheme<t_tracking, t_locking>::class_stats slab_scheme<t_tracking, t_locking>::get_class_stats(const u32 i_classIndex)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	const size_class& sizeClass = m_classes[i_classIndex];
+	class_stats stats;
+	stats.class_size = get_class_size(i_classIndex);
+	stats.slot_size = get_slot_size(i_classIndex);
+	stats.slab_count = sizeClass.slab_count;
+	stats.live_slots = sizeClass.live_slots;
+	stats.alloc_count = sizeClass.alloc_count;
+	stats.free_count = sizeClass.free_count;
+	return stats;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Buddy Allocation Scheme
+
+template <class t_tracking, class t_locking>
+buddy_scheme<t_tracking, t_locking>::buddy_scheme()
+	: alloc_region_t()
+	, m_headers(nullptr)
+	, m_block_orders(nullptr)
+	, m_free_order_mask(0)
+	, m_first_block(nullptr)
+	, m_block_count(0)
+{
+	memset(m_free_bitmaps, 0, sizeof(m_free_bitmaps));
+	memset(m_free_lists, 0, sizeof(m_free_lists));
+	memset(m_free_counts, 0, sizeof(m_free_counts));
+}
+
+template <class t_tracking, class t_locking>
+buddy_scheme<t_tracking, t_locking>::~buddy_scheme()
+{
+
+}
+
+template <class t_tracking, class t_locking>
+const u32 buddy_scheme<t_tracking, t_locking>::get_order(const size i_bytes)
+{
+	const size blockCount = (i_bytes + k_min_block_size - 1) / k_min_block_size;
+	return (blockCount <= 1) ? 0 : bit_scan_reverse(blockCount - 1) + 1;
+}
+
+template <class t_tracking, class t_locking>
+void buddy_scheme<t_tracking, t_locking>::map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	alloc_region_t::p_base_address = (p8)i_baseAddress;
+	alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+
+	// the table is sized for every block the whole region could hold, the blocks left after it are fewer
+	const size maxBlockCount = i_sizeInBytes / k_min_block_size;
+	size bitmapWords = 0;
+	for (u32 i = 0; i < k_order_count; i++)
+		bitmapWords += ((maxBlockCount >> i) + 63) / 64;
+
+	p8 endAddress = (p8)i_baseAddress + i_sizeInBytes;
+	m_free_bitmaps[0] = (u64*)align_address(i_baseAddress, sizeof(u64));
+	for (u32 i = 1; i < k_order_count; i++)
+		m_free_bitmaps[i] = m_free_bitmaps[i - 1] + ((maxBlockCount >> (i - 1)) + 63) / 64;
+	m_headers = (p8)align_address(m_free_bitmaps[0] + bitmapWords, max_alignment(alignof(alloc_header_t), sizeof(u64)));
+	m_block_orders = (u8*)(m_headers + maxBlockCount * k_header_stride);
+	m_first_block = (p8)align_address(m_block_orders + maxBlockCount, k_min_block_size);
+	FLORAL_ASSERT_MSG(m_first_block + k_min_block_size <= endAddress, "Region is too small for buddy_scheme, it needs at least one block after its table");
+	m_block_count = (size)(endAddress - m_first_block) / k_min_block_size;
+
+	reset_blocks();
+}
+
+// the region is covered by the largest blocks which fit, from the front, so every block is aligned to
+// its own size relative to m_first_block
+template <class t_tracking, class t_locking>
+void buddy_scheme<t_tracking, t_locking>::reset_blocks()
+{
+	memset(m_free_bitmaps[0], 0, (p8)m_headers - (p8)m_free_bitmaps[0]);
+	memset(m_block_orders, k_no_order, m_block_count);
+	memset(m_free_lists, 0, sizeof(m_free_lists));
+	memset(m_free_counts, 0, sizeof(m_free_counts));
+	m_free_order_mask = 0;
+
+	size blockIndex = 0;
+	for (s32 order = (s32)k_max_order; order >= 0; order--)
+	{
+		const size orderBlocks = (size)1 << order;
+		while (blockIndex + orderBlocks <= m_block_count)
+		{
+			push_free_block((u32)order, blockIndex);
+			blockIndex += orderBlocks;
+		}
+	}
+}
+
+template <class t_tracking, class t_locking>
+const bool buddy_scheme<t_tracking, t_locking>::is_free(const u32 i_order, const size i_blockIndex) const
+{
+	const size bit = i_blockIndex >> i_order;
+	return (m_free_bitmaps[i_order][bit >> 6] & ((u64)1 << (bit & 63))) != 0;
+}
+
+template <class t_tracking, class t_locking>
+void buddy_scheme<t_tracking, t_locking>::push_free_block(const u32 i_order, const size i_blockIndex)
+{
+	free_block* block = (free_block*)get_block(i_blockIndex);
+	block->prev_block = nullptr;
+	block->next_block = m_free_lists[i_order];
+	if (block->next_block)
+		block->next_block->prev_block = block;
+	m_free_lists[i_order] = block;
+	m_free_counts[i_order]++;
+	m_free_order_mask |= (1u << i_order);
+
+	const size bit = i_blockIndex >> i_order;
+	m_free_bitmaps[i_order][bit >> 6] |= ((u64)1 << (bit & 63));
+}
+
+template <class t_tracking, class t_locking>
+void buddy_scheme<t_tracking, t_locking>::remove_free_block(const u32 i_order, const size i_blockIndex)
+{
+	free_block* block = (free_block*)get_block(i_blockIndex);
+	if (block->prev_block)
+		block->prev_block->next_block = block->next_block;
+	else
+		m_free_lists[i_order] = block->next_block;
+	if (block->next_block)
+		block->next_block->prev_block = block->prev_block;
+	m_free_counts[i_order]--;
+	if (m_free_lists[i_order] == nullptr)
+		m_free_order_mask &= ~(1u << i_order);
+
+	const size bit = i_blockIndex >> i_order;
+	m_free_bitmaps[i_order][bit >> 6] &= ~((u64)1 << (bit & 63));
+}
+
+template <class t_tracking, class t_locking>
+voidptr buddy_scheme<t_tracking, t_locking>::allocate(const size i_bytes, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(i_bytes <= k_max_block_size, "buddy_scheme cannot serve blocks larger than k_max_block_size");
+	if (i_bytes > k_max_block_size)
+		return nullptr;
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_block(get_order(i_bytes), i_bytes, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr buddy_scheme<t_tracking, t_locking>::allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc /* = nullptr */)
+{
+	FLORAL_ASSERT_MSG(is_power_of_two(i_alignment), "Alignment must be a power of two");
+	// blocks are only aligned to their size relative to the first block
+	if (((aptr)m_first_block & (i_alignment - 1)) != 0)
+		return nullptr;
+	const size bytes = i_bytes > i_alignment ? i_bytes : i_alignment;
+	FLORAL_ASSERT_MSG(bytes <= k_max_block_size, "buddy_scheme cannot serve blocks larger than k_max_block_size");
+	if (bytes > k_max_block_size)
+		return nullptr;
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return allocate_block(get_order(bytes), i_bytes, i_desc);
+}
+
+template <class t_tracking, class t_locking>
+voidptr buddy_scheme<t_tracking, t_locking>::allocate_block(const u32 i_order, const size i_bytes, const_cstr i_desc)
+{
+	// smallest order with a free block
+	const u32 candidateOrders = m_free_order_mask & ~((1u << i_order) - 1);
+	if (candidateOrders == 0)
+	{
+		// out of memory
+		return nullptr;
+	}
+
+	u32 order = bit_scan_forward(candidateOrders);
+	const size blockIndex = (size)((p8)m_free_lists[order] - m_first_block) / k_min_block_size;
+	remove_free_block(order, blockIndex);
+
+	// the upper halves go back to the free lists
+	while (order > i_order)
+	{
+		order--;
+		push_free_block(order, blockIndex + ((size)1 << order));
+	}
+
+	const size blockSize = get_block_size(i_order);
+	p8 dataAddr = get_block(blockIndex);
+	alloc_header_t* header = get_header(blockIndex);
+	m_block_orders[blockIndex] = (u8)i_order;
+
+	// the header is in the table in front of the blocks, the adjustment wraps around so that
+	// 'header - adjustment' is still the frame address
+	detail::set_frame_info(header, blockSize, (size)((aptr)header - (aptr)dataAddr));
+	detail::link_allocation((alloc_region_t&)*this, header, i_desc);
+	t_tracking::register_allocation(header, i_bytes, i_desc ? i_desc : "no-desc", __FILE__, __LINE__);
+
+	alloc_region_t::p_used_bytes += blockSize;
+	return dataAddr;
+}
+
+template <class t_tracking, class t_locking>
+voidptr buddy_scheme<t_tracking, t_locking>::reallocate(voidptr i_data, const size i_newBytes)
+{
+	FLORAL_ASSERT_MSG(i_newBytes <= k_max_block_size, "buddy_scheme cannot serve blocks larger than k_max_block_size");
+	if (i_newBytes > k_max_block_size)
+		return nullptr;
+
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	const u32 newOrder = get_order(i_newBytes);
+	if (i_data == nullptr)
+		return allocate_block(newOrder, i_newBytes, nullptr);
+
+	const size blockIndex = (size)((p8)i_data - m_first_block) / k_min_block_size;
+	const u32 oldOrder = m_block_orders[blockIndex];
+	if (newOrder == oldOrder)
+	{
+		t_tracking::resize_allocation(get_header(blockIndex), i_newBytes);
+		return i_data;
+	}
+
+	voidptr newAllocation = allocate_block(newOrder, i_newBytes, nullptr);
+	if (newAllocation != nullptr)
+	{
+		const size oldBytes = get_block_size(oldOrder);
+		memcpy(newAllocation, i_data, i_newBytes < oldBytes ? i_newBytes : oldBytes);
+		free_block_at(i_data);
+	}
+	return newAllocation;
+}
+
+template <class t_tracking, class t_locking>
+void buddy_scheme<t_tracking, t_locking>::free(voidptr i_data)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	free_block_at(i_data);
+}
+
+template <class t_tracking, class t_locking>
+void buddy_scheme<t_tracking, t_locking>::free_block_at(voidptr i_data)
+{
+	FLORAL_ASSERT_MSG((p8)i_data >= m_first_block && ((aptr)((p8)i_data - m_first_block) & (k_min_block_size - 1)) == 0,
+			"Invalid free: not a buddy_scheme block");
+	size blockIndex = (size)((p8)i_data - m_first_block) / k_min_block_size;
+	FLORAL_ASSERT_MSG(blockIndex < m_block_count && m_block_orders[blockIndex] != k_no_order, "Invalid free: the block is not allocated");
+
+	u32 order = m_block_orders[blockIndex];
+	alloc_header_t* header = get_header(blockIndex);
+	t_tracking::unregister_allocation(header);
+	detail::unlink_allocation((alloc_region_t&)*this, header);
+	m_block_orders[blockIndex] = k_no_order;
+	alloc_region_t::p_used_bytes -= get_block_size(order);
+
+#if defined(ZERO_OUT_MEMORY)
+	memset(i_data, 0, get_block_size(order));
+#endif
+
+	// merge upwards while the buddy is free and whole, the tail of the region may have no buddy at all
+	while (order < k_max_order)
+	{
+		const size buddyIndex = blockIndex ^ ((size)1 << order);
+		if (buddyIndex + ((size)1 << order) > m_block_count || !is_free(order, buddyIndex))
+			break;
+		remove_free_block(order, buddyIndex);
+		blockIndex = blockIndex < buddyIndex ? blockIndex : buddyIndex;
+		order++;
+	}
+	push_free_block(order, blockIndex);
+}
+
+template <class t_tracking, class t_locking>
+void buddy_scheme<t_tracking, t_locking>::free_all()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	detail::unregister_live_allocations<t_tracking>((alloc_region_t&)*this);
+	alloc_region_t::p_last_alloc = nullptr;
+	alloc_region_t::p_used_bytes = 0;
+#if defined(ZERO_OUT_MEMORY)
+	memset(m_first_block, 0, m_block_count * k_min_block_size);
+#endif
+	reset_blocks();
+}
+
+template <class t_tracking, class t_locking>
+const size buddy_scheme<t_tracking, t_locking>::trim()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	size releasedBytes = 0;
+	for (u32 i = 0; i < k_order_count; i++)
+	{
+		for (free_block* block = m_free_lists[i]; block; block = block->next_block)
+		{
+			releasedBytes += detail::purge_range((alloc_region_t&)*this, (p8)block + sizeof(free_block), (p8)block + get_block_size(i));
+		}
+	}
+	return releasedBytes;
+}
+
+template <class t_tracking, class t_locking>
+const u32 buddy_scheme<t_tracking, t_locking>::get_free_block_count(const u32 i_order)
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return m_free_counts[i_order];
+}
+
+template <class t_tracking, class t_locking>
+const size buddy_scheme<t_tracking, t_locking>::get_largest_free_block()
+{
+	lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+	return m_free_order_mask ? get_block_size(bit_scan_reverse(m_free_order_mask)) : 0;
 }
 
 // ----------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "tracking_policies.h"
+#include "locking_policies.h"
 
 #include <floral/stdaliases.h>
 #include <new>
@@ -14,12 +15,13 @@ namespace helich
 // we must use: template<typename> class Foo
 // instead of: template<typename> typename Foo
 // however, since C++17 (and VS2015) we can use them interchangeable in this case
-template <template<typename> class t_alloc_scheme, class t_tracking_policy = default_tracking_policy>
+template <template<typename, typename> class t_alloc_scheme, class t_tracking_policy = default_tracking_policy,
+		 class t_locking_policy = mutex_locking_policy>
 class allocator :
-	public t_alloc_scheme<t_tracking_policy>
+	public t_alloc_scheme<t_tracking_policy, t_locking_policy>
 {
 public:
-	typedef t_alloc_scheme<t_tracking_policy>         alloc_scheme_t;
+	typedef t_alloc_scheme<t_tracking_policy, t_locking_policy>	alloc_scheme_t;
 
 public:
 	allocator();
@@ -28,12 +30,12 @@ public:
 	template <class t_object_type>
 	static const size get_real_data_size()
 	{
-		return t_alloc_scheme<t_tracking_policy>::get_real_data_size(sizeof(t_object_type));
+		return alloc_scheme_t::get_real_data_size(sizeof(t_object_type));
 	}
 
 	static const size get_real_data_size(const size i_rawDataSize)
 	{
-		return t_alloc_scheme<t_tracking_policy>::get_real_data_size(i_rawDataSize);
+		return alloc_scheme_t::get_real_data_size(i_rawDataSize);
 	}
 
 	template <class t_object_type>
@@ -45,7 +47,7 @@ public:
 	template <class t_object_type, class t_closure_allocator, class ... t_params>
 	t_object_type* allocate_closure(const size i_bytes, t_params... i_params)
 	{
-		voidptr addr = t_alloc_scheme<t_tracking_policy>::allocate(i_bytes + sizeof(t_object_type) + HL_ALIGNMENT);
+		voidptr addr = alloc_scheme_t::allocate(i_bytes + sizeof(t_object_type) + HL_ALIGNMENT);
 		t_object_type* obj = new (addr) t_object_type(i_params...);
 		voidptr baseClsAddress = align_address((s8*)addr + sizeof(t_object_type));
 		((t_closure_allocator*)obj)->map_tp(baseClsAddress, i_bytes, "");
@@ -55,8 +57,8 @@ public:
 	template <class t_closure_allocator>
 	t_closure_allocator* allocate_arena(const_cstr i_desc = nullptr)
 	{
-		size bytes = t_alloc_scheme<t_tracking_policy>::get_remain_bytes() - sizeof(t_closure_allocator) - HL_ALIGNMENT;
-		voidptr addr = t_alloc_scheme<t_tracking_policy>::allocate(bytes + sizeof(t_closure_allocator) + HL_ALIGNMENT, i_desc);
+		size bytes = alloc_scheme_t::get_remain_bytes() - sizeof(t_closure_allocator) - HL_ALIGNMENT;
+		voidptr addr = alloc_scheme_t::allocate(bytes + sizeof(t_closure_allocator) + HL_ALIGNMENT, i_desc);
 		t_closure_allocator* cls = new (addr) t_closure_allocator();
 		voidptr baseClsAddress = align_address((s8*)addr + sizeof(t_closure_allocator));
 		cls->map_to(baseClsAddress, bytes, "arena");
@@ -66,7 +68,7 @@ public:
 	template <class t_closure_allocator>
 	t_closure_allocator* allocate_arena(const size i_bytes, const_cstr i_desc = nullptr)
 	{
-		voidptr addr = t_alloc_scheme<t_tracking_policy>::allocate(i_bytes + sizeof(t_closure_allocator) + HL_ALIGNMENT, i_desc);
+		voidptr addr = alloc_scheme_t::allocate(i_bytes + sizeof(t_closure_allocator) + HL_ALIGNMENT, i_desc);
 		t_closure_allocator* cls = new (addr) t_closure_allocator();
 		voidptr baseClsAddress = align_address((s8*)addr + sizeof(t_closure_allocator));
 		cls->map_to(baseClsAddress, i_bytes, "arena");
@@ -75,27 +77,28 @@ public:
 
 	voidptr allocate(const size i_bytes, const_cstr i_desc = nullptr)
 	{
-		return t_alloc_scheme<t_tracking_policy>::allocate(i_bytes, i_desc);
+		return alloc_scheme_t::allocate(i_bytes, i_desc);
 	}
 
+	// typed allocations respect alignof(t_object_type)
 	template <class t_object_type, class ... t_params>
 	t_object_type* allocate(t_params... i_params)
 	{
-		voidptr addr = t_alloc_scheme<t_tracking_policy>::allocate(sizeof(t_object_type));
+		voidptr addr = alloc_scheme_t::allocate_aligned(sizeof(t_object_type), alignof(t_object_type));
 		return new (addr) t_object_type(i_params...);
 	}
 
 	template <class t_object_type, class ... t_params>
 	t_object_type* allocate_with_description(const_cstr i_desc, t_params... i_params)
 	{
-		voidptr addr = t_alloc_scheme<t_tracking_policy>::allocate(sizeof(t_object_type), i_desc);
+		voidptr addr = alloc_scheme_t::allocate_aligned(sizeof(t_object_type), alignof(t_object_type), i_desc);
 		return new (addr) t_object_type(i_params...);
 	}
 
 	template <class t_object_type>
 	t_object_type* allocate_array(const size i_elemCount, const_cstr i_desc = nullptr)
 	{
-		voidptr addr = t_alloc_scheme<t_tracking_policy>::allocate(sizeof(t_object_type) * i_elemCount, i_desc);
+		voidptr addr = alloc_scheme_t::allocate_aligned(sizeof(t_object_type) * i_elemCount, alignof(t_object_type), i_desc);
 		//return new (addr) t_object_type[i_elemCount];
 		aptr elemPtr = (aptr)addr;
 		for (size i = 0; i < i_elemCount; i++)
@@ -109,36 +112,67 @@ public:
 	template <class t_object_type>
 	t_object_type* allocate_podarray(const size i_elemCount, const_cstr i_desc = nullptr)
 	{
-		return (t_object_type*)allocate(sizeof(t_object_type) * i_elemCount, i_desc);
+		return (t_object_type*)alloc_scheme_t::allocate_aligned(sizeof(t_object_type) * i_elemCount, alignof(t_object_type), i_desc);
 	}
 
 	voidptr reallocate(void* i_ptr, const size i_newBytes)
 	{
-		return t_alloc_scheme<t_tracking_policy>::reallocate(i_ptr, i_newBytes);
+		return alloc_scheme_t::reallocate(i_ptr, i_newBytes);
+	}
+
+	// one lock and one tracking batch for the whole batch, only for schemes with bulk support (freelist)
+	const u32 allocate_bulk(const u32 i_count, const size i_bytes, voidptr* o_ptrs, const_cstr i_desc = nullptr)
+	{
+		return alloc_scheme_t::allocate_bulk(i_count, i_bytes, o_ptrs, i_desc);
+	}
+
+	// default-constructed objects, returns how many were allocated
+	template <class t_object_type>
+	const u32 allocate_bulk(const u32 i_count, t_object_type** o_objects, const_cstr i_desc = nullptr)
+	{
+		static_assert(alignof(t_object_type) <= alloc_scheme_t::k_granularity, "Bulk allocations are not aligned enough for this type");
+		const u32 allocated = alloc_scheme_t::allocate_bulk(i_count, sizeof(t_object_type), (voidptr*)o_objects, i_desc);
+		for (u32 i = 0; i < allocated; i++)
+			new (o_objects[i]) t_object_type();
+		return allocated;
+	}
+
+	void free_bulk(voidptr* i_ptrs, const u32 i_count)
+	{
+		alloc_scheme_t::free_bulk(i_ptrs, i_count);
+	}
+
+	template <class t_object_type>
+	void free_bulk(t_object_type** i_objects, const u32 i_count)
+	{
+		for (u32 i = 0; i < i_count; i++)
+			i_objects[i]->~t_object_type();
+		alloc_scheme_t::free_bulk((voidptr*)i_objects, i_count);
 	}
 
 	template <class t_object_type>
 	void free(t_object_type* i_objPtr)
 	{
 		i_objPtr->~t_object_type();
-		t_alloc_scheme<t_tracking_policy>::free(i_objPtr);
+		alloc_scheme_t::free(i_objPtr);
 	}
 
 	template <>
 	void free(void* i_objPtr)
 	{
-		t_alloc_scheme<t_tracking_policy>::free(i_objPtr);
+		alloc_scheme_t::free(i_objPtr);
 	}
 };
 
 //////////////////////////////////////////////////////////////////////////
 
-template <template<size, typename> class t_alloc_scheme, size t_elem_size, class t_tracking_policy = default_tracking_policy>
+template <template<size, typename, typename> class t_alloc_scheme, size t_elem_size, class t_tracking_policy = default_tracking_policy,
+		 class t_locking_policy = mutex_locking_policy>
 class fixed_allocator :
-	public t_alloc_scheme<t_elem_size, t_tracking_policy>
+	public t_alloc_scheme<t_elem_size, t_tracking_policy, t_locking_policy>
 {
 public:
-	typedef t_alloc_scheme<t_elem_size, t_tracking_policy>  alloc_scheme_t;
+	typedef t_alloc_scheme<t_elem_size, t_tracking_policy, t_locking_policy>	alloc_scheme_t;
 
 public:
 	fixed_allocator()
@@ -149,21 +183,60 @@ public:
 	template <class t_object_type, class ... t_params>
 	t_object_type* allocate(t_params... i_params)
 	{
-		voidptr addr = t_alloc_scheme<t_elem_size, t_tracking_policy>::allocate();
+		static_assert(alignof(t_object_type) <= alloc_scheme_t::k_slot_alignment, "Pool slots are not aligned enough for this type");
+		voidptr addr = alloc_scheme_t::allocate();
+		if (addr == nullptr)
+			return nullptr;
 		return new (addr) t_object_type(i_params...);
 	}
 
+	const u32 allocate_bulk(const u32 i_count, voidptr* o_ptrs, const_cstr i_desc = nullptr)
+	{
+		return alloc_scheme_t::allocate_bulk(i_count, o_ptrs, i_desc);
+	}
+
+	// default-constructed objects, returns how many were allocated
+	template <class t_object_type>
+	const u32 allocate_bulk(const u32 i_count, t_object_type** o_objects, const_cstr i_desc = nullptr)
+	{
+		static_assert(alignof(t_object_type) <= alloc_scheme_t::k_slot_alignment, "Pool slots are not aligned enough for this type");
+		const u32 allocated = alloc_scheme_t::allocate_bulk(i_count, (voidptr*)o_objects, i_desc);
+		for (u32 i = 0; i < allocated; i++)
+			new (o_objects[i]) t_object_type();
+		return allocated;
+	}
+
+	void free_bulk(voidptr* i_ptrs, const u32 i_count)
+	{
+		alloc_scheme_t::free_bulk(i_ptrs, i_count);
+	}
+
+	template <class t_object_type>
+	void free_bulk(t_object_type** i_objects, const u32 i_count)
+	{
+		for (u32 i = 0; i < i_count; i++)
+			i_objects[i]->~t_object_type();
+		alloc_scheme_t::free_bulk((voidptr*)i_objects, i_count);
+	}
+
 	template <class t_object_type>
 	void free(t_object_type* i_objPtr)
 	{
 		i_objPtr->~t_object_type();
-		t_alloc_scheme<t_elem_size, t_tracking_policy>::free(i_objPtr);
+		alloc_scheme_t::free(i_objPtr);
 	}
 
 	template <>
 	void free(void* i_objPtr)
 	{
-		t_alloc_scheme<t_elem_size, t_tracking_policy>::free(i_objPtr);
+		alloc_scheme_t::free(i_objPtr);
+	}
+
+	// typed walk over the live slots, only for schemes which can enumerate them (bitmap_pool_scheme)
+	template <class t_object_type, class t_functor>
+	void for_each_live(t_functor i_fn)
+	{
+		alloc_scheme_t::for_each_live([&i_fn](voidptr i_slot) { i_fn((t_object_type*)i_slot); });
 	}
 };
 
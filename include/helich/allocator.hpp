@@ -4,14 +4,14 @@ namespace helich
 {
 // ----------------------------------------------------------------------------
 
-template <template<typename> class t_alloc_scheme, class t_tracking>
-allocator<t_alloc_scheme, t_tracking>::allocator()
+template <template<typename, typename> class t_alloc_scheme, class t_tracking, class t_locking>
+allocator<t_alloc_scheme, t_tracking, t_locking>::allocator()
 {
 
 }
 
-template <template<typename> class t_alloc_scheme, class t_tracking>
-allocator<t_alloc_scheme, t_tracking>::~allocator()
+template <template<typename, typename> class t_alloc_scheme, class t_tracking, class t_locking>
+allocator<t_alloc_scheme, t_tracking, t_locking>::~allocator()
 {
 
 }
@@ -0,0 +1,464 @@
+#pragma once
+
+#include "helich/detail/alloc_region.h"
+#include "helich/locking_policies.h"
+#include "helich/utils.h"
+
+#include <floral/stdaliases.h>
+#include <floral/assert/assert.h>
+
+#include <chrono>
+#include <string.h>
+
+namespace helich
+{
+// ----------------------------------------------------------------------------
+
+// variable-size heap for long running processes: blocks are referenced by 32-bit handles (slot index +
+// generation, like handle_pool) so defrag() can slide live blocks down over the free space in front of them,
+// a little at a time, until all the free space is one block at the top of the region.
+// - resolve() returns the current address of a block, good until the next defrag()
+// - pin() / unpin() keep a block in place while raw pointers to it are in use, pinned blocks are skipped
+// NOTE: blocks are moved with memmove, do not keep pointers into a block inside itself or elsewhere
+// eg.
+//	defrag_heap<4096> g_assets;
+//	memory_region<defrag_heap<4096>> { "assets", SIZE_MB(64), &g_assets }
+//	defrag_heap<4096>::handle_t h = g_assets.allocate(meshBytes);
+//	...
+//	g_assets.defrag(0.5f);		// once per frame, at most half a millisecond
+template <u32 t_max_handles = 4096, class t_locking_policy = mutex_locking_policy>
+class defrag_heap :
+	private detail::alloc_region<compact_fixed_size_alloc_header<untracked_alloc_header>, t_locking_policy>
+{
+public:
+	typedef u32									handle_t;
+	typedef defrag_heap							alloc_scheme_t;
+	typedef detail::alloc_region<compact_fixed_size_alloc_header<untracked_alloc_header>, t_locking_policy>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t	lock_guard_t;
+
+	static const u32							k_index_bits = 20;
+	static const u32							k_generation_bits = 32 - k_index_bits;
+	static const handle_t						k_null_handle = 0;						// generation 0 is never handed out
+	static const size							k_alignment = 16;
+
+	static_assert(t_max_handles >= 1 && t_max_handles <= (1u << k_index_bits), "Invalid number of handles");
+
+	// what a defrag() call did
+	struct defrag_result
+	{
+		u32										moved_blocks;
+		size									moved_bytes;
+		size									largest_free_before;
+		size									largest_free_after;		// the contiguous free space recovered is after - before
+		bool									compacted;				// a whole pass found nothing left to move
+	};
+
+public:
+	defrag_heap()
+		: m_handles(nullptr)
+		, m_first_block(nullptr)
+		, m_end_block(nullptr)
+		, m_free_blocks(nullptr)
+		, m_defrag_cursor(nullptr)
+		, m_next_free_handle(k_no_handle)
+		, m_live_count(0)
+		, m_pass_moves(0)
+	{}
+
+	~defrag_heap()
+	{}
+
+	void map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		alloc_region_t::p_base_address = (p8)i_baseAddress;
+		alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+
+		// handle table first, then the blocks
+		m_handles = (handle_entry*)align_address(i_baseAddress, alignof(handle_entry));
+		m_first_block = (p8)align_address(m_handles + t_max_handles, k_alignment);
+		m_end_block = (p8)((aptr)((p8)i_baseAddress + i_sizeInBytes) & ~(aptr)(k_alignment - 1));
+		FLORAL_ASSERT_MSG(m_first_block + k_min_block_size <= m_end_block, "Region is too small for defrag_heap");
+
+		// every handle starts at generation 1, so a zeroed handle never resolves
+		for (u32 i = 0; i < t_max_handles; i++)
+			m_handles[i].generation = 1;
+		reset_blocks();
+	}
+
+	// k_null_handle when there is no free block big enough, defrag() may make room
+	handle_t allocate(const size i_bytes)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		if (m_next_free_handle == k_no_handle)
+			return k_null_handle;
+
+		const size blockSize = get_block_size(i_bytes);
+		block_header* block = find_free_block(blockSize);
+		if (block == nullptr)
+		{
+			// out of memory
+			return k_null_handle;
+		}
+
+		remove_free_block(block);
+		split_block(block, blockSize);
+
+		const u32 handleIndex = m_next_free_handle;
+		handle_entry& entry = m_handles[handleIndex];
+		m_next_free_handle = entry.next_free;
+		entry.block = block;
+		entry.pin_count = 0;
+		block->handle_index = handleIndex;
+
+		m_live_count++;
+		alloc_region_t::p_used_bytes += block->block_size;
+		return make_handle(handleIndex, entry.generation);
+	}
+
+	// freeing a stale handle is a no-op
+	void free(const handle_t i_handle)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		if (!is_live(i_handle))
+			return;
+
+		const u32 handleIndex = get_index(i_handle);
+		handle_entry& entry = m_handles[handleIndex];
+		FLORAL_ASSERT_MSG(entry.pin_count == 0, "Freeing a pinned block");
+
+		block_header* block = entry.block;
+		alloc_region_t::p_used_bytes -= block->block_size;
+		m_live_count--;
+		release_handle(handleIndex);
+		release_block(block);
+	}
+
+	// current address of the block, nullptr for a stale handle. Only good until the next defrag()
+	voidptr resolve(const handle_t i_handle)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		return is_live(i_handle) ? get_data(m_handles[get_index(i_handle)].block) : nullptr;
+	}
+
+	// the block stays at the returned address until the matching unpin(), pins nest
+	voidptr pin(const handle_t i_handle)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		if (!is_live(i_handle))
+			return nullptr;
+		handle_entry& entry = m_handles[get_index(i_handle)];
+		entry.pin_count++;
+		return get_data(entry.block);
+	}
+
+	void unpin(const handle_t i_handle)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		if (!is_live(i_handle))
+			return;
+		handle_entry& entry = m_handles[get_index(i_handle)];
+		FLORAL_ASSERT_MSG(entry.pin_count > 0, "Unpinning a block which is not pinned");
+		entry.pin_count--;
+	}
+
+	const bool is_valid(const handle_t i_handle)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		return is_live(i_handle);
+	}
+
+	// slides unpinned live blocks down over the free block in front of them, one block at a time, until
+	// i_timeBudgetMs is spent or a whole pass over the region had nothing to move. The next call resumes
+	// where this one stopped
+	defrag_result defrag(const f32 i_timeBudgetMs)
+	{
+		typedef std::chrono::steady_clock clock_t;
+		const clock_t::time_point deadline = clock_t::now()
+			+ std::chrono::duration_cast<clock_t::duration>(std::chrono::duration<f32, std::milli>(i_timeBudgetMs));
+
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		defrag_result result;
+		result.moved_blocks = 0;
+		result.moved_bytes = 0;
+		result.largest_free_before = find_largest_free_block();
+		result.compacted = false;
+
+		do
+		{
+			// next free block from the cursor
+			block_header* freeBlock = m_defrag_cursor;
+			while ((p8)freeBlock < m_end_block && !is_free(freeBlock))
+				freeBlock = get_next_phys_block(freeBlock);
+
+			block_header* liveBlock = ((p8)freeBlock < m_end_block) ? get_next_phys_block(freeBlock) : nullptr;
+			if (liveBlock == nullptr || (p8)liveBlock >= m_end_block)
+			{
+				// end of a pass: only the top free block is left, or everything in between is pinned
+				m_defrag_cursor = (block_header*)m_first_block;
+				if (m_pass_moves == 0)
+				{
+					result.compacted = true;
+					break;
+				}
+				m_pass_moves = 0;
+				continue;
+			}
+
+			// free blocks are always coalesced, the next one is live
+			if (m_handles[liveBlock->handle_index].pin_count > 0)
+			{
+				m_defrag_cursor = get_next_phys_block(liveBlock);
+				continue;
+			}
+
+			result.moved_bytes += liveBlock->block_size;
+			result.moved_blocks++;
+			m_defrag_cursor = slide_down(freeBlock, liveBlock);
+			m_pass_moves++;
+		}
+		while (clock_t::now() < deadline);
+
+		result.largest_free_after = find_largest_free_block();
+		return result;
+	}
+
+	// every handle becomes stale
+	void free_all()
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		for (u32 i = 0; i < t_max_handles; i++)
+		{
+			if (m_handles[i].block != nullptr)
+				bump_generation(m_handles[i]);
+		}
+		alloc_region_t::p_used_bytes = 0;
+		reset_blocks();
+	}
+
+	// give the pages inside free blocks back to the OS, the block headers and free-list links stay intact
+	const size trim()
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		size releasedBytes = 0;
+		for (block_header* block = m_free_blocks; block; block = block->next_free)
+		{
+			releasedBytes += detail::purge_range((alloc_region_t&)*this, (p8)block + sizeof(block_header), (p8)block + block->block_size);
+		}
+		return releasedBytes;
+	}
+
+	const size get_largest_free_block()
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		return find_largest_free_block();
+	}
+
+	static const u32							get_index(const handle_t i_handle)				{ return i_handle & ((1u << k_index_bits) - 1); }
+	static const u32							get_generation(const handle_t i_handle)			{ return i_handle >> k_index_bits; }
+
+private:
+	// free blocks are linked through the rest of their header
+	struct block_header
+	{
+		block_header*							prev_phys_block;
+		size									block_size;				// with the header
+		u32										handle_index;			// k_no_handle while the block is free
+		block_header*							next_free;
+		block_header*							prev_free;
+	};
+
+	struct handle_entry
+	{
+		block_header*							block;					// nullptr while the handle is free
+		u32										generation;
+		u32										pin_count;
+		u32										next_free;
+	};
+
+	static const u32							k_no_handle = 0xffffffffu;
+	static const size							k_header_size = align_size(sizeof(block_header) - 2 * sizeof(block_header*), k_alignment);
+	static const size							k_min_block_size = align_size(sizeof(block_header), k_alignment);
+
+	static const handle_t						make_handle(const u32 i_index, const u32 i_generation)	{ return (i_generation << k_index_bits) | i_index; }
+	static inline const size					get_block_size(const size i_bytes)
+	{
+		const size blockSize = align_size(k_header_size + i_bytes, k_alignment);
+		return blockSize < k_min_block_size ? k_min_block_size : blockSize;
+	}
+	static inline voidptr						get_data(block_header* i_block)					{ return (p8)i_block + k_header_size; }
+	static inline const bool					is_free(block_header* i_block)					{ return i_block->handle_index == k_no_handle; }
+	inline block_header*						get_next_phys_block(block_header* i_block) const	{ return (block_header*)((p8)i_block + i_block->block_size); }
+
+	const bool is_live(const handle_t i_handle) const
+	{
+		const u32 handleIndex = get_index(i_handle);
+		return handleIndex < t_max_handles && m_handles[handleIndex].block != nullptr
+			&& m_handles[handleIndex].generation == get_generation(i_handle);
+	}
+
+	static void bump_generation(handle_entry& io_entry)
+	{
+		io_entry.generation = (io_entry.generation + 1) & ((1u << k_generation_bits) - 1);
+		if (io_entry.generation == 0)
+			io_entry.generation = 1;
+	}
+
+	void release_handle(const u32 i_handleIndex)
+	{
+		handle_entry& entry = m_handles[i_handleIndex];
+		bump_generation(entry);
+		entry.block = nullptr;
+		entry.next_free = m_next_free_handle;
+		m_next_free_handle = i_handleIndex;
+	}
+
+	// first fit
+	block_header* find_free_block(const size i_blockSize) const
+	{
+		for (block_header* block = m_free_blocks; block; block = block->next_free)
+		{
+			if (block->block_size >= i_blockSize)
+				return block;
+		}
+		return nullptr;
+	}
+
+	const size find_largest_free_block() const
+	{
+		size largestBlock = 0;
+		for (block_header* block = m_free_blocks; block; block = block->next_free)
+		{
+			if (block->block_size > largestBlock)
+				largestBlock = block->block_size;
+		}
+		return largestBlock > k_header_size ? largestBlock - k_header_size : 0;
+	}
+
+	void insert_free_block(block_header* i_block)
+	{
+		i_block->handle_index = k_no_handle;
+		i_block->prev_free = nullptr;
+		i_block->next_free = m_free_blocks;
+		if (m_free_blocks)
+			m_free_blocks->prev_free = i_block;
+		m_free_blocks = i_block;
+	}
+
+	void remove_free_block(block_header* i_block)
+	{
+		if (i_block->prev_free)
+			i_block->prev_free->next_free = i_block->next_free;
+		else
+			m_free_blocks = i_block->next_free;
+		if (i_block->next_free)
+			i_block->next_free->prev_free = i_block->prev_free;
+	}
+
+	// the tail of i_block beyond i_blockSize goes back to the free list, if it is big enough to be a block
+	void split_block(block_header* i_block, const size i_blockSize)
+	{
+		const size remainSize = i_block->block_size - i_blockSize;
+		if (remainSize < k_min_block_size)
+			return;
+
+		block_header* remainBlock = (block_header*)((p8)i_block + i_blockSize);
+		remainBlock->prev_phys_block = i_block;
+		remainBlock->block_size = remainSize;
+		i_block->block_size = i_blockSize;
+
+		block_header* nextBlock = get_next_phys_block(remainBlock);
+		if ((p8)nextBlock < m_end_block)
+			nextBlock->prev_phys_block = remainBlock;
+		insert_free_block(remainBlock);
+	}
+
+	// coalesces i_block with its free neighbours before putting it in the free list
+	void release_block(block_header* i_block)
+	{
+		block_header* nextBlock = get_next_phys_block(i_block);
+		if ((p8)nextBlock < m_end_block && is_free(nextBlock))
+		{
+			remove_free_block(nextBlock);
+			i_block->block_size += nextBlock->block_size;
+		}
+
+		block_header* prevBlock = i_block->prev_phys_block;
+		if (prevBlock && is_free(prevBlock))
+		{
+			remove_free_block(prevBlock);
+			prevBlock->block_size += i_block->block_size;
+			i_block = prevBlock;
+		}
+
+		nextBlock = get_next_phys_block(i_block);
+		if ((p8)nextBlock < m_end_block)
+			nextBlock->prev_phys_block = i_block;
+		if (m_defrag_cursor > i_block && m_defrag_cursor < nextBlock)
+			m_defrag_cursor = i_block;
+		insert_free_block(i_block);
+	}
+
+	// [free][live][next] -> [live][free + next if free], returns the new free block
+	block_header* slide_down(block_header* i_freeBlock, block_header* i_liveBlock)
+	{
+		remove_free_block(i_freeBlock);
+		block_header* prevBlock = i_freeBlock->prev_phys_block;
+		const size freeSize = i_freeBlock->block_size;
+		const size liveSize = i_liveBlock->block_size;
+
+		block_header* movedBlock = i_freeBlock;
+		memmove(movedBlock, i_liveBlock, liveSize);
+		movedBlock->prev_phys_block = prevBlock;
+		m_handles[movedBlock->handle_index].block = movedBlock;
+
+		block_header* freeBlock = (block_header*)((p8)movedBlock + liveSize);
+		freeBlock->prev_phys_block = movedBlock;
+		freeBlock->block_size = freeSize;
+		freeBlock->handle_index = k_no_handle;
+		release_block(freeBlock);
+		return freeBlock;
+	}
+
+	// one free block over the whole region, every handle back in the free list, lowest index first
+	void reset_blocks()
+	{
+		for (u32 i = 0; i < t_max_handles; i++)
+		{
+			m_handles[i].block = nullptr;
+			m_handles[i].pin_count = 0;
+			m_handles[i].next_free = (i + 1 < t_max_handles) ? i + 1 : k_no_handle;
+		}
+		m_next_free_handle = 0;
+
+		block_header* block = (block_header*)m_first_block;
+		block->prev_phys_block = nullptr;
+		block->block_size = (size)(m_end_block - m_first_block);
+		m_free_blocks = nullptr;
+		insert_free_block(block);
+
+		m_defrag_cursor = block;
+		m_live_count = 0;
+		m_pass_moves = 0;
+	}
+
+private:
+	handle_entry*								m_handles;
+	p8											m_first_block;
+	p8											m_end_block;
+	block_header*								m_free_blocks;
+	block_header*								m_defrag_cursor;		// the next defrag() step starts here
+	u32											m_next_free_handle;
+	u32											m_live_count;
+	u32											m_pass_moves;
+
+public:
+	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
+	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
+	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
+	const size									get_remain_bytes() const						{ return (size)(m_end_block - m_first_block) - alloc_region_t::p_used_bytes; }
+	const u32									get_live_count() const							{ return m_live_count; }
+};
+
+// ----------------------------------------------------------------------------
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <floral/stdaliases.h>
+
+#include "helich/alloc_headers.h"
+
+#include <string.h>
+#include <type_traits>
+
+namespace helich
+{
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+// live-allocation list and description bookkeeping, these compile to nothing for headers
+// which do not carry them (see alloc_header_traits)
+
+template <class t_alloc_header>
+inline void set_description(t_alloc_header* i_header, const_cstr i_desc)
+{
+	if (i_desc)
+	{
+		strcpy(i_header->description, i_desc);
+	}
+	else
+	{
+		memset(i_header->description, 0, 64);
+	}
+}
+
+template <class t_alloc_region, class t_alloc_header>
+inline void link_allocation(t_alloc_region& io_region, t_alloc_header* i_header, const_cstr i_desc, std::true_type)
+{
+	i_header->next_alloc = nullptr;
+	i_header->prev_alloc = io_region.p_last_alloc;
+	set_description(i_header, i_desc);
+	if (io_region.p_last_alloc != nullptr)
+	{
+		io_region.p_last_alloc->next_alloc = i_header;
+	}
+	io_region.p_last_alloc = i_header;
+}
+
+template <class t_alloc_region, class t_alloc_header>
+inline void link_allocation(t_alloc_region& io_region, t_alloc_header* i_header, const_cstr i_desc, std::false_type)
+{
+}
+
+template <class t_alloc_region, class t_alloc_header>
+inline void unlink_allocation(t_alloc_region& io_region, t_alloc_header* i_header, std::true_type)
+{
+	if (i_header->next_alloc)
+		i_header->next_alloc->prev_alloc = i_header->prev_alloc;
+	if (i_header->prev_alloc)
+		i_header->prev_alloc->next_alloc = i_header->next_alloc;
+	// are we freeing the last allocation?
+	if (i_header == io_region.p_last_alloc)
+		io_region.p_last_alloc = i_header->prev_alloc;
+}
+
+template <class t_alloc_region, class t_alloc_header>
+inline void unlink_allocation(t_alloc_region& io_region, t_alloc_header* i_header, std::false_type)
+{
+}
+
+template <class t_alloc_region, class t_alloc_header>
+inline void link_allocation(t_alloc_region& io_region, t_alloc_header* i_header, const_cstr i_desc)
+{
+	link_allocation(io_region, i_header, i_desc, std::integral_constant<bool, alloc_header_traits<t_alloc_header>::k_has_live_list>());
+}
+
+template <class t_alloc_region, class t_alloc_header>
+inline void unlink_allocation(t_alloc_region& io_region, t_alloc_header* i_header)
+{
+	unlink_allocation(io_region, i_header, std::integral_constant<bool, alloc_header_traits<t_alloc_header>::k_has_live_list>());
+}
+
+// free_all(): the tracked allocations still on the live list are unregistered before the scheme forgets them,
+// or their debug entries and samples would outlive the memory
+template <class t_tracking, class t_alloc_region>
+inline void unregister_live_allocations(t_alloc_region& io_region, std::true_type)
+{
+	if (t_tracking::k_tracks_allocations)
+	{
+		for (typename t_alloc_region::alloc_header_t* currAlloc = io_region.p_last_alloc; currAlloc; currAlloc = currAlloc->prev_alloc)
+			t_tracking::unregister_allocation(currAlloc);
+	}
+}
+
+template <class t_tracking, class t_alloc_region>
+inline void unregister_live_allocations(t_alloc_region& io_region, std::false_type)
+{
+	// compact headers: the live allocations cannot be found
+	static_assert(!t_tracking::k_tracks_allocations, "free_all() needs the live-allocation list to unregister tracked allocations");
+}
+
+template <class t_tracking, class t_alloc_region>
+inline void unregister_live_allocations(t_alloc_region& io_region)
+{
+	unregister_live_allocations<t_tracking>(io_region,
+		std::integral_constant<bool, alloc_header_traits<typename t_alloc_region::alloc_header_t>::k_has_live_list>());
+}
+
+// fixed-size slots only record their frame in the full layout
+template <class t_tracking_header>
+inline void set_frame_info(fixed_size_alloc_header<t_tracking_header>* i_header, const size i_frameSize, const size i_adjustment)
+{
+	i_header->frame_size = i_frameSize;
+	i_header->adjustment = i_adjustment;
+}
+
+template <class t_tracking_header>
+inline void set_frame_info(compact_fixed_size_alloc_header<t_tracking_header>* i_header, const size i_frameSize, const size i_adjustment)
+{
+}
+
+// empty headers (compact + untracked) take no room in front of the data
+template <class t_alloc_header>
+struct alloc_header_size
+{
+	static const size							value = std::is_empty<t_alloc_header>::value ? 0 : sizeof(t_alloc_header);
+};
+
+// ----------------------------------------------------------------------------
+}
+}
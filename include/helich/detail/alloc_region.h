@@ -2,19 +2,34 @@
 
 #include <floral.h>
 
+#include "helich/macros.h"
 #include "helich/memory_debug.h"
+#include "helich/alloc_headers.h"
+#include "helich/locking_policies.h"
+
+#include <atomic>
 
 namespace helich
 {
+// commits [i_address, i_address + i_bytes) of a reserved range, false when the system is out of memory
+typedef bool (*commit_func_t)(voidptr, const size);
+
+// gives the whole pages inside [i_address, i_address + i_bytes) back to the OS, they stay mapped and read as
+// zeros when touched again. Returns the bytes released (both defined in memory_manager.cpp)
+extern const size purge_pages(voidptr i_address, const size i_sizeInBytes);
+extern const size get_system_page_size();
+
 namespace detail
 {
 // ----------------------------------------------------------------------------
 
-template <class t_alloc_header>
+template <class t_alloc_header, class t_locking>
 class alloc_region
 {
 public:
 	typedef t_alloc_header						alloc_header_t;
+	typedef typename t_locking::mutex_t			mutex_t;
+	typedef typename t_locking::lock_guard_t	lock_guard_t;
 
 public:
 	alloc_region()
@@ -22,6 +37,8 @@ public:
 		, p_base_address(nullptr)
 		, p_size_in_bytes(0)
 		, p_used_bytes(0)
+		, p_committed_bytes(0)
+		, p_commit_func(nullptr)
 	{ }
 
 protected:
@@ -34,13 +51,85 @@ public:
 	size										p_size_in_bytes;
 	size										p_used_bytes;
 
+	// reserved regions: only [p_base_address, p_base_address + p_committed_bytes) is backed by memory,
+	// p_commit_func is nullptr for regions which are fully committed up front
+	size										p_committed_bytes;
+	commit_func_t								p_commit_func;
+
 	// TODO: m_?
-	floral::mutex								m_alloc_mutex;
+	mutex_t										m_alloc_mutex;
+};
+
+// make sure the region is committed up to i_endAddress, growing by HL_COMMIT_GRANULARITY steps
+template <class t_alloc_region>
+inline const bool commit_to(t_alloc_region& io_region, const p8 i_endAddress)
+{
+	if (io_region.p_commit_func == nullptr)
+		return true;
+
+	const size neededBytes = (size)(i_endAddress - io_region.p_base_address);
+	if (neededBytes <= io_region.p_committed_bytes)
+		return true;
+
+	size newCommittedBytes = (neededBytes + HL_COMMIT_GRANULARITY - 1) & ~(size)(HL_COMMIT_GRANULARITY - 1);
+	if (newCommittedBytes > io_region.p_size_in_bytes)
+		newCommittedBytes = io_region.p_size_in_bytes;
+	if (!io_region.p_commit_func(io_region.p_base_address + io_region.p_committed_bytes, newCommittedBytes - io_region.p_committed_bytes))
+		return false;
+
+	io_region.p_committed_bytes = newCommittedBytes;
+	return true;
+}
+
+template <class t_alloc_region>
+inline const size get_committed_bytes(const t_alloc_region& i_region)
+{
+	return i_region.p_commit_func ? i_region.p_committed_bytes : i_region.p_size_in_bytes;
+}
+
+// purge_pages() limited to the committed part of the region
+template <class t_alloc_region>
+inline const size purge_range(const t_alloc_region& i_region, const p8 i_begin, const p8 i_end)
+{
+	const p8 committedEnd = i_region.p_base_address + get_committed_bytes(i_region);
+	const p8 end = i_end < committedEnd ? i_end : committedEnd;
+	return (end > i_begin) ? purge_pages(i_begin, (size)(end - i_begin)) : 0;
+}
+
+// lock-free regions: no mutex (the locking policy is ignored), no live-allocation list,
+// used bytes are updated atomically
+template <class t_tracking_header, class t_locking>
+class alloc_region<lockfree_alloc_header<t_tracking_header>, t_locking>
+{
+public:
+	typedef lockfree_alloc_header<t_tracking_header>	alloc_header_t;
+
+public:
+	alloc_region()
+		: p_base_address(nullptr)
+		, p_size_in_bytes(0)
+		, p_used_bytes(0)
+	{ }
+
+protected:
+	~alloc_region()
+	{ }
+
+public:
+	p8											p_base_address;
+	size										p_size_in_bytes;
+	std::atomic<size>							p_used_bytes;
 };
 
 }
 
 typedef size (*dbginfo_extractor_func_t)(voidptr, debug_memory_block*, const u32, u32&);
+// high-water mark of a region, only for allocators which keep one
+typedef size (*peak_extractor_func_t)(voidptr);
+// committed bytes of a reserved region
+typedef size (*commit_extractor_func_t)(voidptr);
+// trim() of an allocator, returns the bytes given back to the OS
+typedef size (*trim_func_t)(voidptr);
 
 template <class t_alloc_region>
 struct alloc_region_dbginfo_extractor
@@ -48,6 +137,24 @@ struct alloc_region_dbginfo_extractor
 	static size                             	extract_info(voidptr i_allocRegion, debug_memory_block* i_memBlocks, const u32 i_maxSize, u32& o_numBlocks);
 };
 
+template <class t_alloc_region>
+struct alloc_region_commit_extractor
+{
+	static size									extract_committed(voidptr i_allocRegion)		{ return detail::get_committed_bytes(*(t_alloc_region*)i_allocRegion); }
+};
+
+template <class t_allocator>
+struct allocator_trimmer
+{
+	static size									trim(voidptr i_allocator)						{ return ((t_allocator*)i_allocator)->trim(); }
+};
+
+template <class t_tracking_header, class t_locking>
+struct alloc_region_dbginfo_extractor<detail::alloc_region<lockfree_alloc_header<t_tracking_header>, t_locking> >
+{
+	static size                             	extract_info(voidptr i_allocRegion, debug_memory_block* i_memBlocks, const u32 i_maxSize, u32& o_numBlocks);
+};
+
 // ----------------------------------------------------------------------------
 }
 
@@ -1,40 +1,77 @@
 #include <string.h>
+#include <type_traits>
 
 namespace helich
 {
 // ----------------------------------------------------------------------------
 
+namespace detail
+{
+
+template <class t_alloc_region>
+u32 extract_live_blocks(t_alloc_region* i_allocRegion, debug_memory_block* i_memBlocks, const u32 i_maxSize, std::true_type)
+{
+	typedef typename t_alloc_region::alloc_header_t	header_t;
+
+	header_t* currAlloc = i_allocRegion->p_last_alloc;
+	u32 numAllocBlocks = 0;
+	while (currAlloc != nullptr)
+	{
+		FLORAL_ASSERT_MSG(numAllocBlocks <= i_maxSize, "Error when building Allocation Block list (not enough array size)");
+
+		i_memBlocks[numAllocBlocks].frame_size = currAlloc->frame_size;
+		strcpy(i_memBlocks[numAllocBlocks].description, currAlloc->description);
+		i_memBlocks[numAllocBlocks].frame_address = (p8)((aptr)currAlloc - currAlloc->adjustment);
+
+		numAllocBlocks++;
+		currAlloc = currAlloc->prev_alloc;
+	}
+	return numAllocBlocks;
+}
+
+// compact headers have no live-allocation list, only usage can be reported
+template <class t_alloc_region>
+u32 extract_live_blocks(t_alloc_region* i_allocRegion, debug_memory_block* i_memBlocks, const u32 i_maxSize, std::false_type)
+{
+	return 0;
+}
+
+}
+
 template <class t_alloc_region>
 size alloc_region_dbginfo_extractor<t_alloc_region>::extract_info(voidptr i_allocRegion, debug_memory_block* i_memBlocks,
 		const u32 i_maxSize, u32& o_numBlocks)
 {
 	typedef typename t_alloc_region::alloc_header_t	header_t;
+	typedef typename t_alloc_region::lock_guard_t	lock_guard_t;
 
 	t_alloc_region* allocRegion = (t_alloc_region*)i_allocRegion;
 
-	floral::lock_guard memGuard(allocRegion->m_alloc_mutex);
+	lock_guard_t memGuard(allocRegion->m_alloc_mutex);
 
-	header_t* lastAlloc = allocRegion->p_last_alloc;
-	header_t* currAlloc = lastAlloc;
 	if (i_memBlocks != nullptr)
 	{
-		u32 numAllocBlocks = 0;
-		while (currAlloc != nullptr)
-		{
-			FLORAL_ASSERT_MSG(numAllocBlocks <= i_maxSize, "Error when building Allocation Block list (not enough array size)");
-
-			i_memBlocks[numAllocBlocks].frame_size = currAlloc->frame_size;
-			strcpy(i_memBlocks[numAllocBlocks].description, currAlloc->description);
-			i_memBlocks[numAllocBlocks].frame_address = (p8)((aptr)currAlloc - currAlloc->adjustment);
-
-			numAllocBlocks++;
-			currAlloc = currAlloc->prev_alloc;
-		}
-		o_numBlocks = numAllocBlocks;
+		o_numBlocks = detail::extract_live_blocks(allocRegion, i_memBlocks, i_maxSize,
+				std::integral_constant<bool, alloc_header_traits<header_t>::k_has_live_list>());
 	}
 
 	return allocRegion->p_used_bytes;
 }
 
+// there is no live-allocation list to walk in lock-free regions, only usage can be reported
+template <class t_tracking_header, class t_locking>
+size alloc_region_dbginfo_extractor<detail::alloc_region<lockfree_alloc_header<t_tracking_header>, t_locking> >::extract_info(voidptr i_allocRegion,
+		debug_memory_block* i_memBlocks, const u32 i_maxSize, u32& o_numBlocks)
+{
+	typedef detail::alloc_region<lockfree_alloc_header<t_tracking_header>, t_locking> alloc_region_t;
+
+	alloc_region_t* allocRegion = (alloc_region_t*)i_allocRegion;
+	if (i_memBlocks != nullptr)
+	{
+		o_numBlocks = 0;
+	}
+	return allocRegion->p_used_bytes.load(std::memory_order_relaxed);
+}
+
 // ----------------------------------------------------------------------------
 }
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <floral/stdaliases.h>
+
+#include "helich/macros.h"
+#include "helich/memory_map.h"
+
+namespace helich
+{
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+// number of online NUMA nodes, at most HL_MAX_NUMA_NODES (the lowest ids). 1 when the system has no NUMA support.
+// the nodes are referred to by their index among the online ones, the ids of the system may have holes
+const u32										get_numa_node_count();
+
+// node index of the CPU the calling thread was on when it first asked, cached per thread: pin the worker
+// threads which rely on it
+const u32										get_current_numa_node();
+
+// sets the NUMA policy of [i_address, i_address + i_sizeInBytes), call it before the range is touched.
+// returns false when the policy could not be applied, the range then keeps the system default
+const bool										apply_numa_policy(voidptr i_address, const size i_sizeInBytes,
+													const region_numa_policy i_policy, const u32 i_node);
+
+// node mask of a sysfs node list ("0", "0-3", "0,2-3"...), the ids past 63 are ignored
+const u64										parse_numa_node_list(const_cstr i_list);
+
+// ----------------------------------------------------------------------------
+}
+}
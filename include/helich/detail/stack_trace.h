@@ -0,0 +1,25 @@
+#pragma once
+
+#include <floral/stdaliases.h>
+
+#include "helich/macros.h"
+
+namespace helich
+{
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+// return addresses of the calling thread's stack, innermost first, without the first i_skipFrames
+// callers (capture_stack_trace() itself is never part of it). Returns how many were written.
+// Linux / POSIX: the libgcc unwinder, or a frame pointer walk with HL_FRAME_POINTER_STACKS (much faster,
+// but only as good as the -fno-omit-frame-pointer coverage of the code being walked).
+// Windows: RtlCaptureStackBackTrace
+HL_NOINLINE const u32							capture_stack_trace(voidptr* o_frames, const u32 i_maxFrames, const u32 i_skipFrames);
+
+// "function+0xoffset" or "module+0xoffset" of a return address, for human readable exports
+void											describe_frame(voidptr i_frame, c8* o_buffer, const size i_bufferSize);
+
+// ----------------------------------------------------------------------------
+}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <floral/stdaliases.h>
+
+#include "helich/macros.h"
+
+namespace helich
+{
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+// every live thread which asks for it gets a unique index in [0, HL_MAX_THREAD_CACHES), the
+// index is given back when the thread exits so it can be reused by a later thread.
+// returns HL_MAX_THREAD_CACHES when all slots are taken, callers must then fall back to the
+// shared (locked) path
+const u32										get_thread_slot();
+
+// ----------------------------------------------------------------------------
+}
+}
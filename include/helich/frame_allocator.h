@@ -0,0 +1,129 @@
+#pragma once
+
+#include "alloc_schemes.h"
+#include "tracking_policies.h"
+#include "locking_policies.h"
+#include "allocator.h"
+
+#include <floral/stdaliases.h>
+
+namespace helich
+{
+// ----------------------------------------------------------------------------
+
+// N stack_scheme sub-regions used in rotation, one per tick: data allocated during tick N is still
+// alive during tick N+1 .. N+t_frame_count-1, advance_frame() then recycles the oldest frame in O(1).
+// memory_manager reports every frame as its own region ("<name>/frame<i>"), with its high-water mark.
+// NOTE: advance_frame() must not race with allocations, call it from the thread driving the ticks
+template <u32 t_frame_count, class t_tracking_policy = default_tracking_policy,
+		 class t_locking_policy = mutex_locking_policy>
+class frame_allocator
+{
+	static_assert(t_frame_count >= 2, "A frame_allocator needs at least 2 frames");
+
+public:
+	typedef allocator<stack_scheme, t_tracking_policy, t_locking_policy>	frame_t;
+	typedef typename frame_t::marker										marker_t;
+
+	static const u32							k_frame_count = t_frame_count;
+
+public:
+	frame_allocator()
+		: m_base_address(nullptr)
+		, m_size_in_bytes(0)
+		, m_current_frame(0)
+		, m_frame_index(0)
+	{}
+
+	~frame_allocator()
+	{}
+
+	void map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+	{
+		m_base_address = (p8)i_baseAddress;
+		m_size_in_bytes = i_sizeInBytes;
+
+		// frames start on their own cache line, out of what is left after aligning the base
+		p8 frameBase = (p8)align_address(i_baseAddress, HL_CACHE_LINE_SIZE);
+		const size frameSize = ((i_sizeInBytes - (frameBase - (p8)i_baseAddress)) / t_frame_count) & ~(size)(HL_CACHE_LINE_SIZE - 1);
+		for (u32 i = 0; i < t_frame_count; i++)
+		{
+			m_frames[i].map_to(frameBase, frameSize, i_name);
+			m_base_markers[i] = m_frames[i].get_marker();
+			frameBase += frameSize;
+		}
+		m_current_frame = 0;
+		m_frame_index = 0;
+	}
+
+	// recycle the oldest frame and make it the current one
+	void advance_frame()
+	{
+		m_current_frame = (m_current_frame + 1) % t_frame_count;
+		m_frames[m_current_frame].free_to_marker(m_base_markers[m_current_frame]);
+		m_frame_index++;
+	}
+
+	voidptr allocate(const size i_bytes, const_cstr i_desc = nullptr)
+	{
+		return m_frames[m_current_frame].allocate(i_bytes, i_desc);
+	}
+
+	voidptr allocate_aligned(const size i_bytes, const size i_alignment, const_cstr i_desc = nullptr)
+	{
+		return m_frames[m_current_frame].allocate_aligned(i_bytes, i_alignment, i_desc);
+	}
+
+	template <class t_object_type, class ... t_params>
+	t_object_type* allocate(t_params... i_params)
+	{
+		return m_frames[m_current_frame].template allocate<t_object_type>(i_params...);
+	}
+
+	template <class t_object_type>
+	t_object_type* allocate_podarray(const size i_elemCount, const_cstr i_desc = nullptr)
+	{
+		return m_frames[m_current_frame].template allocate_podarray<t_object_type>(i_elemCount, i_desc);
+	}
+
+	void free_all()
+	{
+		for (u32 i = 0; i < t_frame_count; i++)
+			m_frames[i].free_to_marker(m_base_markers[i]);
+		m_current_frame = 0;
+	}
+
+	// give the unused pages of every frame back to the OS
+	const size trim()
+	{
+		size releasedBytes = 0;
+		for (u32 i = 0; i < t_frame_count; i++)
+			releasedBytes += m_frames[i].trim();
+		return releasedBytes;
+	}
+
+	// data of the previous tick, still valid until it is recycled
+	frame_t&									get_previous_frame()								{ return m_frames[(m_current_frame + t_frame_count - 1) % t_frame_count]; }
+	frame_t&									get_current_frame()									{ return m_frames[m_current_frame]; }
+	frame_t&									get_frame(const u32 i_index)						{ return m_frames[i_index]; }
+
+	static size									extract_frame_peak(voidptr i_frame)					{ return ((frame_t*)i_frame)->get_peak_used_bytes(); }
+
+private:
+	p8											m_base_address;
+	size										m_size_in_bytes;
+	frame_t										m_frames[t_frame_count];
+	marker_t									m_base_markers[t_frame_count];
+	u32											m_current_frame;
+	u64											m_frame_index;
+
+public:
+	const p8									get_base_address() const 							{ return m_base_address; }
+	const size									get_size_in_bytes() const							{ return m_size_in_bytes; }
+	const size									get_used_bytes() const								{ return m_frames[m_current_frame].get_used_bytes(); }
+	const u32									get_current_frame_index() const						{ return m_current_frame; }
+	const u64									get_frame_number() const							{ return m_frame_index; }
+};
+
+// ----------------------------------------------------------------------------
+}
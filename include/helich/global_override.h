@@ -0,0 +1,124 @@
+#pragma once
+
+#include "helich/macros.h"
+
+#include <floral/stdaliases.h>
+
+namespace helich
+{
+// ----------------------------------------------------------------------------
+
+// the helich_global_override library replaces the global operator new / delete, and with
+// HL_GLOBAL_OVERRIDE_MALLOC (glibc only) malloc, free & co. too, so it can be LD_PRELOAD-ed under code
+// whose call sites cannot be touched. Requests up to slab_scheme::k_max_small_size go to a slab region
+// (HL_GLOBAL_SMALL_REGION_SIZE), the rest to a freelist region (HL_GLOBAL_LARGE_REGION_SIZE), both are
+// mapped by the first request. What helich cannot serve (full regions, requests made while the regions
+// are being mapped) falls back to the system allocator, free() tells the two apart by address.
+// NOTE: only link it into executables, every allocation of the process goes through it
+
+// a region the global allocations of a thread can be redirected to, see scoped_global_region
+struct global_region
+{
+	typedef voidptr								(*allocate_func_t)(voidptr i_allocator, const size i_bytes, const size i_alignment);
+	typedef void								(*free_func_t)(voidptr i_allocator, voidptr i_data);
+	typedef const size							(*usable_size_func_t)(voidptr i_allocator, voidptr i_data);
+
+	const_cstr									name;
+	voidptr										allocator_ptr;
+	p8											base_address;
+	size										size_in_bytes;
+	allocate_func_t								allocate_func;
+	free_func_t									free_func;
+	usable_size_func_t							usable_size_func;
+};
+
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+template <class t_allocator>
+struct global_region_funcs
+{
+	static voidptr allocate(voidptr i_allocator, const size i_bytes, const size i_alignment)
+	{
+		return ((t_allocator*)i_allocator)->allocate_aligned(i_bytes, i_alignment);
+	}
+
+	static void free(voidptr i_allocator, voidptr i_data)
+	{
+		((t_allocator*)i_allocator)->free(i_data);
+	}
+
+	static const size usable_size(voidptr i_allocator, voidptr i_data)
+	{
+		return ((t_allocator*)i_allocator)->get_usable_size(i_data);
+	}
+};
+
+// ----------------------------------------------------------------------------
+}
+
+// i_allocator must be mapped already and its scheme must provide get_usable_size() (freelist, tlsf, slab)
+// eg.
+//	const global_region* level = register_global_region(make_global_region("level", &g_level_allocator));
+//	{
+//		scoped_global_region redirect(level);
+//		load_third_party_level(...);			// every new / malloc of this thread lands in g_level_allocator
+//	}
+template <class t_allocator>
+inline global_region make_global_region(const_cstr i_name, t_allocator* i_allocator)
+{
+	global_region region;
+	region.name = i_name;
+	region.allocator_ptr = (voidptr)i_allocator;
+	region.base_address = i_allocator->get_base_address();
+	region.size_in_bytes = i_allocator->get_size_in_bytes();
+	region.allocate_func = &detail::global_region_funcs<t_allocator>::allocate;
+	region.free_func = &detail::global_region_funcs<t_allocator>::free;
+	region.usable_size_func = &detail::global_region_funcs<t_allocator>::usable_size;
+	return region;
+}
+
+// the region is kept for the lifetime of the process, the global free() of any thread recognizes its
+// allocations from now on. Returns nullptr when HL_MAX_GLOBAL_REGIONS regions are registered already
+extern const global_region*						register_global_region(const global_region& i_region);
+
+// i_region must come from register_global_region(), nullptr goes back to the default regions.
+// When the region is full, requests fall back to the defaults
+extern void										set_thread_global_region(const global_region* i_region);
+extern const global_region*						get_thread_global_region();
+
+struct global_override_stats
+{
+	u64											small_allocs;			// default slab region
+	u64											large_allocs;			// default freelist region
+	u64											region_allocs;			// registered regions
+	u64											system_allocs;			// fallbacks to the system allocator
+	u64											frees;
+};
+
+extern const global_override_stats				get_global_override_stats();
+
+class scoped_global_region
+{
+public:
+	explicit scoped_global_region(const global_region* i_region)
+		: m_previous_region(get_thread_global_region())
+	{
+		set_thread_global_region(i_region);
+	}
+
+	~scoped_global_region()
+	{
+		set_thread_global_region(m_previous_region);
+	}
+
+	scoped_global_region(const scoped_global_region&) = delete;
+	scoped_global_region&						operator=(const scoped_global_region&) = delete;
+
+private:
+	const global_region*						m_previous_region;
+};
+
+// ----------------------------------------------------------------------------
+}
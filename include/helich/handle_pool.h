@@ -0,0 +1,249 @@
+#pragma once
+
+#include "helich/detail/alloc_region.h"
+#include "helich/locking_policies.h"
+#include "helich/utils.h"
+
+#include <floral/stdaliases.h>
+#include <floral/assert/assert.h>
+
+#include <new>
+#include <string.h>
+#include <utility>
+
+namespace helich
+{
+// ----------------------------------------------------------------------------
+
+// objects referenced by 32-bit handles instead of raw pointers: a handle packs a slot index and the
+// generation of that slot, the slot is bumped to a new generation when its object is destroyed, so a
+// stale handle resolves to nullptr instead of dangling.
+// the objects themselves are kept densely packed in [get_objects(), get_objects() + get_count()): destroying
+// one moves the last object into its place and repoints the slot of the moved object, handles stay valid.
+// NOTE: a pointer returned by resolve() is only good until the next destroy(), keep the handle instead
+// eg.
+//	handle_pool<texture> g_textures;
+//	memory_region<handle_pool<texture>> { "textures", SIZE_MB(1), &g_textures }
+//	handle_pool<texture>::handle_t h = g_textures.create(width, height);
+//	if (texture* t = g_textures.resolve(h)) ...
+template <class t_object_type, class t_locking_policy = mutex_locking_policy>
+class handle_pool :
+	private detail::alloc_region<compact_fixed_size_alloc_header<untracked_alloc_header>, t_locking_policy>
+{
+public:
+	typedef u32									handle_t;
+	typedef handle_pool							alloc_scheme_t;
+	typedef detail::alloc_region<compact_fixed_size_alloc_header<untracked_alloc_header>, t_locking_policy>	alloc_region_t;
+	typedef typename alloc_region_t::lock_guard_t	lock_guard_t;
+
+	static const u32							k_index_bits = 20;
+	static const u32							k_generation_bits = 32 - k_index_bits;
+	static const u32							k_max_capacity = 1u << k_index_bits;
+	static const handle_t						k_null_handle = 0;						// generation 0 is never handed out
+
+public:
+	handle_pool()
+		: m_objects(nullptr)
+		, m_slots(nullptr)
+		, m_dense_slots(nullptr)
+		, m_capacity(0)
+		, m_count(0)
+		, m_next_free_slot(k_no_slot)
+	{}
+
+	~handle_pool()
+	{}
+
+	void map_to(voidptr i_baseAddress, const size i_sizeInBytes, const_cstr i_name)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		alloc_region_t::p_base_address = (p8)i_baseAddress;
+		alloc_region_t::p_size_in_bytes = i_sizeInBytes;
+
+		// objects first, on their own cache line, then the slots and the dense -> slot back references
+		const size bytesPerObject = sizeof(t_object_type) + sizeof(slot) + sizeof(u32);
+		m_objects = (t_object_type*)align_address(i_baseAddress, max_alignment(alignof(t_object_type), HL_CACHE_LINE_SIZE));
+		const size usableBytes = (size)((p8)i_baseAddress + i_sizeInBytes - (p8)m_objects);
+		size capacity = (usableBytes - alignof(slot)) / bytesPerObject;
+		if (capacity > k_max_capacity)
+			capacity = k_max_capacity;
+		FLORAL_ASSERT_MSG(capacity > 0, "Region is too small for handle_pool");
+
+		m_capacity = (u32)capacity;
+		m_slots = (slot*)align_address(m_objects + m_capacity, alignof(slot));
+		m_dense_slots = (u32*)(m_slots + m_capacity);
+
+		// every slot starts at generation 1, so a zeroed handle never resolves
+		for (u32 i = 0; i < m_capacity; i++)
+			m_slots[i].generation = 1;
+		reset_slots();
+	}
+
+	template <class ... t_params>
+	handle_t create(t_params... i_params)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		if (m_next_free_slot == k_no_slot)
+		{
+			// out of memory
+			return k_null_handle;
+		}
+
+		const u32 slotIndex = m_next_free_slot;
+		slot& newSlot = m_slots[slotIndex];
+		m_next_free_slot = newSlot.dense_index;
+
+		newSlot.dense_index = m_count;
+		m_dense_slots[m_count] = slotIndex;
+		new (&m_objects[m_count]) t_object_type(i_params...);
+		m_count++;
+		alloc_region_t::p_used_bytes += sizeof(t_object_type);
+
+		return make_handle(slotIndex, newSlot.generation);
+	}
+
+	// destroying a stale handle is a no-op
+	void destroy(const handle_t i_handle)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		if (!is_live(i_handle))
+			return;
+
+		const u32 slotIndex = get_index(i_handle);
+		slot& oldSlot = m_slots[slotIndex];
+		const u32 denseIndex = oldSlot.dense_index;
+		const u32 lastIndex = m_count - 1;
+
+		// fill the hole with the last object
+		m_objects[denseIndex].~t_object_type();
+		if (denseIndex != lastIndex)
+		{
+			new (&m_objects[denseIndex]) t_object_type(std::move(m_objects[lastIndex]));
+			m_objects[lastIndex].~t_object_type();
+			m_dense_slots[denseIndex] = m_dense_slots[lastIndex];
+			m_slots[m_dense_slots[denseIndex]].dense_index = denseIndex;
+		}
+		m_count--;
+		alloc_region_t::p_used_bytes -= sizeof(t_object_type);
+
+		retire_slot(slotIndex);
+	}
+
+	t_object_type* resolve(const handle_t i_handle)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		return is_live(i_handle) ? &m_objects[m_slots[get_index(i_handle)].dense_index] : nullptr;
+	}
+
+	const bool is_valid(const handle_t i_handle)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		return is_live(i_handle);
+	}
+
+	// calls i_fn(t_object_type&) for every object, in dense order. The lock is held during the walk,
+	// i_fn must not create or destroy objects of this pool
+	template <class t_functor>
+	void for_each(t_functor i_fn)
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		for (u32 i = 0; i < m_count; i++)
+			i_fn(m_objects[i]);
+	}
+
+	// destroys every object, all outstanding handles become stale
+	void free_all()
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		for (u32 i = 0; i < m_count; i++)
+		{
+			m_objects[i].~t_object_type();
+			bump_generation(m_slots[m_dense_slots[i]]);
+		}
+		alloc_region_t::p_used_bytes = 0;
+		reset_slots();
+	}
+
+	// give the pages past the last object back to the OS
+	const size trim()
+	{
+		lock_guard_t memGuard(alloc_region_t::m_alloc_mutex);
+		return detail::purge_range((alloc_region_t&)*this, (p8)(m_objects + m_count), (p8)(m_objects + m_capacity));
+	}
+
+	// handle of the object at i_denseIndex, e.g. while walking get_objects()
+	const handle_t get_handle(const u32 i_denseIndex) const
+	{
+		const u32 slotIndex = m_dense_slots[i_denseIndex];
+		return make_handle(slotIndex, m_slots[slotIndex].generation);
+	}
+
+	static const u32							get_index(const handle_t i_handle)				{ return i_handle & (k_max_capacity - 1); }
+	static const u32							get_generation(const handle_t i_handle)			{ return i_handle >> k_index_bits; }
+
+private:
+	struct slot
+	{
+		u32										dense_index;			// next free slot while the slot is free
+		u32										generation;
+	};
+
+	static const u32							k_no_slot = 0xffffffffu;
+
+	static const handle_t						make_handle(const u32 i_index, const u32 i_generation)	{ return (i_generation << k_index_bits) | i_index; }
+
+	const bool is_live(const handle_t i_handle) const
+	{
+		const u32 slotIndex = get_index(i_handle);
+		if (slotIndex >= m_capacity)
+			return false;
+		const slot& handleSlot = m_slots[slotIndex];
+		return handleSlot.generation == get_generation(i_handle) && handleSlot.dense_index < m_count
+			&& m_dense_slots[handleSlot.dense_index] == slotIndex;
+	}
+
+	static void bump_generation(slot& io_slot)
+	{
+		io_slot.generation = (io_slot.generation + 1) & ((1u << k_generation_bits) - 1);
+		if (io_slot.generation == 0)
+			io_slot.generation = 1;
+	}
+
+	void retire_slot(const u32 i_slotIndex)
+	{
+		slot& oldSlot = m_slots[i_slotIndex];
+		bump_generation(oldSlot);
+		oldSlot.dense_index = m_next_free_slot;
+		m_next_free_slot = i_slotIndex;
+	}
+
+	// chains every slot into the free list, lowest index first, generations are kept
+	void reset_slots()
+	{
+		for (u32 i = 0; i < m_capacity; i++)
+			m_slots[i].dense_index = i + 1;
+		m_slots[m_capacity - 1].dense_index = k_no_slot;
+		m_next_free_slot = 0;
+		m_count = 0;
+	}
+
+private:
+	t_object_type*								m_objects;
+	slot*										m_slots;
+	u32*										m_dense_slots;
+	u32											m_capacity;
+	u32											m_count;
+	u32											m_next_free_slot;
+
+public:
+	const p8									get_base_address() const 						{ return alloc_region_t::p_base_address; }
+	const size									get_size_in_bytes() const						{ return alloc_region_t::p_size_in_bytes; }
+	const size									get_used_bytes() const							{ return alloc_region_t::p_used_bytes; }
+	const size									get_remain_bytes() const						{ return (size)(m_capacity - m_count) * sizeof(t_object_type); }
+	t_object_type*								get_objects() const								{ return m_objects; }
+	const u32									get_count() const								{ return m_count; }
+	const u32									get_capacity() const							{ return m_capacity; }
+};
+
+// ----------------------------------------------------------------------------
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <floral.h>
+
+#include <atomic>
+
+namespace helich
+{
+// ----------------------------------------------------------------------------
+
+// locking policies decide how an allocator serializes its calls, they only need to provide
+// 'mutex_t' (a member of every alloc_region) and 'lock_guard_t' (constructed from a mutex_t&)
+
+template <class t_mutex>
+class scoped_lock
+{
+public:
+	explicit scoped_lock(t_mutex& i_mutex)
+		: m_mutex(i_mutex)
+	{
+		m_mutex.lock();
+	}
+
+	~scoped_lock()
+	{
+		m_mutex.unlock();
+	}
+
+private:
+	scoped_lock(const scoped_lock&);
+	scoped_lock& operator=(const scoped_lock&);
+
+private:
+	t_mutex&									m_mutex;
+};
+
+class null_mutex
+{
+public:
+	void										lock()											{ }
+	void										unlock()										{ }
+};
+
+// test-and-test-and-set, for regions whose critical sections are a handful of pointer updates
+class spinlock
+{
+public:
+	constexpr spinlock()
+		: m_locked(false)
+	{ }
+
+	void lock()
+	{
+		while (true)
+		{
+			if (!m_locked.exchange(true, std::memory_order_acquire))
+				return;
+			while (m_locked.load(std::memory_order_relaxed))
+			{
+			}
+		}
+	}
+
+	void unlock()
+	{
+		m_locked.store(false, std::memory_order_release);
+	}
+
+private:
+	std::atomic<bool>							m_locked;
+};
+
+// single-owner regions (eg. per-frame stack arenas): no synchronization at all
+class no_locking_policy
+{
+public:
+	typedef null_mutex							mutex_t;
+	typedef scoped_lock<null_mutex>				lock_guard_t;
+};
+
+class spinlock_locking_policy
+{
+public:
+	typedef spinlock							mutex_t;
+	typedef scoped_lock<spinlock>				lock_guard_t;
+};
+
+// This policy will be used by default
+class mutex_locking_policy
+{
+public:
+	typedef floral::mutex						mutex_t;
+	typedef floral::lock_guard					lock_guard_t;
+};
+
+// ----------------------------------------------------------------------------
+}
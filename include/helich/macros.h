@@ -8,5 +8,51 @@
 #define		TO_KB(X)							(X / 1024u)
 #define		TO_MB(X)							(TO_KB(X) / 1024u)
 
+// the stack captures skip a fixed number of frames, the functions taking them must keep their own
+#if defined(_MSC_VER)
+#	define  HL_NOINLINE                         __declspec(noinline)
+#else
+#	define  HL_NOINLINE                         __attribute__((noinline))
+#endif
+
 // constants
-#define     HL_ALIGNMENT                        4
\ No newline at end of file
+#define     HL_ALIGNMENT                        4
+#define     HL_CACHE_LINE_SIZE                  64			// also the biggest alignment a pool slot gets
+#define     HL_COMMIT_GRANULARITY               SIZE_KB(64)	// reserved regions are committed by this step, a multiple of the page size
+
+// thread caches, both can be overridden before including helich
+#if !defined(HL_MAX_THREAD_CACHES)
+#	define  HL_MAX_THREAD_CACHES                64			// at most 64, one bit per thread slot
+#endif
+#if !defined(HL_MAX_MAGAZINE_SIZE)
+#	define  HL_MAX_MAGAZINE_SIZE                64
+#endif
+
+// NUMA nodes helich knows about, can be overridden before including helich
+#if !defined(HL_MAX_NUMA_NODES)
+#	define  HL_MAX_NUMA_NODES                   8			// at most 64, one bit per node
+#endif
+
+// sampled_tracking_policy: mean number of allocated bytes between two samples, can be changed at runtime
+#if !defined(HL_SAMPLE_INTERVAL)
+#	define  HL_SAMPLE_INTERVAL                  SIZE_KB(512)
+#endif
+
+// stack traces of the tracking policies, every distinct stack is stored once in a trace_table
+#if !defined(HL_MAX_STACK_TRACES)
+#	define  HL_MAX_STACK_TRACES                 4096		// per table, a power of two
+#endif
+#if !defined(HL_MAX_STACK_DEPTH)
+#	define  HL_MAX_STACK_DEPTH                  32			// innermost frames kept per stack
+#endif
+
+// regions of the helich_global_override library (global operator new / malloc), set them on that target
+#if !defined(HL_GLOBAL_SMALL_REGION_SIZE)
+#	define  HL_GLOBAL_SMALL_REGION_SIZE         SIZE_MB(256)	// slab_scheme, up to its k_max_small_size
+#endif
+#if !defined(HL_GLOBAL_LARGE_REGION_SIZE)
+#	define  HL_GLOBAL_LARGE_REGION_SIZE         SIZE_GB(4ull)	// freelist_scheme, only reserved up front
+#endif
+#if !defined(HL_MAX_GLOBAL_REGIONS)
+#	define  HL_MAX_GLOBAL_REGIONS               8			// regions registered with register_global_region()
+#endif
\ No newline at end of file
@@ -2,9 +2,13 @@
 
 #include <floral.h>
 
+#include <stdio.h>
+
 #include "macros.h"
 #include "memory_map.h"
 #include "allocator.h"
+#include "frame_allocator.h"
+#include "numa_replicated_allocator.h"
 #include "alloc_schemes.h"
 #include "tracking_policies.h"
 #include "detail/alloc_region.h"
@@ -18,8 +22,10 @@ extern void init_memory_system();
 
 extern fixed_allocator<pool_scheme, sizeof(debug_entry), no_tracking_policy>	g_tracking_allocator;
 extern fixed_allocator<pool_scheme, 128, no_tracking_policy>					g_description_allocator;
+extern fixed_allocator<pool_scheme, sizeof(sample_entry), no_tracking_policy>	g_sample_allocator;
 
 #define MEMORY_TRACKING_SIZE					SIZE_MB(1)
+#define MEMORY_SAMPLES_SIZE						SIZE_MB(1)
 #define MAX_MEM_REGIONS							32
 
 class memory_manager
@@ -28,21 +34,36 @@ public:
 	memory_manager();
 	~memory_manager();
 
-	const voidptr								allocate_global_memory(voidptr i_baseAddress, const size i_sizeInBytes);
-	void										free_global_memory(voidptr i_baseAddress, const size i_sizeInBytes);
+	// region bases are aligned to the size of the pages backing them
+	const voidptr								allocate_global_memory(voidptr i_baseAddress, const size i_sizeInBytes,
+													const region_page_size i_pageSize = region_page_size::system_default);
+	void										free_global_memory(voidptr i_baseAddress, const size i_sizeInBytes,
+													const region_page_size i_pageSize = region_page_size::system_default);
+	static const size							get_page_size_in_bytes(const region_page_size i_pageSize);
+	// reserved memory is released with free_global_memory()
+	const voidptr								reserve_global_memory(const size i_sizeInBytes);
+	static bool									commit_global_memory(voidptr i_address, const size i_sizeInBytes);
+
+	// trim() every region, returns the bytes given back to the OS
+	const size trim_all()
+	{
+		size releasedBytes = 0;
+		for (u32 i = 0; i < p_mem_regions_count; i++)
+			releasedBytes += p_mem_regions[i].trimmer(p_mem_regions[i].allocator_ptr);
+		return releasedBytes;
+	}
 
+	// every region is mapped on its own, so each one can pick its page size
 	template <class ... t_allocator_regions>
 	const void initialize(t_allocator_regions ... i_regions)
 	{
-		if (!m_base_address)
+		if (!m_initialized)
 		{
-			size totalSize = internal_compute_mem(i_regions...);
-
-			// this call will update m_base_address
-			m_base_address = allocate_global_memory(nullptr, totalSize);
 			p_mem_regions_count = 0;
+			p_total_mem_in_bytes = 0;
 
-			internal_init(m_base_address, i_regions...);
+			internal_init(i_regions...);
+			m_initialized = true;
 		}
 	}
 
@@ -50,104 +71,178 @@ public:
 	const void initialize_allocator(memory_region<t_allocator>& i_region)
 	{
 		size totalSize = i_region.size_in_bytes;
-		voidptr addr = allocate_global_memory(nullptr, totalSize);
+		voidptr addr = allocate_global_memory(nullptr, totalSize, i_region.page_size);
+		detail::apply_numa_policy(addr, totalSize, i_region.numa_policy, i_region.numa_node);
 
 		((t_allocator*)(i_region.allocator_ptr))->map_to(addr, i_region.size_in_bytes, i_region.name);
 	}
 
 	template <class t_allocator>
-	const void destroy_allocator(memory_region<t_allocator>& i_region)
+	const void initialize_allocator(growable_memory_region<t_allocator>& i_region)
 	{
-		size totalSize = i_region.size_in_bytes;
-		voidptr baseAddr = (voidptr)((t_allocator*)(i_region.allocator_ptr)->get_base_address());
-		free_global_memory(baseAddr, totalSize);
+		map_growable_region(i_region);
 	}
 
-private:
-	template <class t_allocator_type>
-	const size internal_compute_mem(memory_region<t_allocator_type> i_al)
+	template <class t_allocator>
+	const void destroy_allocator(memory_region<t_allocator>& i_region)
 	{
-		return i_al.size_in_bytes + MEMORY_TRACKING_SIZE;
+		size totalSize = i_region.size_in_bytes;
+		voidptr baseAddr = (voidptr)((t_allocator*)(i_region.allocator_ptr)->get_base_address());
+		free_global_memory(baseAddr, totalSize, i_region.page_size);
 	}
 
-	template <class t_allocator_type_head, class ... t_allocator_type_rests>
-	const size internal_compute_mem(memory_region<t_allocator_type_head> i_headAl,
-		memory_region<t_allocator_type_rests> ... i_restAl)
+	template <class t_allocator>
+	const void destroy_allocator(growable_memory_region<t_allocator>& i_region)
 	{
-		return (i_headAl.size_in_bytes + internal_compute_mem(i_restAl...));
+		voidptr baseAddr = (voidptr)(i_region.allocator_ptr->get_base_address());
+		free_global_memory(baseAddr, i_region.reserved_bytes);
 	}
 
+private:
+	// one entry in p_mem_regions per allocator
 	template <class t_allocator_type>
-	const bool internal_init_tracking(voidptr i_baseAddress,
-		memory_region<t_allocator_type> i_al)
+	void register_region(const_cstr i_name, voidptr i_baseAddress, const size i_sizeInBytes,
+		const region_page_size i_pageSize, t_allocator_type* i_allocator)
 	{
 		typedef typename t_allocator_type::alloc_scheme_t scheme_t;
 		typedef typename scheme_t::alloc_region_t region_t;
 
-		((t_allocator_type*)(i_al.allocator_ptr))->map_to(i_baseAddress, i_al.size_in_bytes, i_al.name);
-
-		strcpy(p_mem_regions[p_mem_regions_count].name, "helich/tracking");
-		p_mem_regions[p_mem_regions_count].size_in_bytes = MEMORY_TRACKING_SIZE;
+		FLORAL_ASSERT_MSG(p_mem_regions_count < MAX_MEM_REGIONS, "Too many memory regions");
+		strcpy(p_mem_regions[p_mem_regions_count].name, i_name);
+		p_mem_regions[p_mem_regions_count].size_in_bytes = i_sizeInBytes;
+		p_mem_regions[p_mem_regions_count].page_size = i_pageSize;
+		p_mem_regions[p_mem_regions_count].numa_policy = region_numa_policy::system_default;
+		p_mem_regions[p_mem_regions_count].numa_node = 0;
 		p_mem_regions[p_mem_regions_count].base_address = i_baseAddress;
 		p_mem_regions[p_mem_regions_count].dbg_info_extractor = (dbginfo_extractor_func_t)&alloc_region_dbginfo_extractor<region_t>::extract_info;
-		p_mem_regions[p_mem_regions_count].allocator_ptr = (voidptr)i_al.allocator_ptr;
-		p_total_mem_in_bytes += MEMORY_TRACKING_SIZE;
+		p_mem_regions[p_mem_regions_count].peak_extractor = nullptr;
+		p_mem_regions[p_mem_regions_count].committed_extractor = nullptr;
+		p_mem_regions[p_mem_regions_count].trimmer = &allocator_trimmer<t_allocator_type>::trim;
+		p_mem_regions[p_mem_regions_count].allocator_ptr = (voidptr)i_allocator;
 		p_mem_regions_count++;
-		return true;
 	}
 
-	// end of recursion
+	// frame allocators: one entry per frame, with its high-water mark
+	template <u32 t_frame_count, class t_tracking_policy, class t_locking_policy>
+	void register_region(const_cstr i_name, voidptr i_baseAddress, const size i_sizeInBytes,
+		const region_page_size i_pageSize, frame_allocator<t_frame_count, t_tracking_policy, t_locking_policy>* i_allocator)
+	{
+		typedef frame_allocator<t_frame_count, t_tracking_policy, t_locking_policy> frame_allocator_t;
+		typedef typename frame_allocator_t::frame_t::alloc_region_t region_t;
+
+		for (u32 i = 0; i < t_frame_count; i++)
+		{
+			FLORAL_ASSERT_MSG(p_mem_regions_count < MAX_MEM_REGIONS, "Too many memory regions");
+			typename frame_allocator_t::frame_t& frame = i_allocator->get_frame(i);
+			snprintf(p_mem_regions[p_mem_regions_count].name, sizeof(p_mem_regions[p_mem_regions_count].name), "%s/frame%u", i_name, i);
+			p_mem_regions[p_mem_regions_count].size_in_bytes = frame.get_size_in_bytes();
+			p_mem_regions[p_mem_regions_count].page_size = i_pageSize;
+			p_mem_regions[p_mem_regions_count].numa_policy = region_numa_policy::system_default;
+			p_mem_regions[p_mem_regions_count].numa_node = 0;
+			p_mem_regions[p_mem_regions_count].base_address = frame.get_base_address();
+			p_mem_regions[p_mem_regions_count].dbg_info_extractor = (dbginfo_extractor_func_t)&alloc_region_dbginfo_extractor<region_t>::extract_info;
+			p_mem_regions[p_mem_regions_count].peak_extractor = &frame_allocator_t::extract_frame_peak;
+			p_mem_regions[p_mem_regions_count].committed_extractor = nullptr;
+			p_mem_regions[p_mem_regions_count].trimmer = &allocator_trimmer<typename frame_allocator_t::frame_t>::trim;
+			p_mem_regions[p_mem_regions_count].allocator_ptr = (voidptr)&frame;
+			p_mem_regions_count++;
+		}
+	}
+
 	template <class t_allocator_type>
-	const bool internal_init(voidptr i_baseAddress,
-		memory_region<t_allocator_type> i_al)
+	const voidptr map_growable_region(const growable_memory_region<t_allocator_type>& i_al)
 	{
-		typedef typename t_allocator_type::alloc_scheme_t scheme_t;
-		typedef typename scheme_t::alloc_region_t region_t;
+		voidptr baseAddress = reserve_global_memory(i_al.reserved_bytes);
+		FLORAL_ASSERT_MSG(baseAddress != nullptr, "Cannot reserve memory region");
+		detail::apply_numa_policy(baseAddress, i_al.reserved_bytes, i_al.numa_policy, i_al.numa_node);
+		const size committedBytes = i_al.reserved_bytes < HL_COMMIT_GRANULARITY ? i_al.reserved_bytes : HL_COMMIT_GRANULARITY;
+		bool committed = commit_global_memory(baseAddress, committedBytes);
+		FLORAL_ASSERT_MSG(committed, "Cannot commit memory region");
+		i_al.allocator_ptr->map_to_reserved(baseAddress, i_al.reserved_bytes, committedBytes, &memory_manager::commit_global_memory, i_al.name);
+		return baseAddress;
+	}
 
-		((t_allocator_type*)(i_al.allocator_ptr))->map_to(i_baseAddress, i_al.size_in_bytes, i_al.name);
+	// NUMA placement of the entries registered from i_firstRegion on
+	void set_numa_placement(const u32 i_firstRegion, const region_numa_policy i_policy, const u32 i_node)
+	{
+		for (u32 i = i_firstRegion; i < p_mem_regions_count; i++)
+		{
+			p_mem_regions[i].numa_policy = i_policy;
+			p_mem_regions[i].numa_node = i_node;
+		}
+	}
 
-		strcpy(p_mem_regions[p_mem_regions_count].name, i_al.name);
-		p_mem_regions[p_mem_regions_count].size_in_bytes = i_al.size_in_bytes;
-		p_mem_regions[p_mem_regions_count].base_address = i_baseAddress;
-		p_mem_regions[p_mem_regions_count].dbg_info_extractor = (dbginfo_extractor_func_t)&alloc_region_dbginfo_extractor<region_t>::extract_info;
-		p_mem_regions[p_mem_regions_count].allocator_ptr = (voidptr)i_al.allocator_ptr;
+	template <class t_allocator_type>
+	void init_region(const memory_region<t_allocator_type>& i_al)
+	{
+		const u32 firstRegion = p_mem_regions_count;
+		voidptr baseAddress = allocate_global_memory(nullptr, i_al.size_in_bytes, i_al.page_size);
+		FLORAL_ASSERT_MSG(baseAddress != nullptr, "Cannot map memory region");
+		// before map_to(), which touches the first page
+		detail::apply_numa_policy(baseAddress, i_al.size_in_bytes, i_al.numa_policy, i_al.numa_node);
+		i_al.allocator_ptr->map_to(baseAddress, i_al.size_in_bytes, i_al.name);
+
+		register_region(i_al.name, baseAddress, i_al.size_in_bytes, i_al.page_size, i_al.allocator_ptr);
+		set_numa_placement(firstRegion, i_al.numa_policy, i_al.numa_node);
 		p_total_mem_in_bytes += i_al.size_in_bytes;
-		p_mem_regions_count++;
+	}
+
+	// NUMA replicas: one region of i_al.size_in_bytes per node, bound to it
+	template <class t_allocator_type, u32 t_max_nodes>
+	void init_region(const memory_region<numa_replicated_allocator<t_allocator_type, t_max_nodes>>& i_al)
+	{
+		const u32 nodeCount = detail::get_numa_node_count();
+		const u32 replicaCount = nodeCount < t_max_nodes ? nodeCount : t_max_nodes;
+		for (u32 i = 0; i < replicaCount; i++)
+		{
+			c8 replicaName[512];
+			snprintf(replicaName, sizeof(replicaName), "%s/node%u", i_al.name, i);
+			init_region(memory_region<t_allocator_type> { replicaName, i_al.size_in_bytes, &i_al.allocator_ptr->get_replica(i),
+					i_al.page_size, region_numa_policy::bind_node, i });
+		}
+		i_al.allocator_ptr->set_replica_count(replicaCount);
+	}
+
+	template <class t_allocator_type>
+	void init_region(const growable_memory_region<t_allocator_type>& i_al)
+	{
+		typedef typename t_allocator_type::alloc_scheme_t::alloc_region_t region_t;
+
+		voidptr baseAddress = map_growable_region(i_al);
+
+		register_region(i_al.name, baseAddress, i_al.reserved_bytes, region_page_size::system_default, i_al.allocator_ptr);
+		p_mem_regions[p_mem_regions_count - 1].committed_extractor = &alloc_region_commit_extractor<region_t>::extract_committed;
+		set_numa_placement(p_mem_regions_count - 1, i_al.numa_policy, i_al.numa_node);
+		p_total_mem_in_bytes += i_al.reserved_bytes;
+	}
+
+	// end of recursion
+	template <class t_region>
+	const bool internal_init(t_region i_al)
+	{
+		init_region(i_al);
 
 		// last one, tracking debug info pool
-		s8* nextBase = (s8*)i_baseAddress + i_al.size_in_bytes;
-		internal_init_tracking(nextBase,
-				memory_region<fixed_allocator<pool_scheme, sizeof(debug_entry), no_tracking_policy>> { "helich/tracking", MEMORY_TRACKING_SIZE, &g_tracking_allocator });
+		init_region(memory_region<fixed_allocator<pool_scheme, sizeof(debug_entry), no_tracking_policy>> { "helich/tracking", MEMORY_TRACKING_SIZE, &g_tracking_allocator });
+		// samples are only mapped once, the live ones must survive the initialization of other managers
+		if (g_sample_allocator.get_base_address() == nullptr)
+			init_region(memory_region<fixed_allocator<pool_scheme, sizeof(sample_entry), no_tracking_policy>> { "helich/samples", MEMORY_SAMPLES_SIZE, &g_sample_allocator });
 		return true;
 	}
 
 	// compile-time recursive initialization
-	template <class t_allocator_type_head, class ... t_allocator_type_rests>
-	const bool internal_init(voidptr i_baseAddress,
-		memory_region<t_allocator_type_head> i_headAl,
-		memory_region<t_allocator_type_rests> ... i_restAl)
+	template <class t_region_head, class ... t_region_rests>
+	const bool internal_init(t_region_head i_headAl, t_region_rests ... i_restAl)
 	{
-		typedef typename t_allocator_type_head::alloc_scheme_t scheme_t;
-		typedef typename scheme_t::alloc_region_t region_t;
-
 		// init here
-		((t_allocator_type_head*)(i_headAl.allocator_ptr))->map_to(i_baseAddress, i_headAl.size_in_bytes, i_headAl.name);
-		s8* nextBase = (s8*)i_baseAddress + i_headAl.size_in_bytes;
-
-		strcpy(p_mem_regions[p_mem_regions_count].name, i_headAl.name);
-		p_mem_regions[p_mem_regions_count].size_in_bytes = i_headAl.size_in_bytes;
-		p_mem_regions[p_mem_regions_count].base_address = i_baseAddress;
-		p_mem_regions[p_mem_regions_count].dbg_info_extractor = (dbginfo_extractor_func_t)&alloc_region_dbginfo_extractor<region_t>::extract_info;
-		p_mem_regions[p_mem_regions_count].allocator_ptr = (voidptr)i_headAl.allocator_ptr;
-		p_total_mem_in_bytes += i_headAl.size_in_bytes;
-		p_mem_regions_count++;
+		init_region(i_headAl);
 
 		// recursion
-		return internal_init(nextBase, i_restAl...);
+		return internal_init(i_restAl...);
 	}
 
 private:
-	voidptr                                 	m_base_address;
+	bool										m_initialized;
 
 public:
 	memory_region_info							p_mem_regions[MAX_MEM_REGIONS];
@@ -8,6 +8,27 @@ namespace helich
 {
 // ----------------------------------------------------------------------------
 
+// pages backing a region, huge pages cut the TLB misses of big and hot regions
+// on Linux, huge pages come from MAP_HUGETLB when the system has some reserved, otherwise the region
+// is 2MB / 1GB aligned and advised as transparent huge pages. Other platforms use the system pages
+enum class region_page_size : u8
+{
+	system_default = 0,
+	huge_2mb,
+	huge_1gb
+};
+
+// NUMA placement of a region, set before the region is touched so the pages are faulted in on the right node.
+// node indices count the online nodes in order, whatever their ids, and wrap around. On single-node machines
+// (or without NUMA support) every policy ends up as the system default
+enum class region_numa_policy : u8
+{
+	system_default = 0,
+	bind_node,									// only numa_node
+	prefer_node,								// numa_node first, the others when it is full
+	interleave									// page by page over all nodes
+};
+
 template <class t_allocator_type>
 struct memory_region
 {
@@ -17,15 +38,41 @@ struct memory_region
 	size										size_in_bytes;
 
 	allocator_ptr_t								allocator_ptr;
+	region_page_size							page_size = region_page_size::system_default;
+	region_numa_policy							numa_policy = region_numa_policy::system_default;
+	u32											numa_node = 0;
+};
+
+// reserves reserved_bytes of address space but only commits what the allocator reaches, on system pages
+// so the region can be sized for the peak load. Only for schemes with map_to_reserved() (stack, freelist)
+template <class t_allocator_type>
+struct growable_memory_region
+{
+	typedef t_allocator_type*					allocator_ptr_t;
+
+	const_cstr									name;
+	size										reserved_bytes;
+
+	allocator_ptr_t								allocator_ptr;
+	region_numa_policy							numa_policy = region_numa_policy::system_default;
+	u32											numa_node = 0;
 };
 
 struct memory_region_info
 {
 	c8											name[512];
-	size										size_in_bytes;
+	size										size_in_bytes;			// reserved bytes for growable regions
+	region_page_size							page_size;
+	region_numa_policy							numa_policy;
+	u32											numa_node;
 	voidptr										base_address;
 	voidptr										allocator_ptr;
 	dbginfo_extractor_func_t					dbg_info_extractor;
+	peak_extractor_func_t						peak_extractor;			// nullptr if not available
+	commit_extractor_func_t						committed_extractor;	// nullptr if the region is fully committed
+	trim_func_t									trimmer;
+
+	const size									get_committed_bytes() const						{ return committed_extractor ? committed_extractor(allocator_ptr) : size_in_bytes; }
 };
 
 // ----------------------------------------------------------------------------
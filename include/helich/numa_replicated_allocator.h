@@ -0,0 +1,94 @@
+#pragma once
+
+#include "helich/detail/numa.h"
+
+#include <floral/stdaliases.h>
+#include <floral/assert/assert.h>
+
+namespace helich
+{
+// ----------------------------------------------------------------------------
+
+// one t_allocator per NUMA node, each on memory bound to its node: allocations come from the replica of
+// the calling thread's node, frees go back to the replica owning the address (whichever thread frees).
+// memory_manager maps size_in_bytes for every replica and reports each one as "<name>/node<i>".
+// on a single-node machine there is only one replica
+// eg.
+//	numa_replicated_allocator<fixed_allocator<pool_scheme, sizeof(job)>> g_job_pools;
+//	memory_region<decltype(g_job_pools)> { "jobs", SIZE_MB(4), &g_job_pools }
+template <class t_allocator, u32 t_max_nodes = HL_MAX_NUMA_NODES>
+class numa_replicated_allocator
+{
+	static_assert(t_max_nodes >= 1 && t_max_nodes <= HL_MAX_NUMA_NODES, "Invalid number of NUMA replicas");
+
+public:
+	typedef t_allocator							replica_t;
+
+	static const u32							k_max_replicas = t_max_nodes;
+
+public:
+	numa_replicated_allocator()
+		: m_replica_count(0)
+	{}
+
+	~numa_replicated_allocator()
+	{}
+
+	// memory_manager maps replica 0 .. i_count - 1 before calling this
+	void set_replica_count(const u32 i_count)
+	{
+		FLORAL_ASSERT_MSG(i_count >= 1 && i_count <= t_max_nodes, "Invalid number of NUMA replicas");
+		m_replica_count = i_count;
+	}
+
+	template <class t_object_type, class ... t_params>
+	t_object_type* allocate(t_params... i_params)
+	{
+		return get_local_replica().template allocate<t_object_type>(i_params...);
+	}
+
+	template <class t_object_type>
+	void free(t_object_type* i_objPtr)
+	{
+		get_owner_replica(i_objPtr).free(i_objPtr);
+	}
+
+	void free_all()
+	{
+		for (u32 i = 0; i < m_replica_count; i++)
+			m_replicas[i].free_all();
+	}
+
+	const size trim()
+	{
+		size releasedBytes = 0;
+		for (u32 i = 0; i < m_replica_count; i++)
+			releasedBytes += m_replicas[i].trim();
+		return releasedBytes;
+	}
+
+	replica_t&									get_local_replica()									{ return m_replicas[detail::get_current_numa_node() % m_replica_count]; }
+	replica_t&									get_replica(const u32 i_node)						{ return m_replicas[i_node]; }
+
+	replica_t& get_owner_replica(voidptr i_data)
+	{
+		for (u32 i = 0; i < m_replica_count; i++)
+		{
+			p8 baseAddress = m_replicas[i].get_base_address();
+			if ((p8)i_data >= baseAddress && (p8)i_data < baseAddress + m_replicas[i].get_size_in_bytes())
+				return m_replicas[i];
+		}
+		FLORAL_ASSERT_MSG(false, "Address does not belong to any replica");
+		return m_replicas[0];
+	}
+
+private:
+	replica_t									m_replicas[t_max_nodes];
+	u32											m_replica_count;
+
+public:
+	const u32									get_replica_count() const							{ return m_replica_count; }
+};
+
+// ----------------------------------------------------------------------------
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <floral/stdaliases.h>
+
+namespace helich
+{
+// ----------------------------------------------------------------------------
+
+// rolls a stack allocator back to where it was when the frame was opened, every temporary
+// allocated in between is released at once when the frame goes out of scope.
+// NOTE: no destructor is called for the released objects, keep it to trivially destructible data
+// eg.
+//	{
+//		scoped_stack_frame<stack_allocator_t> frame(g_scratch_allocator);
+//		f32* samples = g_scratch_allocator.allocate_podarray<f32>(1024);
+//		...
+//	} // 'samples' is gone
+
+template <class t_stack_allocator>
+class scoped_stack_frame
+{
+public:
+	typedef typename t_stack_allocator::marker		marker_t;
+
+public:
+	explicit scoped_stack_frame(t_stack_allocator& i_allocator)
+		: m_allocator(i_allocator)
+		, m_marker(i_allocator.get_marker())
+	{}
+
+	~scoped_stack_frame()
+	{
+		m_allocator.free_to_marker(m_marker);
+	}
+
+	scoped_stack_frame(const scoped_stack_frame&) = delete;
+	scoped_stack_frame&								operator=(const scoped_stack_frame&) = delete;
+
+	const marker_t&									get_marker() const							{ return m_marker; }
+
+private:
+	t_stack_allocator&								m_allocator;
+	marker_t										m_marker;
+};
+
+// ----------------------------------------------------------------------------
+}
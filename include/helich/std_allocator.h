@@ -0,0 +1,189 @@
+#pragma once
+
+// std adapters over helich allocators, needs C++17 (<memory_resource>), so it is not part of helich.h
+
+#include "helich/allocator.h"
+
+#include <floral/stdaliases.h>
+#include <floral/assert/assert.h>
+
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace helich
+{
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+template <class t_allocator>
+struct is_fixed_allocator : std::false_type
+{
+};
+
+template <template<size, typename, typename> class t_alloc_scheme, size t_elem_size, class t_tracking_policy, class t_locking_policy>
+struct is_fixed_allocator<fixed_allocator<t_alloc_scheme, t_elem_size, t_tracking_policy, t_locking_policy> > : std::true_type
+{
+};
+
+// schemes which can make use of the size and alignment given back on deallocation provide
+// free_sized(voidptr, size, size), the others get a plain free()
+template <class t_alloc_scheme>
+struct has_sized_free
+{
+	template <class t_scheme>
+	static auto									test(int) -> decltype(std::declval<t_scheme&>().free_sized((voidptr)nullptr, size(0), size(0)), std::true_type());
+	template <class t_scheme>
+	static std::false_type						test(...);
+
+	static const bool							value = decltype(test<t_alloc_scheme>(0))::value;
+};
+
+template <class t_allocator>
+inline voidptr std_allocate(t_allocator& i_allocator, const size i_bytes, const size i_alignment, std::false_type)
+{
+	typename t_allocator::alloc_scheme_t& scheme = i_allocator;
+	return scheme.allocate_aligned(i_bytes, i_alignment);
+}
+
+// pools only serve requests up to their element size, e.g. the nodes of a list or a map
+template <class t_allocator>
+inline voidptr std_allocate(t_allocator& i_allocator, const size i_bytes, const size i_alignment, std::true_type)
+{
+	typename t_allocator::alloc_scheme_t& scheme = i_allocator;
+	FLORAL_ASSERT_MSG(i_bytes <= scheme.get_element_size(), "Request is bigger than the pool's element size");
+	return (i_bytes <= scheme.get_element_size()) ? scheme.allocate_aligned(i_alignment) : nullptr;
+}
+
+template <class t_allocator>
+inline voidptr std_allocate(t_allocator& i_allocator, const size i_bytes, const size i_alignment)
+{
+	return std_allocate(i_allocator, i_bytes, i_alignment, std::integral_constant<bool, is_fixed_allocator<t_allocator>::value>());
+}
+
+template <class t_alloc_scheme>
+inline void std_deallocate(t_alloc_scheme& i_scheme, voidptr i_data, const size i_bytes, const size i_alignment, std::true_type)
+{
+	i_scheme.free_sized(i_data, i_bytes, i_alignment);
+}
+
+template <class t_alloc_scheme>
+inline void std_deallocate(t_alloc_scheme& i_scheme, voidptr i_data, const size i_bytes, const size i_alignment, std::false_type)
+{
+	i_scheme.free(i_data);
+}
+
+template <class t_allocator>
+inline void std_deallocate(t_allocator& i_allocator, voidptr i_data, const size i_bytes, const size i_alignment)
+{
+	typedef typename t_allocator::alloc_scheme_t alloc_scheme_t;
+	alloc_scheme_t& scheme = i_allocator;
+	std_deallocate(scheme, i_data, i_bytes, i_alignment, std::integral_constant<bool, has_sized_free<alloc_scheme_t>::value>());
+}
+
+// ----------------------------------------------------------------------------
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// any allocator<> / fixed_allocator<> as a std::pmr::memory_resource
+// eg.
+//	memory_resource<allocator<freelist_scheme>> resource(&g_freelist_allocator);
+//	std::pmr::unordered_map<u32, entity> entities(&resource);
+// NOTE: like every memory_resource, allocate() throws std::bad_alloc when the region is full
+template <class t_allocator>
+class memory_resource : public std::pmr::memory_resource
+{
+public:
+	explicit memory_resource(t_allocator* i_allocator)
+		: m_allocator(i_allocator)
+	{}
+
+	t_allocator*								get_allocator() const							{ return m_allocator; }
+
+protected:
+	void* do_allocate(std::size_t i_bytes, std::size_t i_alignment) override
+	{
+		voidptr data = detail::std_allocate(*m_allocator, i_bytes, i_alignment);
+		if (data == nullptr)
+			throw std::bad_alloc();
+		return data;
+	}
+
+	void do_deallocate(void* i_data, std::size_t i_bytes, std::size_t i_alignment) override
+	{
+		detail::std_deallocate(*m_allocator, i_data, i_bytes, i_alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& i_other) const noexcept override
+	{
+		return this == &i_other;
+	}
+
+private:
+	t_allocator*								m_allocator;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// stateful STL allocator, just a pointer to the helich allocator: no virtual call, and containers using
+// it are only as big as with std::allocator plus that pointer
+// eg.
+//	std::vector<f32, stl_allocator<f32, allocator<stack_scheme>>> samples(stl_allocator<f32, allocator<stack_scheme>>(&g_scratch));
+template <class t_value_type, class t_allocator>
+class stl_allocator
+{
+public:
+	typedef t_value_type						value_type;
+
+	template <class t_other_type>
+	struct rebind
+	{
+		typedef stl_allocator<t_other_type, t_allocator>	other;
+	};
+
+public:
+	explicit stl_allocator(t_allocator* i_allocator) noexcept
+		: m_allocator(i_allocator)
+	{}
+
+	template <class t_other_type>
+	stl_allocator(const stl_allocator<t_other_type, t_allocator>& i_other) noexcept
+		: m_allocator(i_other.get_allocator())
+	{}
+
+	t_value_type* allocate(const std::size_t i_count)
+	{
+		voidptr data = detail::std_allocate(*m_allocator, sizeof(t_value_type) * i_count, alignof(t_value_type));
+		if (data == nullptr)
+			throw std::bad_alloc();
+		return (t_value_type*)data;
+	}
+
+	void deallocate(t_value_type* i_data, const std::size_t i_count) noexcept
+	{
+		detail::std_deallocate(*m_allocator, i_data, sizeof(t_value_type) * i_count, alignof(t_value_type));
+	}
+
+	t_allocator*								get_allocator() const noexcept					{ return m_allocator; }
+
+private:
+	t_allocator*								m_allocator;
+};
+
+template <class t_value_type, class t_other_type, class t_allocator>
+inline bool operator==(const stl_allocator<t_value_type, t_allocator>& i_lhs, const stl_allocator<t_other_type, t_allocator>& i_rhs) noexcept
+{
+	return i_lhs.get_allocator() == i_rhs.get_allocator();
+}
+
+template <class t_value_type, class t_other_type, class t_allocator>
+inline bool operator!=(const stl_allocator<t_value_type, t_allocator>& i_lhs, const stl_allocator<t_other_type, t_allocator>& i_rhs) noexcept
+{
+	return i_lhs.get_allocator() != i_rhs.get_allocator();
+}
+
+// ----------------------------------------------------------------------------
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <floral/stdaliases.h>
+
+#include "helich/locking_policies.h"
+#include "helich/macros.h"
+
+#include <stdio.h>
+
+namespace helich
+{
+// ----------------------------------------------------------------------------
+
+// every distinct call stack is stored once and referred to by a 32-bit id, along with what is allocated
+// from it: the tracking policies keep an id per allocation instead of a stack of their own.
+// Stacks are hashed into an open-addressing table of HL_MAX_STACK_TRACES entries which is filled up to 3/4,
+// past that new stacks get k_no_trace and are only counted in get_dropped_trace_count()
+// NOTE: the tables are zero-initialized statics, the untouched entries cost no memory
+class trace_table
+{
+public:
+	static const u32							k_no_trace = 0;
+	static const u32							k_capacity = HL_MAX_STACK_TRACES;
+	static const u32							k_max_depth = HL_MAX_STACK_DEPTH;
+
+	static_assert((HL_MAX_STACK_TRACES & (HL_MAX_STACK_TRACES - 1)) == 0, "HL_MAX_STACK_TRACES must be a power of two");
+
+	struct trace
+	{
+		u64										hash;
+		u32										frame_count;			// 0: the entry is free
+		u64										live_count;
+		u64										live_bytes;
+		u64										live_weighted_bytes;	// what the live allocations stand for, more than live_bytes for samples
+		u64										total_count;
+		u64										total_bytes;
+		voidptr									frames[k_max_depth];	// innermost first
+	};
+
+public:
+	constexpr trace_table()
+		: m_lock()
+		, m_trace_count(0)
+		, m_dropped_trace_count(0)
+		, m_traces()
+	{}
+
+	// the stack of the caller of capture(), without its i_skipFrames innermost frames
+	HL_NOINLINE const u32						capture(const u32 i_skipFrames);
+	const u32									intern(const voidptr* i_frames, const u32 i_frameCount);
+
+	// i_weightedBytes is i_bytes when every allocation is recorded
+	void										add_allocation(const u32 i_traceId, const size i_bytes, const size i_weightedBytes);
+	void										remove_allocation(const u32 i_traceId, const size i_bytes, const size i_weightedBytes);
+	// an allocation resized in place, the growth counts in the totals
+	void										resize_allocation(const u32 i_traceId, const size i_oldBytes, const size i_newBytes,
+													const size i_oldWeightedBytes, const size i_newWeightedBytes);
+
+	// one "outermost;...;innermost <live weighted bytes>" line per stack which still holds memory, the input
+	// of flamegraph.pl and most flame graph tools
+	void										write_folded_stacks(FILE* o_file);
+	// legacy pprof heap profile (text), readable by 'pprof' and 'go tool pprof' with the binary.
+	// i_samplePeriod is the mean sampling interval in bytes, 0 when every allocation is recorded
+	void										write_pprof_heap(FILE* o_file, const size i_samplePeriod);
+
+	// false for k_no_trace or an unknown id
+	const bool									get_trace(const u32 i_traceId, trace& o_trace);
+	const u32									get_trace_count();
+	const u64									get_dropped_trace_count();
+
+private:
+	const u32									find_or_insert(const u64 i_hash, const voidptr* i_frames, const u32 i_frameCount);
+
+private:
+	spinlock									m_lock;
+	u32											m_trace_count;
+	u64											m_dropped_trace_count;
+	trace										m_traces[k_capacity];
+};
+
+extern trace_table								g_tracked_traces;			// default_tracking_policy
+extern trace_table								g_sampled_traces;			// sampled_tracking_policy
+
+// ----------------------------------------------------------------------------
+}
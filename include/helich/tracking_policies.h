@@ -2,6 +2,8 @@
 
 #include "alloc_headers.h"
 #include "alloc_schemes.h"
+#include "macros.h"
+#include "trace_table.h"
 
 #include <floral/stdaliases.h>
 
@@ -14,17 +16,29 @@ struct debug_entry
 	voidptr										address;
 	size										size_in_bytes;
 	c8											description[128];
-	c8											stack_trace[2048];
+	u32											trace_id;				// in g_tracked_traces, trace_table::k_no_trace if none
 };
 
 class default_tracking_policy
 {
 public:
 	typedef tracked_alloc_header				alloc_header_t;
+	typedef full_header_layout					header_layout_t;
+
+	// every allocation owns a debug entry, so bulk releases must unregister them one by one
+	static const bool							k_tracks_allocations = true;
 
 public:
 	static void									register_allocation(voidptr i_dataAddr, const size i_bytes, const_cstr i_desc, const_cstr i_file, const u32 i_line);
 	static void									unregister_allocation(voidptr i_ptr);
+	// reallocate() in place: the allocation keeps its entry and stack
+	static void									resize_allocation(voidptr i_ptr, const size i_newBytes);
+
+	// batched versions for bulk allocations, the tracking pool is locked once per batch.
+	// the header of i_ptrs[i] is at i_ptrs[i] - i_headerOffset
+	static void									register_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset, const size i_bytes,
+													const_cstr i_desc, const_cstr i_file, const u32 i_line);
+	static void									unregister_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset);
 
 private:
 	static u32									m_num_alloc;
@@ -36,10 +50,114 @@ class no_tracking_policy
 {
 public:
 	typedef untracked_alloc_header				alloc_header_t;
+	typedef full_header_layout					header_layout_t;
+
+	static const bool							k_tracks_allocations = false;
 
 public:
 	static void									register_allocation(voidptr i_dataAddr, const size i_bytes, const_cstr i_desc, const_cstr i_file, const u32 i_line)	{}
 	static void									unregister_allocation(voidptr i_ptr)																			{}
+	static void									resize_allocation(voidptr i_ptr, const size i_newBytes)														{}
+
+	static void									register_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset, const size i_bytes,
+													const_cstr i_desc, const_cstr i_file, const u32 i_line)										{}
+	static void									unregister_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset)						{}
+};
+
+// one per sampled allocation, see sampled_tracking_policy
+struct sample_entry
+{
+	sample_entry*								next_sample;
+	sample_entry*								prev_sample;
+	voidptr										address;
+	size										size_in_bytes;
+	size										sampled_bytes;			// allocated bytes this sample stands for, unbiased estimate
+	u32											trace_id;				// in g_sampled_traces
+	c8											description[64];
+};
+
+// Light enough to stay on in production: about one allocated byte in get_sample_interval() is sampled,
+// the gaps between two samples are drawn from an exponential distribution (per thread), so every byte has
+// the same chance to be picked no matter the size of its allocation. A sample weighs s / (1 - e^(-s / interval))
+// bytes, which keeps the sum of the live samples an unbiased estimate of the live bytes.
+// The allocations which are not sampled cost a countdown on allocation and a null check on free.
+// Samples are kept in their own pool ("helich/samples"), when it is full the sample is dropped and counted
+// in get_dropped_sample_count(). The stacks of the samples go to g_sampled_traces, whose pprof export
+// should be given get_sample_interval() as its sample period
+
+class sampled_tracking_policy
+{
+public:
+	typedef sampled_alloc_header				alloc_header_t;
+	typedef full_header_layout					header_layout_t;
+
+	// sampled allocations own an entry, bulk releases must look at them one by one
+	static const bool							k_tracks_allocations = true;
+
+public:
+	static void register_allocation(voidptr i_dataAddr, const size i_bytes, const_cstr i_desc, const_cstr i_file, const u32 i_line)
+	{
+		alloc_header_t* memHeader = (alloc_header_t*)i_dataAddr;
+		memHeader->sample_info = nullptr;
+		// one access to the thread local, the compiler has to go through its wrapper every time
+		s64& bytesUntilSample = m_bytes_until_sample;
+		bytesUntilSample -= (s64)i_bytes;
+		if (bytesUntilSample <= 0)
+			memHeader->sample_info = take_sample(i_dataAddr, i_bytes, i_desc);
+	}
+
+	static void unregister_allocation(voidptr i_ptr)
+	{
+		alloc_header_t* memHeader = (alloc_header_t*)i_ptr;
+		if (memHeader->sample_info)
+		{
+			release_sample(memHeader->sample_info);
+			memHeader->sample_info = nullptr;
+		}
+	}
+
+	// reallocate() in place: a sample follows the new size, the allocation is not sampled again
+	static void resize_allocation(voidptr i_ptr, const size i_newBytes)
+	{
+		alloc_header_t* memHeader = (alloc_header_t*)i_ptr;
+		if (memHeader->sample_info)
+			resize_sample(memHeader->sample_info, i_newBytes);
+	}
+
+	static void									register_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset, const size i_bytes,
+													const_cstr i_desc, const_cstr i_file, const u32 i_line);
+	static void									unregister_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset);
+
+	// also restarts the countdown of the calling thread, the other threads pick it up after their next sample
+	static void									set_sample_interval(const size i_bytes);
+	static const size							get_sample_interval();
+
+	// snapshot of the live samples, returns how many were copied (at most i_maxCount)
+	static const u32							copy_live_samples(sample_entry* o_samples, const u32 i_maxCount);
+	static const u32							get_live_sample_count();
+	// sum of the live samples' weights
+	static const size							get_estimated_live_bytes();
+	static const u64							get_dropped_sample_count();
+
+private:
+	static sample_entry*						take_sample(voidptr i_dataAddr, const size i_bytes, const_cstr i_desc);
+	static void									release_sample(sample_entry* i_sample);
+	static void									resize_sample(sample_entry* i_sample, const size i_newBytes);
+
+private:
+	static thread_local s64						m_bytes_until_sample;
+};
+
+// Switches any tracking policy to the compact header layout: no description and no live-allocation
+// list in the allocation headers. Descriptions still reach the tracking policy, so with
+// default_tracking_policy they live out-of-band in the tracking pool's debug entries.
+// eg. fixed_allocator<pool_scheme, 27, compact_header_policy<no_tracking_policy>>
+
+template <class t_tracking_policy>
+class compact_header_policy : public t_tracking_policy
+{
+public:
+	typedef compact_header_layout				header_layout_t;
 };
 
 // ----------------------------------------------------------------------------
@@ -4,11 +4,71 @@
 
 #include <floral/stdaliases.h>
 
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
 namespace helich
 {
 // ----------------------------------------------------------------------------
 
-voidptr											align_address(voidptr i_addr, size i_alignment = HL_ALIGNMENT);
+// i_alignment must be a power of two
+constexpr bool is_power_of_two(const size i_value)
+{
+	return i_value != 0 && (i_value & (i_value - 1)) == 0;
+}
+
+// round up to the next multiple of i_alignment, an already aligned value is returned as is
+constexpr size align_size(const size i_value, const size i_alignment)
+{
+	return (i_value + i_alignment - 1) & ~(i_alignment - 1);
+}
+
+constexpr size max_alignment(const size i_a, const size i_b)
+{
+	return i_a > i_b ? i_a : i_b;
+}
+
+// largest power of two dividing i_size, capped at i_limit: every element of an array of
+// i_size-byte elements keeps this alignment
+constexpr size natural_alignment(const size i_size, const size i_limit)
+{
+	return (i_size != 0 && (i_size & (~i_size + 1)) < i_limit) ? (i_size & (~i_size + 1)) : i_limit;
+}
+
+inline voidptr align_address(voidptr i_addr, const size i_alignment = HL_ALIGNMENT)
+{
+	return (voidptr)(((aptr)i_addr + i_alignment - 1) & ~(aptr)(i_alignment - 1));
+}
+
+// compile-time log2 of a power of two
+constexpr u32 static_log2(const size i_value)
+{
+	return (i_value <= 1) ? 0 : 1 + static_log2(i_value >> 1);
+}
+
+// index of the lowest / highest set bit, i_value must not be 0
+inline u32 bit_scan_forward(const u64 i_value)
+{
+#if defined(_MSC_VER)
+	unsigned long idx = 0;
+	_BitScanForward64(&idx, i_value);
+	return (u32)idx;
+#else
+	return (u32)__builtin_ctzll(i_value);
+#endif
+}
+
+inline u32 bit_scan_reverse(const u64 i_value)
+{
+#if defined(_MSC_VER)
+	unsigned long idx = 0;
+	_BitScanReverse64(&idx, i_value);
+	return (u32)idx;
+#else
+	return (u32)(63 - __builtin_clzll(i_value));
+#endif
+}
 
 // ----------------------------------------------------------------------------
 }
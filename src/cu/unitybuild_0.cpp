@@ -1,4 +1,7 @@
 #include "src/memory_manager.cpp"
 #include "src/memory_map.cpp"
+#include "src/numa.cpp"
+#include "src/stack_trace.cpp"
+#include "src/thread_slot.cpp"
+#include "src/trace_table.cpp"
 #include "src/tracking_policies.cpp"
-#include "src/utils.cpp"
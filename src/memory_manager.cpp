@@ -1,11 +1,14 @@
 #include "helich/memory_manager.h"
 
 #include "helich/memory_map.h"
+#include "helich/utils.h"
 
 #if defined(FLORAL_PLATFORM_WINDOWS)
 #	include <Windows.h>
 #	include <iostream>
 #else
+#	include <sys/mman.h>
+#	include <unistd.h>
 #endif
 
 namespace helich
@@ -13,7 +16,9 @@ namespace helich
 // ----------------------------------------------------------------------------
 
 memory_manager::memory_manager()
-	: m_base_address(nullptr)
+	: m_initialized(false)
+	, p_mem_regions_count(0)
+	, p_total_mem_in_bytes(0)
 {
 
 }
@@ -23,27 +28,159 @@ memory_manager::~memory_manager()
 
 }
 
-const voidptr memory_manager::allocate_global_memory(voidptr i_baseAddress, const size i_sizeInBytes)
+const size get_system_page_size()
 {
 #if defined(FLORAL_PLATFORM_WINDOWS)
+	SYSTEM_INFO sysInfo;
+	GetSystemInfo(&sysInfo);
+	return (size)sysInfo.dwPageSize;
+#else
+	static const size s_pageSize = (size)sysconf(_SC_PAGESIZE);
+	return s_pageSize;
+#endif
+}
+
+const size purge_pages(voidptr i_address, const size i_sizeInBytes)
+{
+	const size pageSize = get_system_page_size();
+	aptr begin = align_size((aptr)i_address, pageSize);
+	aptr end = ((aptr)i_address + i_sizeInBytes) & ~(aptr)(pageSize - 1);
+	if (end <= begin)
+		return 0;
+
+#if defined(FLORAL_PLATFORM_WINDOWS)
+	// MEM_RESET: the content may be dropped instead of paged out, the pages are reused on the next write
+	if (VirtualAlloc((LPVOID)begin, end - begin, MEM_RESET, PAGE_READWRITE) == nullptr)
+		return 0;
+#else
+	// MADV_DONTNEED rather than MADV_FREE: the pages leave the RSS right away
+	if (madvise((voidptr)begin, end - begin, MADV_DONTNEED) != 0)
+		return 0;
+#endif
+	return (size)(end - begin);
+}
+
+const size memory_manager::get_page_size_in_bytes(const region_page_size i_pageSize)
+{
+	switch (i_pageSize)
+	{
+	case region_page_size::huge_2mb:
+		return SIZE_MB(2);
+	case region_page_size::huge_1gb:
+		return SIZE_GB(1);
+	default:
+		break;
+	}
+
+	return get_system_page_size();
+}
+
+#if !defined(FLORAL_PLATFORM_WINDOWS)
+// explicit huge pages first, they only exist when the system has a reserved hugetlb pool
+static voidptr map_hugetlb_pages(const size i_sizeInBytes, const region_page_size i_pageSize)
+{
+#	if defined(MAP_HUGETLB)
+	s32 flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#		if defined(MAP_HUGE_2MB) && defined(MAP_HUGE_1GB)
+	flags |= (i_pageSize == region_page_size::huge_1gb) ? MAP_HUGE_1GB : MAP_HUGE_2MB;
+#		endif
+	voidptr addr = mmap(nullptr, i_sizeInBytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (addr != MAP_FAILED)
+		return addr;
+#	endif
+	return nullptr;
+}
+
+// no hugetlb pool: map a huge page aligned range and ask for transparent huge pages
+static voidptr map_transparent_huge_pages(const size i_sizeInBytes, const size i_pageBytes)
+{
+	const size reservedBytes = i_sizeInBytes + i_pageBytes;
+	voidptr addr = mmap(nullptr, reservedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED)
+		return nullptr;
+
+	// give back the unaligned head and the tail
+	p8 rawBase = (p8)addr;
+	p8 alignedBase = (p8)align_address(addr, i_pageBytes);
+	const size headBytes = (size)(alignedBase - rawBase);
+	const size tailBytes = reservedBytes - headBytes - i_sizeInBytes;
+	if (headBytes > 0)
+		munmap(rawBase, headBytes);
+	if (tailBytes > 0)
+		munmap(alignedBase + i_sizeInBytes, tailBytes);
+
+#	if defined(MADV_HUGEPAGE)
+	madvise(alignedBase, i_sizeInBytes, MADV_HUGEPAGE);
+#	endif
+	return alignedBase;
+}
+#endif
+
+const voidptr memory_manager::allocate_global_memory(voidptr i_baseAddress, const size i_sizeInBytes,
+		const region_page_size i_pageSize /* = region_page_size::system_default */)
+{
+#if defined(FLORAL_PLATFORM_WINDOWS)
+	// large pages need SeLockMemoryPrivilege, Windows regions stay on system pages
 	voidptr addr = (voidptr)VirtualAlloc((LPVOID)i_baseAddress,
 		i_sizeInBytes,
 		MEM_COMMIT | MEM_RESERVE,
 		PAGE_READWRITE);
 #else
-	voidptr addr = (voidptr)malloc(i_sizeInBytes);
+	const size pageBytes = get_page_size_in_bytes(i_pageSize);
+	const size mappedBytes = align_size(i_sizeInBytes, pageBytes);
+	voidptr addr = nullptr;
+
+	if (i_pageSize == region_page_size::system_default)
+	{
+		addr = mmap(i_baseAddress, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (addr == MAP_FAILED)
+			addr = nullptr;
+	}
+	else
+	{
+		addr = map_hugetlb_pages(mappedBytes, i_pageSize);
+		if (!addr)
+			addr = map_transparent_huge_pages(mappedBytes, pageBytes);
+	}
+#endif
+	return addr;
+}
+
+// address space only, nothing is backed by memory until commit_global_memory()
+const voidptr memory_manager::reserve_global_memory(const size i_sizeInBytes)
+{
+#if defined(FLORAL_PLATFORM_WINDOWS)
+	voidptr addr = (voidptr)VirtualAlloc(nullptr, i_sizeInBytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+	const size mappedBytes = align_size(i_sizeInBytes, get_page_size_in_bytes(region_page_size::system_default));
+	voidptr addr = mmap(nullptr, mappedBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (addr == MAP_FAILED)
+		addr = nullptr;
 #endif
 	return addr;
 }
 
-void memory_manager::free_global_memory(voidptr i_baseAddress, const size i_sizeInBytes)
+bool memory_manager::commit_global_memory(voidptr i_address, const size i_sizeInBytes)
+{
+#if defined(FLORAL_PLATFORM_WINDOWS)
+	return VirtualAlloc((LPVOID)i_address, i_sizeInBytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+	return mprotect(i_address, i_sizeInBytes, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+void memory_manager::free_global_memory(voidptr i_baseAddress, const size i_sizeInBytes,
+		const region_page_size i_pageSize /* = region_page_size::system_default */)
 {
 #if defined(FLORAL_PLATFORM_WINDOWS)
 	BOOL result = VirtualFree((LPVOID)i_baseAddress, 0, MEM_RELEASE);
 	const DWORD error = GetLastError();
 	FLORAL_ASSERT(result != 0);
 #else
-	free(i_baseAddress);
+	// same rounding as the mapping, whichever huge page path it took
+	const size mappedBytes = align_size(i_sizeInBytes, get_page_size_in_bytes(i_pageSize));
+	s32 result = munmap(i_baseAddress, mappedBytes);
+	FLORAL_ASSERT(result == 0);
 #endif
 }
 
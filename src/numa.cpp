@@ -0,0 +1,170 @@
+#include "helich/detail/numa.h"
+
+#if defined(__linux__)
+#	include <stdio.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+namespace helich
+{
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+static_assert(HL_MAX_NUMA_NODES > 0 && HL_MAX_NUMA_NODES <= 64, "HL_MAX_NUMA_NODES must be in [1, 64]");
+
+#if defined(__linux__)
+// <numaif.h> comes with libnuma, the syscalls and their modes are all we need
+static const s32								k_mpol_preferred = 1;
+static const s32								k_mpol_bind = 2;
+static const s32								k_mpol_interleave = 3;
+
+// the online nodes, at most HL_MAX_NUMA_NODES of them (the lowest ids). Their ids need not be contiguous,
+// node indices are positions in this mask
+struct numa_topology
+{
+	u64											online_mask;
+	u32											node_count;
+	u32											node_ids[HL_MAX_NUMA_NODES];
+};
+
+static const numa_topology read_numa_topology()
+{
+	numa_topology topology = {};
+	// "possible" also lists the nodes which may be hot-plugged later, they have no memory to bind to
+	FILE* nodeFile = fopen("/sys/devices/system/node/online", "r");
+	if (nodeFile)
+	{
+		c8 nodeList[256];
+		if (fgets(nodeList, sizeof(nodeList), nodeFile))
+			topology.online_mask = parse_numa_node_list(nodeList);
+		fclose(nodeFile);
+	}
+
+	for (u32 nodeId = 0; nodeId < 64 && topology.node_count < HL_MAX_NUMA_NODES; nodeId++)
+	{
+		if (topology.online_mask & ((u64)1 << nodeId))
+			topology.node_ids[topology.node_count++] = nodeId;
+	}
+
+	// no NUMA support: node 0 only
+	if (topology.node_count == 0)
+		topology.node_count = 1;
+	topology.online_mask = 0;
+	for (u32 i = 0; i < topology.node_count; i++)
+		topology.online_mask |= (u64)1 << topology.node_ids[i];
+	return topology;
+}
+
+static const numa_topology& get_numa_topology()
+{
+	static const numa_topology s_topology = read_numa_topology();
+	return s_topology;
+}
+
+static const u32 read_current_numa_node()
+{
+	unsigned cpu = 0, node = 0;
+	if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+		return 0;
+
+	// the index of the node among the online ones
+	const numa_topology& topology = get_numa_topology();
+	for (u32 i = 0; i < topology.node_count; i++)
+	{
+		if (topology.node_ids[i] == (u32)node)
+			return i;
+	}
+	return 0;
+}
+#endif
+
+// sysfs range list: "0", "0-3", "0,2-3" ...
+const u64 parse_numa_node_list(const_cstr i_list)
+{
+	u64 nodeMask = 0;
+	const_cstr c = i_list;
+	while (*c)
+	{
+		if (*c < '0' || *c > '9')
+		{
+			c++;
+			continue;
+		}
+
+		u32 firstNode = 0;
+		while (*c >= '0' && *c <= '9')
+			firstNode = firstNode * 10 + (u32)(*c++ - '0');
+		u32 lastNode = firstNode;
+		if (*c == '-')
+		{
+			c++;
+			lastNode = 0;
+			while (*c >= '0' && *c <= '9')
+				lastNode = lastNode * 10 + (u32)(*c++ - '0');
+		}
+
+		// mbind() takes 64 nodes at most here
+		for (u32 nodeId = firstNode; nodeId <= lastNode && nodeId < 64; nodeId++)
+			nodeMask |= (u64)1 << nodeId;
+	}
+	return nodeMask;
+}
+
+const u32 get_numa_node_count()
+{
+#if defined(__linux__)
+	return get_numa_topology().node_count;
+#else
+	return 1;
+#endif
+}
+
+const u32 get_current_numa_node()
+{
+#if defined(__linux__)
+	static thread_local const u32 s_node = read_current_numa_node();
+	return s_node;
+#else
+	return 0;
+#endif
+}
+
+const bool apply_numa_policy(voidptr i_address, const size i_sizeInBytes,
+		const region_numa_policy i_policy, const u32 i_node)
+{
+	const u32 nodeCount = get_numa_node_count();
+	if (i_policy == region_numa_policy::system_default || nodeCount < 2)
+		return false;
+
+#if defined(__linux__)
+	const numa_topology& topology = get_numa_topology();
+	unsigned long nodeMask = 0;
+	s32 mode = k_mpol_bind;
+	switch (i_policy)
+	{
+	case region_numa_policy::bind_node:
+		nodeMask = 1ul << topology.node_ids[i_node % nodeCount];
+		break;
+	case region_numa_policy::prefer_node:
+		mode = k_mpol_preferred;
+		nodeMask = 1ul << topology.node_ids[i_node % nodeCount];
+		break;
+	default:
+		mode = k_mpol_interleave;
+		nodeMask = (unsigned long)topology.online_mask;
+		break;
+	}
+
+	// the kernel reads maxnode - 1 bits
+	const unsigned long maxNode = sizeof(nodeMask) * 8 + 1;
+	return syscall(SYS_mbind, i_address, i_sizeInBytes, mode, &nodeMask, maxNode, 0) == 0;
+#else
+	return false;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+}
+}
@@ -0,0 +1,469 @@
+#include "helich/global_override.h"
+
+#include "helich/memory_manager.h"
+#include "helich/allocator.h"
+#include "helich/alloc_schemes.h"
+#include "helich/locking_policies.h"
+#include "helich/tracking_policies.h"
+#include "helich/utils.h"
+
+#include <floral/assert/assert.h>
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HL_GLOBAL_OVERRIDE_MALLOC)
+#	if !defined(__GLIBC__)
+#		error "HL_GLOBAL_OVERRIDE_MALLOC relies on glibc's __libc_* entry points"
+#	endif
+#	include <dlfcn.h>
+#	include <errno.h>
+#	include <unistd.h>
+
+// the allocator glibc would have used, for the fallbacks and for the memory handed out before us
+extern "C" void*								__libc_malloc(size_t i_bytes);
+extern "C" void*								__libc_memalign(size_t i_alignment, size_t i_bytes);
+extern "C" void*								__libc_realloc(void* i_data, size_t i_bytes);
+extern "C" void									__libc_free(void* i_data);
+#endif
+
+#if defined(FLORAL_PLATFORM_WINDOWS)
+#	include <malloc.h>
+#endif
+
+// malloc may be called before the thread's dynamic TLS exists, keep the thread state in the static TLS block
+#if defined(__GNUC__)
+#	define HL_INITIAL_EXEC_TLS					__attribute__((tls_model("initial-exec")))
+#else
+#	define HL_INITIAL_EXEC_TLS
+#endif
+
+namespace helich
+{
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+// untracked, so the headers only keep what free() and the usable size need: malloc(16) takes 16 bytes
+typedef allocator<slab_scheme, compact_header_policy<no_tracking_policy>>		global_small_allocator_t;
+typedef allocator<freelist_scheme, compact_header_policy<no_tracking_policy>>	global_large_allocator_t;
+
+static const size								k_default_alignment = alignof(std::max_align_t);
+
+enum class global_regions_state : u32
+{
+	unmapped = 0,
+	mapping,
+	ready,
+	failed
+};
+
+// never destroyed: memory is freed until the very end of the process, after the static destructors too
+struct global_default_regions
+{
+	memory_manager								manager;
+	global_small_allocator_t					small_allocator;
+	global_large_allocator_t					large_allocator;
+	global_region								small_region;
+	global_region								large_region;
+};
+
+alignas(global_default_regions) static u8		s_default_regions_storage[sizeof(global_default_regions)];
+static global_default_regions*					s_default_regions = nullptr;
+static std::atomic<global_regions_state>		s_default_regions_state(global_regions_state::unmapped);
+
+static global_region							s_registered_regions[HL_MAX_GLOBAL_REGIONS];
+static std::atomic<u32>							s_registered_region_count(0);
+static spinlock									s_register_lock;
+
+static thread_local const global_region*		s_thread_region HL_INITIAL_EXEC_TLS = nullptr;
+
+static std::atomic<u64>							s_small_allocs(0);
+static std::atomic<u64>							s_large_allocs(0);
+static std::atomic<u64>							s_region_allocs(0);
+static std::atomic<u64>							s_system_allocs(0);
+static std::atomic<u64>							s_frees(0);
+
+//////////////////////////////////////////////////////////////////////////
+
+static voidptr system_allocate(const size i_bytes, const size i_alignment)
+{
+	s_system_allocs.fetch_add(1, std::memory_order_relaxed);
+#if defined(HL_GLOBAL_OVERRIDE_MALLOC)
+	return (i_alignment <= k_default_alignment) ? __libc_malloc(i_bytes) : __libc_memalign(i_alignment, i_bytes);
+#elif defined(FLORAL_PLATFORM_WINDOWS)
+	// every fallback is aligned, so every fallback is released the same way
+	return _aligned_malloc(i_bytes ? i_bytes : 1, max_alignment(i_alignment, k_default_alignment));
+#else
+	if (i_alignment <= k_default_alignment)
+		return ::malloc(i_bytes);
+	voidptr data = nullptr;
+	return (posix_memalign(&data, i_alignment, i_bytes) == 0) ? data : nullptr;
+#endif
+}
+
+static void system_free(voidptr i_data)
+{
+#if defined(HL_GLOBAL_OVERRIDE_MALLOC)
+	__libc_free(i_data);
+#elif defined(FLORAL_PLATFORM_WINDOWS)
+	_aligned_free(i_data);
+#else
+	::free(i_data);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// the first thread getting here maps the default regions, the others use the system allocator meanwhile.
+// So do the requests made by the mapping itself
+static const bool map_default_regions()
+{
+	global_regions_state state = s_default_regions_state.load(std::memory_order_acquire);
+	if (state == global_regions_state::ready)
+		return true;
+	if (state != global_regions_state::unmapped
+		|| !s_default_regions_state.compare_exchange_strong(state, global_regions_state::mapping, std::memory_order_acq_rel))
+	{
+		return s_default_regions_state.load(std::memory_order_acquire) == global_regions_state::ready;
+	}
+
+	global_default_regions* regions = new (s_default_regions_storage) global_default_regions();
+	// only these two: initialize() would map the tracking and sample pools too, which untracked regions never use
+	memory_region<global_small_allocator_t> smallRegion { "helich/global/small", HL_GLOBAL_SMALL_REGION_SIZE, &regions->small_allocator };
+	growable_memory_region<global_large_allocator_t> largeRegion { "helich/global/large", HL_GLOBAL_LARGE_REGION_SIZE, &regions->large_allocator };
+	regions->manager.initialize_allocator(smallRegion);
+	regions->manager.initialize_allocator(largeRegion);
+
+	const bool mapped = regions->small_allocator.get_base_address() != nullptr && regions->large_allocator.get_base_address() != nullptr;
+	if (mapped)
+	{
+		regions->small_region = make_global_region("helich/global/small", &regions->small_allocator);
+		regions->large_region = make_global_region("helich/global/large", &regions->large_allocator);
+		s_default_regions = regions;
+	}
+	s_default_regions_state.store(mapped ? global_regions_state::ready : global_regions_state::failed, std::memory_order_release);
+	return mapped;
+}
+
+static inline const bool is_in_region(const global_region& i_region, voidptr i_data)
+{
+	return (p8)i_data >= i_region.base_address && (p8)i_data < i_region.base_address + i_region.size_in_bytes;
+}
+
+// nullptr: the system allocator's
+static const global_region* find_owner_region(voidptr i_data)
+{
+	if (s_default_regions_state.load(std::memory_order_acquire) == global_regions_state::ready)
+	{
+		if (is_in_region(s_default_regions->small_region, i_data))
+			return &s_default_regions->small_region;
+		if (is_in_region(s_default_regions->large_region, i_data))
+			return &s_default_regions->large_region;
+	}
+
+	const u32 regionCount = s_registered_region_count.load(std::memory_order_acquire);
+	for (u32 i = 0; i < regionCount; i++)
+	{
+		if (is_in_region(s_registered_regions[i], i_data))
+			return &s_registered_regions[i];
+	}
+	return nullptr;
+}
+
+static voidptr global_allocate(const size i_bytes, const size i_alignment)
+{
+	const size alignment = max_alignment(i_alignment, k_default_alignment);
+
+	const global_region* threadRegion = s_thread_region;
+	if (threadRegion)
+	{
+		voidptr data = threadRegion->allocate_func(threadRegion->allocator_ptr, i_bytes, alignment);
+		if (data)
+		{
+			s_region_allocs.fetch_add(1, std::memory_order_relaxed);
+			return data;
+		}
+	}
+
+	if (map_default_regions())
+	{
+		// the slab classes are at most cache line aligned
+		if (i_bytes <= global_small_allocator_t::k_max_small_size && alignment <= HL_CACHE_LINE_SIZE)
+		{
+			voidptr data = s_default_regions->small_allocator.allocate_aligned(i_bytes, alignment);
+			if (data)
+			{
+				s_small_allocs.fetch_add(1, std::memory_order_relaxed);
+				return data;
+			}
+		}
+
+		voidptr data = s_default_regions->large_allocator.allocate_aligned(i_bytes, alignment);
+		if (data)
+		{
+			s_large_allocs.fetch_add(1, std::memory_order_relaxed);
+			return data;
+		}
+	}
+
+	return system_allocate(i_bytes, alignment);
+}
+
+static void global_free(voidptr i_data)
+{
+	if (i_data == nullptr)
+		return;
+
+	s_frees.fetch_add(1, std::memory_order_relaxed);
+	const global_region* ownerRegion = find_owner_region(i_data);
+	if (ownerRegion)
+		ownerRegion->free_func(ownerRegion->allocator_ptr, i_data);
+	else system_free(i_data);
+}
+
+#if defined(HL_GLOBAL_OVERRIDE_MALLOC)
+// stays in place while the block is big enough and not more than twice as big as needed
+static voidptr global_reallocate(voidptr i_data, const size i_bytes)
+{
+	if (i_data == nullptr)
+		return global_allocate(i_bytes, k_default_alignment);
+
+	const global_region* ownerRegion = find_owner_region(i_data);
+	if (ownerRegion == nullptr)
+		return __libc_realloc(i_data, i_bytes);
+
+	const size usableBytes = ownerRegion->usable_size_func(ownerRegion->allocator_ptr, i_data);
+	if (i_bytes <= usableBytes && i_bytes >= usableBytes / 2)
+		return i_data;
+
+	voidptr newData = global_allocate(i_bytes, k_default_alignment);
+	if (newData)
+	{
+		memcpy(newData, i_data, (i_bytes < usableBytes) ? i_bytes : usableBytes);
+		global_free(i_data);
+	}
+	return newData;
+}
+
+// glibc only exports malloc_usable_size() itself, which is the one replaced here
+static const size system_usable_size(voidptr i_data)
+{
+	typedef size_t (*usable_size_func_t)(void*);
+	static const usable_size_func_t s_usableSizeFunc = (usable_size_func_t)dlsym(RTLD_NEXT, "malloc_usable_size");
+	return s_usableSizeFunc ? s_usableSizeFunc(i_data) : 0;
+}
+
+static const size global_usable_size(voidptr i_data)
+{
+	if (i_data == nullptr)
+		return 0;
+	const global_region* ownerRegion = find_owner_region(i_data);
+	return ownerRegion ? ownerRegion->usable_size_func(ownerRegion->allocator_ptr, i_data) : system_usable_size(i_data);
+}
+#endif
+
+static voidptr global_new(const size i_bytes, const size i_alignment)
+{
+	while (true)
+	{
+		voidptr data = global_allocate(i_bytes, i_alignment);
+		if (data)
+			return data;
+
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr)
+			throw std::bad_alloc();
+		handler();
+	}
+}
+
+// ----------------------------------------------------------------------------
+}
+
+const global_region* register_global_region(const global_region& i_region)
+{
+	scoped_lock<spinlock> registerGuard(detail::s_register_lock);
+	const u32 regionIndex = detail::s_registered_region_count.load(std::memory_order_relaxed);
+	if (regionIndex == HL_MAX_GLOBAL_REGIONS)
+		return nullptr;
+
+	detail::s_registered_regions[regionIndex] = i_region;
+	detail::s_registered_region_count.store(regionIndex + 1, std::memory_order_release);
+	return &detail::s_registered_regions[regionIndex];
+}
+
+void set_thread_global_region(const global_region* i_region)
+{
+	// free() only recognizes the allocations of registered regions
+	FLORAL_ASSERT_MSG(i_region == nullptr
+		|| (i_region >= detail::s_registered_regions
+			&& i_region < detail::s_registered_regions + detail::s_registered_region_count.load(std::memory_order_acquire)),
+		"The region must be the one returned by register_global_region()");
+	detail::s_thread_region = i_region;
+}
+
+const global_region* get_thread_global_region()
+{
+	return detail::s_thread_region;
+}
+
+const global_override_stats get_global_override_stats()
+{
+	global_override_stats stats;
+	stats.small_allocs = detail::s_small_allocs.load(std::memory_order_relaxed);
+	stats.large_allocs = detail::s_large_allocs.load(std::memory_order_relaxed);
+	stats.region_allocs = detail::s_region_allocs.load(std::memory_order_relaxed);
+	stats.system_allocs = detail::s_system_allocs.load(std::memory_order_relaxed);
+	stats.frees = detail::s_frees.load(std::memory_order_relaxed);
+	return stats;
+}
+
+// ----------------------------------------------------------------------------
+}
+
+//////////////////////////////////////////////////////////////////////////
+// global operator new / delete
+
+void* operator new(std::size_t i_bytes)
+{
+	return helich::detail::global_new(i_bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t i_bytes)
+{
+	return helich::detail::global_new(i_bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t i_bytes, const std::nothrow_t&) noexcept
+{
+	return helich::detail::global_allocate(i_bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t i_bytes, const std::nothrow_t&) noexcept
+{
+	return helich::detail::global_allocate(i_bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* i_data) noexcept										{ helich::detail::global_free(i_data); }
+void operator delete[](void* i_data) noexcept									{ helich::detail::global_free(i_data); }
+void operator delete(void* i_data, const std::nothrow_t&) noexcept				{ helich::detail::global_free(i_data); }
+void operator delete[](void* i_data, const std::nothrow_t&) noexcept			{ helich::detail::global_free(i_data); }
+void operator delete(void* i_data, std::size_t) noexcept						{ helich::detail::global_free(i_data); }
+void operator delete[](void* i_data, std::size_t) noexcept						{ helich::detail::global_free(i_data); }
+
+#if defined(__cpp_aligned_new)
+void* operator new(std::size_t i_bytes, std::align_val_t i_alignment)
+{
+	return helich::detail::global_new(i_bytes, (size)i_alignment);
+}
+
+void* operator new[](std::size_t i_bytes, std::align_val_t i_alignment)
+{
+	return helich::detail::global_new(i_bytes, (size)i_alignment);
+}
+
+void* operator new(std::size_t i_bytes, std::align_val_t i_alignment, const std::nothrow_t&) noexcept
+{
+	return helich::detail::global_allocate(i_bytes, (size)i_alignment);
+}
+
+void* operator new[](std::size_t i_bytes, std::align_val_t i_alignment, const std::nothrow_t&) noexcept
+{
+	return helich::detail::global_allocate(i_bytes, (size)i_alignment);
+}
+
+void operator delete(void* i_data, std::align_val_t) noexcept								{ helich::detail::global_free(i_data); }
+void operator delete[](void* i_data, std::align_val_t) noexcept								{ helich::detail::global_free(i_data); }
+void operator delete(void* i_data, std::align_val_t, const std::nothrow_t&) noexcept		{ helich::detail::global_free(i_data); }
+void operator delete[](void* i_data, std::align_val_t, const std::nothrow_t&) noexcept		{ helich::detail::global_free(i_data); }
+void operator delete(void* i_data, std::size_t, std::align_val_t) noexcept					{ helich::detail::global_free(i_data); }
+void operator delete[](void* i_data, std::size_t, std::align_val_t) noexcept				{ helich::detail::global_free(i_data); }
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// malloc & co., see "Replacing malloc" in the glibc manual for the set of functions
+
+#if defined(HL_GLOBAL_OVERRIDE_MALLOC)
+extern "C"
+{
+
+void* malloc(size_t i_bytes)
+{
+	return helich::detail::global_allocate(i_bytes, helich::detail::k_default_alignment);
+}
+
+void free(void* i_data)
+{
+	helich::detail::global_free(i_data);
+}
+
+void* calloc(size_t i_count, size_t i_elemSize)
+{
+	if (i_elemSize != 0 && i_count > (size_t)-1 / i_elemSize)
+	{
+		errno = ENOMEM;
+		return nullptr;
+	}
+
+	// region blocks are recycled, they are not zeroed like fresh pages
+	const size_t bytes = i_count * i_elemSize;
+	void* data = helich::detail::global_allocate(bytes, helich::detail::k_default_alignment);
+	if (data)
+		memset(data, 0, bytes);
+	return data;
+}
+
+void* realloc(void* i_data, size_t i_bytes)
+{
+	return helich::detail::global_reallocate(i_data, i_bytes);
+}
+
+void* memalign(size_t i_alignment, size_t i_bytes)
+{
+	if (!helich::is_power_of_two(i_alignment))
+	{
+		errno = EINVAL;
+		return nullptr;
+	}
+	return helich::detail::global_allocate(i_bytes, i_alignment);
+}
+
+void* aligned_alloc(size_t i_alignment, size_t i_bytes)
+{
+	return memalign(i_alignment, i_bytes);
+}
+
+int posix_memalign(void** o_data, size_t i_alignment, size_t i_bytes)
+{
+	if (!helich::is_power_of_two(i_alignment) || i_alignment % sizeof(void*) != 0)
+		return EINVAL;
+
+	void* data = helich::detail::global_allocate(i_bytes, i_alignment);
+	if (data == nullptr)
+		return ENOMEM;
+	*o_data = data;
+	return 0;
+}
+
+void* valloc(size_t i_bytes)
+{
+	return helich::detail::global_allocate(i_bytes, (size)sysconf(_SC_PAGESIZE));
+}
+
+void* pvalloc(size_t i_bytes)
+{
+	const size pageSize = (size)sysconf(_SC_PAGESIZE);
+	return helich::detail::global_allocate(helich::align_size(i_bytes ? i_bytes : 1, pageSize), pageSize);
+}
+
+size_t malloc_usable_size(void* i_data)
+{
+	return helich::detail::global_usable_size(i_data);
+}
+
+}
+#endif
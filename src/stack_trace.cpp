@@ -0,0 +1,120 @@
+#include "helich/detail/stack_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(FLORAL_PLATFORM_WINDOWS)
+#	include <Windows.h>
+#else
+#	include <cxxabi.h>
+#	include <dlfcn.h>
+#	if !defined(HL_FRAME_POINTER_STACKS)
+#		include <unwind.h>
+#	endif
+#endif
+
+namespace helich
+{
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+#if !defined(FLORAL_PLATFORM_WINDOWS) && !defined(HL_FRAME_POINTER_STACKS)
+struct unwind_state
+{
+	voidptr*									frames;
+	u32											max_frames;
+	u32											skip_frames;
+	u32											frame_count;
+};
+
+static _Unwind_Reason_Code collect_frame(_Unwind_Context* i_context, void* io_state)
+{
+	unwind_state* state = (unwind_state*)io_state;
+	const aptr returnAddr = (aptr)_Unwind_GetIP(i_context);
+	if (returnAddr == 0)
+		return _URC_END_OF_STACK;
+
+	if (state->skip_frames > 0)
+	{
+		state->skip_frames--;
+		return _URC_NO_REASON;
+	}
+
+	state->frames[state->frame_count++] = (voidptr)returnAddr;
+	return (state->frame_count == state->max_frames) ? _URC_END_OF_STACK : _URC_NO_REASON;
+}
+#endif
+
+HL_NOINLINE const u32 capture_stack_trace(voidptr* o_frames, const u32 i_maxFrames, const u32 i_skipFrames)
+{
+	if (i_maxFrames == 0)
+		return 0;
+
+#if defined(FLORAL_PLATFORM_WINDOWS)
+	return (u32)RtlCaptureStackBackTrace((DWORD)(i_skipFrames + 1), (DWORD)i_maxFrames, o_frames, nullptr);
+#elif defined(HL_FRAME_POINTER_STACKS)
+	// [frame] is the caller's frame pointer, [frame + 1] the return address into the caller
+	voidptr* frame = (voidptr*)__builtin_frame_address(0);
+	u32 skipFrames = i_skipFrames;
+	u32 frameCount = 0;
+	while (frame && frameCount < i_maxFrames)
+	{
+		voidptr returnAddr = frame[1];
+		if (returnAddr == nullptr)
+			break;
+		if (skipFrames > 0)
+			skipFrames--;
+		else
+			o_frames[frameCount++] = returnAddr;
+
+		// the stack grows down: the callers' frames are above this one and not absurdly far,
+		// anything else is code built without frame pointers
+		voidptr* nextFrame = (voidptr*)frame[0];
+		if (nextFrame <= frame || (size)((p8)nextFrame - (p8)frame) > SIZE_MB(1) || ((aptr)nextFrame & (sizeof(voidptr) - 1)) != 0)
+			break;
+		frame = nextFrame;
+	}
+	return frameCount;
+#else
+	// the unwinder starts in this very function
+	unwind_state state = { o_frames, i_maxFrames, i_skipFrames + 1, 0 };
+	_Unwind_Backtrace(&collect_frame, &state);
+	return state.frame_count;
+#endif
+}
+
+void describe_frame(voidptr i_frame, c8* o_buffer, const size i_bufferSize)
+{
+#if defined(FLORAL_PLATFORM_WINDOWS)
+	snprintf(o_buffer, i_bufferSize, "0x%llx", (unsigned long long)(aptr)i_frame);
+#else
+	// a return address may already be the first instruction of the next function, look up the call itself
+	Dl_info info;
+	if (dladdr((p8)i_frame - 1, &info) == 0)
+	{
+		snprintf(o_buffer, i_bufferSize, "0x%llx", (unsigned long long)(aptr)i_frame);
+		return;
+	}
+
+	if (info.dli_sname)
+	{
+		s32 status = 0;
+		c8* demangledName = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+		snprintf(o_buffer, i_bufferSize, "%s+0x%llx", (status == 0 && demangledName) ? demangledName : info.dli_sname,
+			(unsigned long long)((p8)i_frame - (p8)info.dli_saddr));
+		free(demangledName);
+		return;
+	}
+
+	const_cstr moduleName = info.dli_fname ? info.dli_fname : "?";
+	const_cstr lastSlash = strrchr(moduleName, '/');
+	snprintf(o_buffer, i_bufferSize, "%s+0x%llx", lastSlash ? lastSlash + 1 : moduleName,
+		(unsigned long long)((p8)i_frame - (p8)info.dli_fbase));
+#endif
+}
+
+// ----------------------------------------------------------------------------
+}
+}
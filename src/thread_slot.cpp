@@ -0,0 +1,61 @@
+#include "helich/detail/thread_slot.h"
+
+#include "helich/utils.h"
+
+#include <atomic>
+
+namespace helich
+{
+namespace detail
+{
+// ----------------------------------------------------------------------------
+
+static_assert(HL_MAX_THREAD_CACHES > 0 && HL_MAX_THREAD_CACHES <= 64, "HL_MAX_THREAD_CACHES must be in [1, 64]");
+
+static std::atomic<u64>							s_used_thread_slots(0);
+
+static const u32 acquire_thread_slot()
+{
+	const u64 slotsMask = (HL_MAX_THREAD_CACHES == 64) ? ~(u64)0 : (((u64)1 << HL_MAX_THREAD_CACHES) - 1);
+	u64 usedSlots = s_used_thread_slots.load(std::memory_order_relaxed);
+	while (true)
+	{
+		u64 freeSlots = ~usedSlots & slotsMask;
+		if (freeSlots == 0)
+			return HL_MAX_THREAD_CACHES;
+
+		u32 slot = bit_scan_forward(freeSlots);
+		if (s_used_thread_slots.compare_exchange_weak(usedSlots, usedSlots | ((u64)1 << slot), std::memory_order_acquire))
+			return slot;
+	}
+}
+
+static void release_thread_slot(const u32 i_slot)
+{
+	if (i_slot < HL_MAX_THREAD_CACHES)
+		s_used_thread_slots.fetch_and(~((u64)1 << i_slot), std::memory_order_release);
+}
+
+struct thread_slot_holder
+{
+	thread_slot_holder()
+		: slot(acquire_thread_slot())
+	{ }
+
+	~thread_slot_holder()
+	{
+		release_thread_slot(slot);
+	}
+
+	const u32									slot;
+};
+
+const u32 get_thread_slot()
+{
+	static thread_local thread_slot_holder s_holder;
+	return s_holder.slot;
+}
+
+// ----------------------------------------------------------------------------
+}
+}
@@ -0,0 +1,228 @@
+#include "helich/trace_table.h"
+
+#include "helich/detail/stack_trace.h"
+
+#include <string.h>
+
+namespace helich
+{
+// ----------------------------------------------------------------------------
+
+trace_table										g_tracked_traces;
+trace_table										g_sampled_traces;
+
+// FNV-1a over the frame addresses
+static const u64 hash_frames(const voidptr* i_frames, const u32 i_frameCount)
+{
+	u64 hash = 0xcbf29ce484222325ull;
+	for (u32 i = 0; i < i_frameCount; i++)
+	{
+		u64 frame = (u64)(aptr)i_frames[i];
+		for (u32 b = 0; b < sizeof(frame); b++)
+		{
+			hash ^= (frame & 0xff);
+			hash *= 0x100000001b3ull;
+			frame >>= 8;
+		}
+	}
+	return hash;
+}
+
+HL_NOINLINE const u32 trace_table::capture(const u32 i_skipFrames)
+{
+	voidptr frames[k_max_depth];
+	// skip capture() itself too
+	const u32 frameCount = detail::capture_stack_trace(frames, k_max_depth, i_skipFrames + 1);
+	return intern(frames, frameCount);
+}
+
+const u32 trace_table::intern(const voidptr* i_frames, const u32 i_frameCount)
+{
+	if (i_frameCount == 0)
+		return k_no_trace;
+
+	const u32 frameCount = (i_frameCount < k_max_depth) ? i_frameCount : k_max_depth;
+	const u64 hash = hash_frames(i_frames, frameCount);
+	scoped_lock<spinlock> tableGuard(m_lock);
+	return find_or_insert(hash, i_frames, frameCount);
+}
+
+const u32 trace_table::find_or_insert(const u64 i_hash, const voidptr* i_frames, const u32 i_frameCount)
+{
+	u32 index = (u32)i_hash & (k_capacity - 1);
+	while (m_traces[index].frame_count != 0)
+	{
+		const trace& currTrace = m_traces[index];
+		if (currTrace.hash == i_hash && currTrace.frame_count == i_frameCount
+			&& memcmp(currTrace.frames, i_frames, i_frameCount * sizeof(voidptr)) == 0)
+		{
+			return index + 1;
+		}
+		index = (index + 1) & (k_capacity - 1);
+	}
+
+	// keep the probe sequences short
+	if (m_trace_count >= k_capacity / 4 * 3)
+	{
+		m_dropped_trace_count++;
+		return k_no_trace;
+	}
+
+	trace& newTrace = m_traces[index];
+	newTrace.hash = i_hash;
+	newTrace.frame_count = i_frameCount;
+	newTrace.live_count = 0;
+	newTrace.live_bytes = 0;
+	newTrace.live_weighted_bytes = 0;
+	newTrace.total_count = 0;
+	newTrace.total_bytes = 0;
+	memcpy(newTrace.frames, i_frames, i_frameCount * sizeof(voidptr));
+	m_trace_count++;
+	return index + 1;
+}
+
+void trace_table::add_allocation(const u32 i_traceId, const size i_bytes, const size i_weightedBytes)
+{
+	if (i_traceId == k_no_trace)
+		return;
+
+	scoped_lock<spinlock> tableGuard(m_lock);
+	trace& allocTrace = m_traces[i_traceId - 1];
+	allocTrace.live_count++;
+	allocTrace.live_bytes += i_bytes;
+	allocTrace.live_weighted_bytes += i_weightedBytes;
+	allocTrace.total_count++;
+	allocTrace.total_bytes += i_bytes;
+}
+
+void trace_table::remove_allocation(const u32 i_traceId, const size i_bytes, const size i_weightedBytes)
+{
+	if (i_traceId == k_no_trace)
+		return;
+
+	scoped_lock<spinlock> tableGuard(m_lock);
+	trace& allocTrace = m_traces[i_traceId - 1];
+	allocTrace.live_count--;
+	allocTrace.live_bytes -= i_bytes;
+	allocTrace.live_weighted_bytes -= i_weightedBytes;
+}
+
+void trace_table::resize_allocation(const u32 i_traceId, const size i_oldBytes, const size i_newBytes,
+		const size i_oldWeightedBytes, const size i_newWeightedBytes)
+{
+	if (i_traceId == k_no_trace)
+		return;
+
+	scoped_lock<spinlock> tableGuard(m_lock);
+	trace& allocTrace = m_traces[i_traceId - 1];
+	allocTrace.live_bytes = allocTrace.live_bytes - i_oldBytes + i_newBytes;
+	allocTrace.live_weighted_bytes = allocTrace.live_weighted_bytes - i_oldWeightedBytes + i_newWeightedBytes;
+	if (i_newBytes > i_oldBytes)
+		allocTrace.total_bytes += i_newBytes - i_oldBytes;
+}
+
+const bool trace_table::get_trace(const u32 i_traceId, trace& o_trace)
+{
+	if (i_traceId == k_no_trace || i_traceId > k_capacity)
+		return false;
+
+	scoped_lock<spinlock> tableGuard(m_lock);
+	if (m_traces[i_traceId - 1].frame_count == 0)
+		return false;
+	o_trace = m_traces[i_traceId - 1];
+	return true;
+}
+
+const u32 trace_table::get_trace_count()
+{
+	scoped_lock<spinlock> tableGuard(m_lock);
+	return m_trace_count;
+}
+
+const u64 trace_table::get_dropped_trace_count()
+{
+	scoped_lock<spinlock> tableGuard(m_lock);
+	return m_dropped_trace_count;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// exports: the traces are copied out one at a time, the table is not locked while symbols are looked up
+// and the file is written (both may allocate, and allocations may be tracked)
+
+void trace_table::write_folded_stacks(FILE* o_file)
+{
+	c8 frameName[512];
+	trace currTrace;
+	for (u32 i = 1; i <= k_capacity; i++)
+	{
+		if (!get_trace(i, currTrace) || currTrace.live_weighted_bytes == 0)
+			continue;
+
+		for (u32 f = currTrace.frame_count; f > 0; f--)
+		{
+			detail::describe_frame(currTrace.frames[f - 1], frameName, sizeof(frameName));
+			// ';' separates the frames and the last ' ' the value
+			for (c8* c = frameName; *c; c++)
+			{
+				if (*c == ';')
+					*c = ':';
+			}
+			fprintf(o_file, (f == currTrace.frame_count) ? "%s" : ";%s", frameName);
+		}
+		fprintf(o_file, " %llu\n", (unsigned long long)currTrace.live_weighted_bytes);
+	}
+}
+
+void trace_table::write_pprof_heap(FILE* o_file, const size i_samplePeriod)
+{
+	// the header line has the totals
+	u64 liveCount = 0, liveBytes = 0, totalCount = 0, totalBytes = 0;
+	{
+		scoped_lock<spinlock> tableGuard(m_lock);
+		for (u32 i = 0; i < k_capacity; i++)
+		{
+			liveCount += m_traces[i].live_count;
+			liveBytes += m_traces[i].live_bytes;
+			totalCount += m_traces[i].total_count;
+			totalBytes += m_traces[i].total_bytes;
+		}
+	}
+
+	// heap_v2: pprof scales the samples back up itself
+	fprintf(o_file, "heap profile: %llu: %llu [%llu: %llu] @ ", (unsigned long long)liveCount, (unsigned long long)liveBytes,
+		(unsigned long long)totalCount, (unsigned long long)totalBytes);
+	if (i_samplePeriod > 0)
+		fprintf(o_file, "heap_v2/%llu\n", (unsigned long long)i_samplePeriod);
+	else
+		fprintf(o_file, "heap\n");
+
+	trace currTrace;
+	for (u32 i = 1; i <= k_capacity; i++)
+	{
+		if (!get_trace(i, currTrace) || currTrace.total_count == 0)
+			continue;
+
+		fprintf(o_file, "%llu: %llu [%llu: %llu] @", (unsigned long long)currTrace.live_count, (unsigned long long)currTrace.live_bytes,
+			(unsigned long long)currTrace.total_count, (unsigned long long)currTrace.total_bytes);
+		for (u32 f = 0; f < currTrace.frame_count; f++)
+			fprintf(o_file, " 0x%llx", (unsigned long long)(aptr)currTrace.frames[f]);
+		fprintf(o_file, "\n");
+	}
+
+	// pprof maps the addresses back to the binaries with this
+#if defined(__linux__)
+	FILE* mapsFile = fopen("/proc/self/maps", "r");
+	if (mapsFile)
+	{
+		fprintf(o_file, "\nMAPPED_LIBRARIES:\n");
+		c8 buffer[4096];
+		size readBytes = 0;
+		while ((readBytes = fread(buffer, 1, sizeof(buffer), mapsFile)) > 0)
+			fwrite(buffer, 1, readBytes, o_file);
+		fclose(mapsFile);
+	}
+#endif
+}
+
+// ----------------------------------------------------------------------------
+}
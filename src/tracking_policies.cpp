@@ -1,7 +1,10 @@
 #include "helich/tracking_policies.h"
 
 #include "helich/allocator.h"
+#include "helich/locking_policies.h"
 
+#include <atomic>
+#include <cmath>
 #include <cstring>
 
 namespace helich
@@ -9,12 +12,26 @@ namespace helich
 // ----------------------------------------------------------------------------
 
 fixed_allocator<pool_scheme, sizeof(debug_entry), no_tracking_policy> g_tracking_allocator;
+fixed_allocator<pool_scheme, sizeof(sample_entry), no_tracking_policy> g_sample_allocator;
 
 //////////////////////////////////////////////////////////////////////////
 // Default Tracking Policy
 
 u32 default_tracking_policy::m_num_alloc = 0;
 
+// debug entries are reserved this many at a time by the batched functions
+static const u32								k_tracking_batch_size = 64;
+
+static void fill_debug_entry(debug_entry* o_entry, voidptr i_dataAddr, const size i_bytes, const_cstr i_desc, const u32 i_traceId)
+{
+	// populate allocation information
+	strcpy(o_entry->description, i_desc);
+	o_entry->size_in_bytes = i_bytes;
+	o_entry->address = i_dataAddr;
+	o_entry->trace_id = i_traceId;
+	g_tracked_traces.add_allocation(i_traceId, i_bytes, i_bytes);
+}
+
 void default_tracking_policy::register_allocation(voidptr i_dataAddr, const size i_bytes, const_cstr i_desc, const_cstr i_file, const u32 i_line)
 {
 	// get memory header
@@ -22,17 +39,7 @@ void default_tracking_policy::register_allocation(voidptr i_dataAddr, const size
 
 	// allocate new TrackingEntry
 	debug_entry* newEntry = g_tracking_allocator.allocate<debug_entry>();
-
-	// populate allocation information
-	strcpy(newEntry->description, i_desc);
-	newEntry->size_in_bytes = i_bytes;
-	newEntry->address = i_dataAddr;
-	newEntry->stack_trace[0] = 0;
-#if defined(FLORAL_PLATFORM_WINDOWS)
-	floral::get_stack_trace(newEntry->stack_trace);
-#elif defined(PLATFORM_POSIX)
-	// TODO: add
-#endif
+	fill_debug_entry(newEntry, i_dataAddr, i_bytes, i_desc, g_tracked_traces.capture(0));
 
 	// update memory header info
 	memHeader->debug_info = newEntry;
@@ -40,18 +47,240 @@ void default_tracking_policy::register_allocation(voidptr i_dataAddr, const size
 	m_num_alloc++;
 }
 
+void default_tracking_policy::register_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset, const size i_bytes,
+		const_cstr i_desc, const_cstr i_file, const u32 i_line)
+{
+	// the whole batch comes from the same call
+	const u32 traceId = g_tracked_traces.capture(0);
+	voidptr newEntries[k_tracking_batch_size];
+	for (u32 first = 0; first < i_count; first += k_tracking_batch_size)
+	{
+		const u32 batchCount = (i_count - first < k_tracking_batch_size) ? (i_count - first) : k_tracking_batch_size;
+		const u32 entryCount = g_tracking_allocator.allocate_bulk(batchCount, newEntries);
+		FLORAL_ASSERT_MSG(entryCount == batchCount, "Tracking pool is full");
+
+		for (u32 i = 0; i < entryCount; i++)
+		{
+			alloc_header_t* memHeader = (alloc_header_t*)((p8)i_ptrs[first + i] - i_headerOffset);
+			fill_debug_entry((debug_entry*)newEntries[i], memHeader, i_bytes, i_desc, traceId);
+			memHeader->debug_info = (debug_entry*)newEntries[i];
+		}
+		m_num_alloc += entryCount;
+	}
+}
+
+void default_tracking_policy::unregister_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset)
+{
+	voidptr oldEntries[k_tracking_batch_size];
+	for (u32 first = 0; first < i_count; first += k_tracking_batch_size)
+	{
+		const u32 batchCount = (i_count - first < k_tracking_batch_size) ? (i_count - first) : k_tracking_batch_size;
+		for (u32 i = 0; i < batchCount; i++)
+		{
+			alloc_header_t* memHeader = (alloc_header_t*)((p8)i_ptrs[first + i] - i_headerOffset);
+			debug_entry* oldEntry = memHeader->debug_info;
+			g_tracked_traces.remove_allocation(oldEntry->trace_id, oldEntry->size_in_bytes, oldEntry->size_in_bytes);
+			oldEntries[i] = oldEntry;
+			memHeader->debug_info = nullptr;
+		}
+		g_tracking_allocator.free_bulk(oldEntries, batchCount);
+		m_num_alloc -= batchCount;
+	}
+}
+
 void default_tracking_policy::unregister_allocation(voidptr i_ptr)
 {
 	// get memory header
 	alloc_header_t* memHeader = (alloc_header_t*)i_ptr;
 
 	// and free tracking info
-	g_tracking_allocator.free(memHeader->debug_info);
+	debug_entry* oldEntry = memHeader->debug_info;
+	g_tracked_traces.remove_allocation(oldEntry->trace_id, oldEntry->size_in_bytes, oldEntry->size_in_bytes);
+	g_tracking_allocator.free(oldEntry);
 
 	memHeader->debug_info = nullptr;
 
 	m_num_alloc--;
 }
 
+void default_tracking_policy::resize_allocation(voidptr i_ptr, const size i_newBytes)
+{
+	alloc_header_t* memHeader = (alloc_header_t*)i_ptr;
+	debug_entry* entry = memHeader->debug_info;
+	g_tracked_traces.resize_allocation(entry->trace_id, entry->size_in_bytes, i_newBytes, entry->size_in_bytes, i_newBytes);
+	entry->size_in_bytes = i_newBytes;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Sampled Tracking Policy
+
+thread_local s64 sampled_tracking_policy::m_bytes_until_sample = 0;
+
+static std::atomic<size>						s_sample_interval(HL_SAMPLE_INTERVAL);
+static std::atomic<u64>							s_sampler_seed(0);
+static std::atomic<u64>							s_dropped_samples(0);
+static thread_local u64							s_sampler_state = 0;
+
+// live samples, only touched on the sampled path
+static spinlock									s_samples_lock;
+static sample_entry*							s_first_sample = nullptr;
+static u32										s_live_sample_count = 0;
+static size										s_live_sampled_bytes = 0;
+
+// splitmix64 seeds, xorshift64* draws
+static const u64 next_sampler_random()
+{
+	if (s_sampler_state == 0)
+	{
+		u64 seed = (s_sampler_seed.fetch_add(1, std::memory_order_relaxed) + 1) * 0x9e3779b97f4a7c15ull;
+		seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ull;
+		seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebull;
+		s_sampler_state = (seed ^ (seed >> 31)) | 1;
+	}
+
+	s_sampler_state ^= s_sampler_state >> 12;
+	s_sampler_state ^= s_sampler_state << 25;
+	s_sampler_state ^= s_sampler_state >> 27;
+	return s_sampler_state * 0x2545f4914f6cdd1dull;
+}
+
+// exponentially distributed, the mean is the sample interval
+static const s64 draw_sample_gap(const size i_interval)
+{
+	// uniform in (0, 1]
+	const f64 uniform = (f64)((next_sampler_random() >> 11) + 1) * (1.0 / 9007199254740992.0);
+	const f64 gap = -std::log(uniform) * (f64)i_interval;
+	return (gap < 1.0) ? 1 : (s64)gap;
+}
+
+// an allocation of s bytes is sampled with a probability of 1 - e^(-s / interval), its sample weighs s / that
+static const size get_sample_weight(const size i_bytes, const size i_interval)
+{
+	const f64 sampleProbability = 1.0 - std::exp(-(f64)i_bytes / (f64)i_interval);
+	return (sampleProbability > 0.0) ? (size)((f64)i_bytes / sampleProbability + 0.5) : i_bytes;
+}
+
+sample_entry* sampled_tracking_policy::take_sample(voidptr i_dataAddr, const size i_bytes, const_cstr i_desc)
+{
+	const size interval = s_sample_interval.load(std::memory_order_relaxed);
+
+	// the first allocation of a thread only starts its countdown
+	if (s_sampler_state == 0)
+	{
+		m_bytes_until_sample = draw_sample_gap(interval) - (s64)i_bytes;
+		if (m_bytes_until_sample > 0)
+			return nullptr;
+	}
+
+	// the gaps are memoryless, the next one can start from here whatever the overshoot
+	m_bytes_until_sample = draw_sample_gap(interval);
+
+	// unwinding is the slow part, not under the lock
+	const u32 traceId = g_sampled_traces.capture(0);
+
+	scoped_lock<spinlock> samplesGuard(s_samples_lock);
+	sample_entry* newSample = g_sample_allocator.allocate<sample_entry>();
+	if (newSample == nullptr)
+	{
+		s_dropped_samples.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	newSample->address = i_dataAddr;
+	newSample->size_in_bytes = i_bytes;
+	newSample->sampled_bytes = get_sample_weight(i_bytes, interval);
+	newSample->trace_id = traceId;
+	g_sampled_traces.add_allocation(traceId, i_bytes, newSample->sampled_bytes);
+	strncpy(newSample->description, i_desc, sizeof(newSample->description) - 1);
+	newSample->description[sizeof(newSample->description) - 1] = 0;
+
+	newSample->prev_sample = nullptr;
+	newSample->next_sample = s_first_sample;
+	if (s_first_sample)
+		s_first_sample->prev_sample = newSample;
+	s_first_sample = newSample;
+	s_live_sample_count++;
+	s_live_sampled_bytes += newSample->sampled_bytes;
+	return newSample;
+}
+
+void sampled_tracking_policy::release_sample(sample_entry* i_sample)
+{
+	scoped_lock<spinlock> samplesGuard(s_samples_lock);
+	if (i_sample->prev_sample)
+		i_sample->prev_sample->next_sample = i_sample->next_sample;
+	else
+		s_first_sample = i_sample->next_sample;
+	if (i_sample->next_sample)
+		i_sample->next_sample->prev_sample = i_sample->prev_sample;
+
+	s_live_sample_count--;
+	s_live_sampled_bytes -= i_sample->sampled_bytes;
+	g_sampled_traces.remove_allocation(i_sample->trace_id, i_sample->size_in_bytes, i_sample->sampled_bytes);
+	g_sample_allocator.free(i_sample);
+}
+
+void sampled_tracking_policy::resize_sample(sample_entry* i_sample, const size i_newBytes)
+{
+	const size newSampledBytes = get_sample_weight(i_newBytes, s_sample_interval.load(std::memory_order_relaxed));
+
+	scoped_lock<spinlock> samplesGuard(s_samples_lock);
+	s_live_sampled_bytes = s_live_sampled_bytes - i_sample->sampled_bytes + newSampledBytes;
+	g_sampled_traces.resize_allocation(i_sample->trace_id, i_sample->size_in_bytes, i_newBytes, i_sample->sampled_bytes, newSampledBytes);
+	i_sample->size_in_bytes = i_newBytes;
+	i_sample->sampled_bytes = newSampledBytes;
+}
+
+void sampled_tracking_policy::register_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset, const size i_bytes,
+		const_cstr i_desc, const_cstr i_file, const u32 i_line)
+{
+	for (u32 i = 0; i < i_count; i++)
+		register_allocation((p8)i_ptrs[i] - i_headerOffset, i_bytes, i_desc, i_file, i_line);
+}
+
+void sampled_tracking_policy::unregister_allocations(voidptr* i_ptrs, const u32 i_count, const size i_headerOffset)
+{
+	for (u32 i = 0; i < i_count; i++)
+		unregister_allocation((p8)i_ptrs[i] - i_headerOffset);
+}
+
+void sampled_tracking_policy::set_sample_interval(const size i_bytes)
+{
+	const size interval = (i_bytes > 0) ? i_bytes : 1;
+	s_sample_interval.store(interval, std::memory_order_relaxed);
+	m_bytes_until_sample = draw_sample_gap(interval);
+}
+
+const size sampled_tracking_policy::get_sample_interval()
+{
+	return s_sample_interval.load(std::memory_order_relaxed);
+}
+
+const u32 sampled_tracking_policy::copy_live_samples(sample_entry* o_samples, const u32 i_maxCount)
+{
+	scoped_lock<spinlock> samplesGuard(s_samples_lock);
+	u32 copiedCount = 0;
+	for (sample_entry* sample = s_first_sample; sample && copiedCount < i_maxCount; sample = sample->next_sample)
+		o_samples[copiedCount++] = *sample;
+	return copiedCount;
+}
+
+const u32 sampled_tracking_policy::get_live_sample_count()
+{
+	scoped_lock<spinlock> samplesGuard(s_samples_lock);
+	return s_live_sample_count;
+}
+
+const size sampled_tracking_policy::get_estimated_live_bytes()
+{
+	scoped_lock<spinlock> samplesGuard(s_samples_lock);
+	return s_live_sampled_bytes;
+}
+
+const u64 sampled_tracking_policy::get_dropped_sample_count()
+{
+	return s_dropped_samples.load(std::memory_order_relaxed);
+}
+
 // ----------------------------------------------------------------------------
 }
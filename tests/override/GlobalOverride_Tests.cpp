@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <helich.h>
+#include <helich/global_override.h>
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HL_GLOBAL_OVERRIDE_MALLOC)
+#	include <malloc.h>
+#endif
+
+using namespace helich;
+
+// linked against helich_global_override: every allocation of this executable goes through it
+
+typedef allocator<freelist_scheme, compact_header_policy<no_tracking_policy>>	LevelAllocator;
+
+static memory_manager														s_OverrideMemoryManager;
+static LevelAllocator														s_LevelAllocator;
+static const global_region*													s_LevelRegion = nullptr;
+
+class GlobalOverride_Test : public testing::Test {
+protected:
+	virtual void SetUp() {
+		s_OverrideMemoryManager.initialize(
+			memory_region<LevelAllocator> { "override/level", SIZE_KB(64), &s_LevelAllocator }
+		);
+		// registered regions are kept for the lifetime of the process
+		if (s_LevelRegion == nullptr) {
+			s_LevelRegion = register_global_region(make_global_region("override/level", &s_LevelAllocator));
+		}
+	}
+};
+
+static bool IsInLevelRegion(voidptr i_data)
+{
+	return (p8)i_data >= s_LevelAllocator.get_base_address()
+		&& (p8)i_data < s_LevelAllocator.get_base_address() + s_LevelAllocator.get_size_in_bytes();
+}
+
+TEST_F(GlobalOverride_Test, New_And_Delete_Use_The_Default_Regions)
+{
+	const global_override_stats before = get_global_override_stats();
+	c8* smallData = new c8[64];
+	const global_override_stats afterSmall = get_global_override_stats();
+	c8* largeData = new c8[SIZE_KB(64)];
+	const global_override_stats afterLarge = get_global_override_stats();
+	delete[] smallData;
+	delete[] largeData;
+	const global_override_stats afterDelete = get_global_override_stats();
+
+	EXPECT_EQ(afterSmall.small_allocs, before.small_allocs + 1);
+	EXPECT_EQ(afterSmall.large_allocs, before.large_allocs);
+	EXPECT_EQ(afterLarge.large_allocs, before.large_allocs + 1);
+	EXPECT_EQ(afterLarge.small_allocs, before.small_allocs + 1);
+	EXPECT_EQ(afterLarge.system_allocs, before.system_allocs);
+	EXPECT_EQ(afterDelete.frees, before.frees + 2);
+}
+
+#if defined(HL_GLOBAL_OVERRIDE_MALLOC)
+TEST_F(GlobalOverride_Test, Reallocate_In_Place_Or_Copy)
+{
+	p8 data = (p8)malloc(100);
+	ASSERT_NE(data, nullptr);
+	memset(data, 0x3c, 100);
+	const size usableBytes = malloc_usable_size(data);
+	EXPECT_GE(usableBytes, 100u);
+
+	// still fits and not more than twice as big as needed: stays
+	const global_override_stats before = get_global_override_stats();
+	EXPECT_EQ(realloc(data, usableBytes), data);
+	EXPECT_EQ(realloc(data, usableBytes / 2 + 1), data);
+	const global_override_stats afterInPlace = get_global_override_stats();
+	EXPECT_EQ(afterInPlace.small_allocs, before.small_allocs);
+	EXPECT_EQ(afterInPlace.frees, before.frees);
+
+	// growing past the block copies
+	p8 grownData = (p8)realloc(data, usableBytes * 4);
+	ASSERT_NE(grownData, nullptr);
+	EXPECT_NE(grownData, data);
+	EXPECT_EQ(grownData[0], 0x3c);
+	EXPECT_EQ(grownData[99], 0x3c);
+
+	// so does shrinking well below half of it
+	const size grownBytes = malloc_usable_size(grownData);
+	p8 shrunkData = (p8)realloc(grownData, 16);
+	ASSERT_NE(shrunkData, nullptr);
+	EXPECT_NE(shrunkData, grownData);
+	EXPECT_LT(malloc_usable_size(shrunkData), grownBytes);
+	EXPECT_EQ(shrunkData[15], 0x3c);
+	free(shrunkData);
+}
+#endif
+
+TEST_F(GlobalOverride_Test, Scoped_Region_Redirects_And_Falls_Back)
+{
+	ASSERT_NE(s_LevelRegion, nullptr);
+	c8* levelData = nullptr;
+	c8* fallbackData = nullptr;
+	global_override_stats before, afterLevel, afterFallback;
+	{
+		scoped_global_region redirect(s_LevelRegion);
+		before = get_global_override_stats();
+		levelData = new c8[256];
+		afterLevel = get_global_override_stats();
+		// more than the whole region
+		fallbackData = new c8[SIZE_KB(128)];
+		afterFallback = get_global_override_stats();
+	}
+	EXPECT_EQ(get_thread_global_region(), nullptr);
+
+	EXPECT_TRUE(IsInLevelRegion(levelData));
+	EXPECT_EQ(afterLevel.region_allocs, before.region_allocs + 1);
+	EXPECT_FALSE(IsInLevelRegion(fallbackData));
+	EXPECT_EQ(afterFallback.region_allocs, before.region_allocs + 1);
+	EXPECT_EQ(afterFallback.large_allocs, before.large_allocs + 1);
+
+	// recognized by address, outside of the scope too
+	delete[] levelData;
+	delete[] fallbackData;
+	EXPECT_EQ(s_LevelAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(GlobalOverride_Test, System_Fallback_Is_Freed)
+{
+	// larger than the default large region can ever be
+	const global_override_stats before = get_global_override_stats();
+	c8* systemData = new (std::nothrow) c8[HL_GLOBAL_LARGE_REGION_SIZE + SIZE_MB(1)];
+	const global_override_stats afterAlloc = get_global_override_stats();
+	EXPECT_EQ(afterAlloc.system_allocs, before.system_allocs + 1);
+	EXPECT_EQ(afterAlloc.large_allocs, before.large_allocs);
+	if (systemData == nullptr) {
+		GTEST_SKIP() << "the system allocator cannot serve the fallback either";
+	}
+
+	systemData[0] = 1;
+	systemData[HL_GLOBAL_LARGE_REGION_SIZE] = 2;
+	delete[] systemData;
+	EXPECT_EQ(get_global_override_stats().frees, before.frees + 1);
+}
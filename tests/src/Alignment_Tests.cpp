@@ -0,0 +1,175 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+struct alignas(32) SimdVector {
+	float lanes[8];
+};
+
+struct alignas(64) CacheLine {
+	u32 counter;
+};
+
+typedef allocator<stack_scheme, no_tracking_policy>					StackAllocator;
+typedef allocator<freelist_scheme, no_tracking_policy>				FreelistAllocator;
+typedef allocator<tlsf_scheme, no_tracking_policy>					TLSFAllocator;
+typedef fixed_allocator<pool_scheme, sizeof(CacheLine), no_tracking_policy>	CacheLinePoolAllocator;
+
+static StackAllocator												s_AlignStackAllocator;
+static FreelistAllocator											s_AlignFreelistAllocator;
+static TLSFAllocator												s_AlignTLSFAllocator;
+static CacheLinePoolAllocator										s_AlignPoolAllocator;
+
+class Alignment_Test : public Region_Test<Alignment_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<StackAllocator> { "align/stack", SIZE_KB(64), &s_AlignStackAllocator },
+			memory_region<FreelistAllocator> { "align/freelist", SIZE_KB(256), &s_AlignFreelistAllocator },
+			memory_region<TLSFAllocator> { "align/tlsf", SIZE_KB(256), &s_AlignTLSFAllocator },
+			memory_region<CacheLinePoolAllocator> { "align/pool", SIZE_KB(16), &s_AlignPoolAllocator }
+		);
+	}
+};
+
+TEST_F(Alignment_Test, Utils)
+{
+	EXPECT_EQ(align_size(0, 16), 0u);
+	EXPECT_EQ(align_size(1, 16), 16u);
+	EXPECT_EQ(align_size(16, 16), 16u);
+	EXPECT_EQ(natural_alignment(24, 64), 8u);
+	EXPECT_EQ(natural_alignment(256, 64), 64u);
+
+	// an aligned address is not bumped anymore
+	voidptr p = (voidptr)(aptr)0x1000;
+	EXPECT_EQ(align_address(p, 16), p);
+	EXPECT_EQ(align_address((voidptr)(aptr)0x1001, 16), (voidptr)(aptr)0x1010);
+}
+
+TEST_F(Alignment_Test, Stack_Minimal_Padding)
+{
+	typedef StackAllocator::alloc_header_t HeaderType;
+	const size alignment = StackAllocator::k_min_alignment;
+	const size bytes = alignment * 3;
+
+	// the stack starts aligned, so frames of an aligned size need no padding at all
+	for (u32 i = 0; i < 8; i++) {
+		voidptr p = s_AlignStackAllocator.allocate(bytes);
+		EXPECT_TRUE(is_aligned(p, alignment));
+	}
+	EXPECT_EQ(s_AlignStackAllocator.get_used_bytes(), 8 * (bytes + sizeof(HeaderType)));
+}
+
+TEST_F(Alignment_Test, Stack_Allocate_Aligned)
+{
+	for (u32 i = 0; i < 16; i++) {
+		s_AlignStackAllocator.allocate(i + 1);
+		voidptr p = s_AlignStackAllocator.allocate_aligned(48, 64);
+		EXPECT_TRUE(is_aligned(p, 64));
+	}
+
+	SimdVector* v = s_AlignStackAllocator.allocate<SimdVector>();
+	EXPECT_TRUE(is_aligned(v, alignof(SimdVector)));
+	s_AlignStackAllocator.free(v);
+}
+
+TEST_F(Alignment_Test, Freelist_Allocate_Aligned)
+{
+	std::vector<voidptr> ptrs;
+	for (u32 i = 0; i < 64; i++) {
+		ptrs.push_back(s_AlignFreelistAllocator.allocate(i * 7 + 1));
+		voidptr p = s_AlignFreelistAllocator.allocate_aligned(100, (size)16 << (i % 5));
+		ASSERT_NE(p, nullptr);
+		EXPECT_TRUE(is_aligned(p, (size)16 << (i % 5)));
+		ptrs.push_back(p);
+	}
+	CacheLine* c = s_AlignFreelistAllocator.allocate<CacheLine>();
+	EXPECT_TRUE(is_aligned(c, 64));
+	s_AlignFreelistAllocator.free(c);
+
+	// the padding blocks in front of aligned allocations coalesce back
+	for (size_t i = 0; i < ptrs.size(); i++) {
+		s_AlignFreelistAllocator.free(ptrs[i]);
+	}
+	EXPECT_EQ(s_AlignFreelistAllocator.get_used_bytes(), 0u);
+	voidptr big = s_AlignFreelistAllocator.allocate(SIZE_KB(200));
+	EXPECT_NE(big, nullptr);
+}
+
+TEST_F(Alignment_Test, TLSF_Allocate_Aligned)
+{
+	std::vector<voidptr> ptrs;
+	for (u32 i = 0; i < 64; i++) {
+		ptrs.push_back(s_AlignTLSFAllocator.allocate(i * 7 + 1));
+		voidptr p = s_AlignTLSFAllocator.allocate_aligned(100, (size)16 << (i % 5));
+		ASSERT_NE(p, nullptr);
+		EXPECT_TRUE(is_aligned(p, (size)16 << (i % 5)));
+		ptrs.push_back(p);
+	}
+
+	for (size_t i = 0; i < ptrs.size(); i++) {
+		s_AlignTLSFAllocator.free(ptrs[i]);
+	}
+	EXPECT_EQ(s_AlignTLSFAllocator.get_used_bytes(), 0u);
+	voidptr big = s_AlignTLSFAllocator.allocate(SIZE_KB(200));
+	EXPECT_NE(big, nullptr);
+}
+
+// the block carved after a leading gap gets a fresh header: if it still read as free, freeing one of its
+// physical neighbours would coalesce the live block into the free lists
+template <class t_allocator>
+static void CheckLeadingGapNeighbours(t_allocator& alloc)
+{
+	// stale non-zero bytes where the aligned header is going to be written
+	p8 dirty = (p8)alloc.allocate(SIZE_KB(8));
+	ASSERT_NE(dirty, nullptr);
+	memset(dirty, 0xFF, SIZE_KB(8));
+	alloc.free(dirty);
+
+	voidptr first = alloc.allocate(24);
+	p8 aligned = (p8)alloc.allocate_aligned(256, 1024);
+	voidptr neighbour = alloc.allocate(256);
+	ASSERT_NE(aligned, nullptr);
+	ASSERT_NE(neighbour, nullptr);
+	EXPECT_TRUE(is_aligned(aligned, 1024));
+	memset(aligned, 0xA5, 256);
+
+	alloc.free(neighbour);
+	alloc.free(first);
+	p8 filler = (p8)alloc.allocate(SIZE_KB(2));
+	ASSERT_NE(filler, nullptr);
+	memset(filler, 0, SIZE_KB(2));
+	for (u32 i = 0; i < 256; i++) {
+		ASSERT_EQ(aligned[i], 0xA5);
+	}
+
+	alloc.free(filler);
+	alloc.free(aligned);
+	EXPECT_EQ(alloc.get_used_bytes(), 0u);
+}
+
+TEST_F(Alignment_Test, Freelist_Leading_Gap_Keeps_Neighbours)
+{
+	CheckLeadingGapNeighbours(s_AlignFreelistAllocator);
+}
+
+TEST_F(Alignment_Test, TLSF_Leading_Gap_Keeps_Neighbours)
+{
+	CheckLeadingGapNeighbours(s_AlignTLSFAllocator);
+}
+
+TEST_F(Alignment_Test, Pool_Slots_Are_Naturally_Aligned)
+{
+	const size slotAlignment = CacheLinePoolAllocator::k_slot_alignment;
+	EXPECT_EQ(slotAlignment, 64u);
+	while (CacheLine* c = s_AlignPoolAllocator.allocate<CacheLine>()) {
+		EXPECT_TRUE(is_aligned(c, 64));
+		c->counter = 1;
+	}
+	EXPECT_NE(s_AlignPoolAllocator.get_used_bytes(), 0u);
+}
@@ -0,0 +1,141 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+struct Particle {
+	f32 position[3];
+	u32 id;
+};
+
+typedef fixed_allocator<bitmap_pool_scheme, sizeof(Particle), no_tracking_policy>		ParticlePoolAllocator;
+typedef fixed_allocator<bitmap_pool_scheme, 12, default_tracking_policy>				TrackedPoolAllocator;
+typedef fixed_allocator<bitmap_pool_scheme, SIZE_KB(8), no_tracking_policy>				BigSlotPoolAllocator;
+
+static ParticlePoolAllocator															s_ParticlePool;
+static TrackedPoolAllocator																s_TrackedPool;
+static BigSlotPoolAllocator																s_BigSlotPool;
+
+class BitmapPool_Test : public Region_Test<BitmapPool_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<ParticlePoolAllocator> { "bitmap/particles", SIZE_KB(64), &s_ParticlePool },
+			memory_region<TrackedPoolAllocator> { "bitmap/tracked", SIZE_KB(4), &s_TrackedPool },
+			memory_region<BigSlotPoolAllocator> { "bitmap/big", SIZE_KB(256), &s_BigSlotPool }
+		);
+	}
+};
+
+TEST_F(BitmapPool_Test, Dense_Slots)
+{
+	// no header in between, slots are exactly one element apart
+	Particle* a = s_ParticlePool.allocate<Particle>();
+	Particle* b = s_ParticlePool.allocate<Particle>();
+	ASSERT_NE(a, nullptr);
+	EXPECT_EQ((p8)b - (p8)a, (ptrdiff_t)sizeof(Particle));
+	EXPECT_EQ((aptr)a & (ParticlePoolAllocator::k_slot_alignment - 1), 0u);
+	EXPECT_EQ(s_ParticlePool.get_used_bytes(), 2 * sizeof(Particle));
+
+	// the lowest free slot is handed out first
+	s_ParticlePool.free(a);
+	EXPECT_EQ(s_ParticlePool.allocate<Particle>(), a);
+}
+
+TEST_F(BitmapPool_Test, Exhaust_And_Refill)
+{
+	typename ParticlePoolAllocator::alloc_scheme_t& pool = s_ParticlePool;
+	const u32 count = s_ParticlePool.get_element_count();
+	EXPECT_GT(count, 3000u);
+
+	std::vector<voidptr> ptrs;
+	while (voidptr p = pool.allocate()) {
+		ptrs.push_back(p);
+	}
+	EXPECT_EQ(ptrs.size(), (size_t)count);
+	EXPECT_EQ(s_ParticlePool.get_remain_bytes(), 0u);
+
+	for (size_t i = 0; i < ptrs.size(); i += 3) {
+		pool.free(ptrs[i]);
+	}
+	for (size_t i = 0; i < ptrs.size(); i += 3) {
+		EXPECT_NE(pool.allocate(), nullptr);
+	}
+	EXPECT_EQ(pool.allocate(), nullptr);
+}
+
+TEST_F(BitmapPool_Test, For_Each_Live_In_Address_Order)
+{
+	std::vector<Particle*> particles;
+	for (u32 i = 0; i < 200; i++) {
+		Particle* p = s_ParticlePool.allocate<Particle>();
+		p->id = i;
+		particles.push_back(p);
+	}
+	for (u32 i = 0; i < 200; i += 2) {
+		s_ParticlePool.free(particles[i]);
+	}
+
+	u32 visited = 0;
+	Particle* last = nullptr;
+	s_ParticlePool.for_each_live<Particle>([&](Particle* i_particle) {
+		EXPECT_EQ(i_particle->id % 2, 1u);
+		EXPECT_LT(last, i_particle);
+		last = i_particle;
+		visited++;
+	});
+	EXPECT_EQ(visited, 100u);
+	EXPECT_EQ(s_ParticlePool.get_live_count(), 100u);
+}
+
+TEST_F(BitmapPool_Test, Bulk_And_Tracking)
+{
+	typename TrackedPoolAllocator::alloc_scheme_t& pool = s_TrackedPool;
+	const size trackedBytes = g_tracking_allocator.get_used_bytes();
+
+	voidptr ptrs[400];
+	const u32 allocated = pool.allocate_bulk(400, ptrs, "bitmap-bulk");
+	EXPECT_EQ(allocated, s_TrackedPool.get_element_count());
+	EXPECT_GT(g_tracking_allocator.get_used_bytes(), trackedBytes);
+	for (u32 i = 1; i < allocated; i++) {
+		EXPECT_EQ((p8)ptrs[i] - (p8)ptrs[i - 1], 12);
+	}
+
+	pool.free_bulk(ptrs, allocated);
+	EXPECT_EQ(g_tracking_allocator.get_used_bytes(), trackedBytes);
+	EXPECT_EQ(s_TrackedPool.get_used_bytes(), 0u);
+}
+
+TEST_F(BitmapPool_Test, Free_All_Unregisters_Live_Slots)
+{
+	typename TrackedPoolAllocator::alloc_scheme_t& pool = s_TrackedPool;
+	const size trackedBytes = g_tracking_allocator.get_used_bytes();
+	for (u32 i = 0; i < 50; i++) {
+		ASSERT_NE(pool.allocate("bitmap-live"), nullptr);
+	}
+	EXPECT_GT(g_tracking_allocator.get_used_bytes(), trackedBytes);
+
+	s_TrackedPool.free_all();
+	EXPECT_EQ(g_tracking_allocator.get_used_bytes(), trackedBytes);
+}
+
+TEST_F(BitmapPool_Test, Trim_Free_Runs)
+{
+	typename BigSlotPoolAllocator::alloc_scheme_t& pool = s_BigSlotPool;
+	std::vector<p8> ptrs;
+	while (p8 p = (p8)pool.allocate()) {
+		memset(p, 0xAA, SIZE_KB(8));
+		ptrs.push_back(p);
+	}
+	for (size_t i = 0; i < ptrs.size(); i += 2) {
+		pool.free(ptrs[i]);
+	}
+
+	EXPECT_GE(s_BigSlotPool.trim(), (ptrs.size() / 2) * SIZE_KB(4));
+	EXPECT_EQ(ptrs[0][SIZE_KB(4)], 0);
+	EXPECT_EQ(ptrs[1][SIZE_KB(4)], 0xAA);
+}
@@ -0,0 +1,164 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+typedef allocator<buddy_scheme, no_tracking_policy>				BuddyAllocator;
+typedef allocator<buddy_scheme, default_tracking_policy>			TrackedBuddyAllocator;
+
+static BuddyAllocator											s_BuddyAllocator;
+static TrackedBuddyAllocator									s_TrackedBuddyAllocator;
+
+class Buddy_Test : public Region_Test<Buddy_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<BuddyAllocator> { "buddy/untracked", SIZE_MB(40), &s_BuddyAllocator },
+			memory_region<TrackedBuddyAllocator> { "buddy/tracked", SIZE_MB(2), &s_TrackedBuddyAllocator }
+		);
+	}
+};
+
+TEST_F(Buddy_Test, Orders)
+{
+	EXPECT_EQ(BuddyAllocator::get_order(1), 0u);
+	EXPECT_EQ(BuddyAllocator::get_order(SIZE_KB(4)), 0u);
+	EXPECT_EQ(BuddyAllocator::get_order(SIZE_KB(4) + 1), 1u);
+	EXPECT_EQ(BuddyAllocator::get_order(SIZE_KB(12)), 2u);
+	EXPECT_EQ(BuddyAllocator::get_order(SIZE_MB(16)), (u32)BuddyAllocator::k_max_order);
+	EXPECT_EQ(BuddyAllocator::get_real_data_size(SIZE_KB(5)), SIZE_KB(8));
+}
+
+TEST_F(Buddy_Test, Blocks_Are_Aligned_To_Their_Size)
+{
+	// 40MB region: two 16MB blocks and smaller ones after the table
+	EXPECT_EQ(s_BuddyAllocator.get_largest_free_block(), SIZE_MB(16));
+
+	p8 small = (p8)s_BuddyAllocator.allocate(SIZE_KB(4));
+	ASSERT_NE(small, nullptr);
+	EXPECT_EQ((aptr)small & (SIZE_KB(4) - 1), 0u);
+
+	// both come from the same 16MB block, 64KB apart from each other
+	p8 a = (p8)s_BuddyAllocator.allocate(SIZE_KB(64));
+	p8 b = (p8)s_BuddyAllocator.allocate(SIZE_KB(64));
+	ASSERT_NE(a, nullptr);
+	ASSERT_NE(b, nullptr);
+	EXPECT_EQ((size)(a > b ? a - b : b - a) % SIZE_KB(64), 0u);
+	memset(a, 0xAB, SIZE_KB(64));
+	memset(b, 0xCD, SIZE_KB(64));
+	EXPECT_EQ(a[SIZE_KB(64) - 1], 0xAB);
+
+	EXPECT_EQ(s_BuddyAllocator.get_used_bytes(), SIZE_KB(4) + SIZE_KB(128));
+	s_BuddyAllocator.free(small);
+	s_BuddyAllocator.free(a);
+	s_BuddyAllocator.free(b);
+	EXPECT_EQ(s_BuddyAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(Buddy_Test, Split_And_Merge)
+{
+	const u32 maxOrder = BuddyAllocator::k_max_order;
+	const u32 maxBlocks = s_BuddyAllocator.get_free_block_count(maxOrder);
+	const u32 halfBlocks = s_BuddyAllocator.get_free_block_count(maxOrder - 1);
+	ASSERT_GE(maxBlocks, 1u);
+
+	// the tail of the region has no 8MB block, one 16MB block is split in halves
+	voidptr p = s_BuddyAllocator.allocate(SIZE_MB(8));
+	ASSERT_NE(p, nullptr);
+	EXPECT_EQ(s_BuddyAllocator.get_free_block_count(maxOrder), maxBlocks - 1);
+	EXPECT_EQ(s_BuddyAllocator.get_free_block_count(maxOrder - 1), halfBlocks + 1);
+
+	// and freeing it merges the halves back
+	s_BuddyAllocator.free(p);
+	EXPECT_EQ(s_BuddyAllocator.get_free_block_count(maxOrder), maxBlocks);
+	EXPECT_EQ(s_BuddyAllocator.get_free_block_count(maxOrder - 1), halfBlocks);
+}
+
+TEST_F(Buddy_Test, Random_Churn_Merges_Back)
+{
+	const size remainBytes = s_BuddyAllocator.get_remain_bytes();
+	const size largestBlock = s_BuddyAllocator.get_largest_free_block();
+
+	std::vector<voidptr> ptrs;
+	u32 seed = 17;
+	for (u32 i = 0; i < 2000; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		if (!ptrs.empty() && (seed >> 28) < 6) {
+			size_t idx = (seed >> 8) % ptrs.size();
+			s_BuddyAllocator.free(ptrs[idx]);
+			ptrs[idx] = ptrs.back();
+			ptrs.pop_back();
+		} else {
+			voidptr p = s_BuddyAllocator.allocate(SIZE_KB(4) << ((seed >> 4) % 7));
+			if (p) {
+				ptrs.push_back(p);
+			}
+		}
+	}
+	for (size_t i = 0; i < ptrs.size(); i++) {
+		s_BuddyAllocator.free(ptrs[i]);
+	}
+
+	EXPECT_EQ(s_BuddyAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(s_BuddyAllocator.get_remain_bytes(), remainBytes);
+	EXPECT_EQ(s_BuddyAllocator.get_largest_free_block(), largestBlock);
+}
+
+TEST_F(Buddy_Test, Out_Of_Memory)
+{
+	std::vector<voidptr> ptrs;
+	while (voidptr p = s_TrackedBuddyAllocator.allocate(SIZE_KB(64), "buddy-test")) {
+		ptrs.push_back(p);
+	}
+	EXPECT_FALSE(ptrs.empty());
+	EXPECT_LT(s_TrackedBuddyAllocator.get_remain_bytes(), SIZE_KB(64));
+	for (size_t i = 0; i < ptrs.size(); i++) {
+		s_TrackedBuddyAllocator.free(ptrs[i]);
+	}
+	EXPECT_EQ(s_TrackedBuddyAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(Buddy_Test, Alignment_Beyond_The_First_Block)
+{
+	// the table takes less than a block: the first block is 4KB but not 8KB aligned
+	alignas(SIZE_KB(64)) static u8 buffer[SIZE_KB(64)];
+	BuddyAllocator localAllocator;
+	localAllocator.map_to(buffer, sizeof(buffer), "buddy/local");
+
+	voidptr p = localAllocator.allocate_aligned(SIZE_KB(4), SIZE_KB(4));
+	ASSERT_NE(p, nullptr);
+	EXPECT_EQ((aptr)p & (SIZE_KB(4) - 1), 0u);
+	EXPECT_EQ(localAllocator.allocate_aligned(SIZE_KB(4), SIZE_KB(8)), nullptr);
+	localAllocator.free(p);
+}
+
+TEST_F(Buddy_Test, Reallocate)
+{
+	p8 p = (p8)s_BuddyAllocator.allocate(SIZE_KB(3));
+	memset(p, 0x5A, SIZE_KB(3));
+	EXPECT_EQ(s_BuddyAllocator.reallocate(p, SIZE_KB(4)), p);
+
+	p8 q = (p8)s_BuddyAllocator.reallocate(p, SIZE_KB(20));
+	ASSERT_NE(q, nullptr);
+	EXPECT_EQ(q[0], 0x5A);
+	EXPECT_EQ(q[SIZE_KB(3) - 1], 0x5A);
+	EXPECT_EQ(s_BuddyAllocator.get_used_bytes(), SIZE_KB(32));
+	s_BuddyAllocator.free(q);
+}
+
+TEST_F(Buddy_Test, Trim)
+{
+	p8 p = (p8)s_BuddyAllocator.allocate(SIZE_MB(1));
+	memset(p, 0xEE, SIZE_MB(1));
+	s_BuddyAllocator.free(p);
+	EXPECT_GT(s_BuddyAllocator.trim(), 0u);
+
+	// trimmed pages read back as zeros, the free list links survive
+	p = (p8)s_BuddyAllocator.allocate(SIZE_MB(1));
+	ASSERT_NE(p, nullptr);
+	EXPECT_EQ(p[SIZE_KB(512)], 0);
+}
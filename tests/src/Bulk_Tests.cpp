@@ -0,0 +1,102 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <set>
+#include <vector>
+
+using namespace helich;
+
+struct Particle {
+	Particle() : position(1.0f), velocity(2.0f) {}
+	~Particle() { s_destroyed++; }
+
+	f32 position;
+	f32 velocity;
+
+	static u32 s_destroyed;
+};
+u32 Particle::s_destroyed = 0;
+
+typedef fixed_allocator<pool_scheme, sizeof(Particle)>				ParticlePoolAllocator;
+typedef allocator<freelist_scheme>									FreelistAllocator;
+
+static ParticlePoolAllocator										s_BulkPoolAllocator;
+static FreelistAllocator											s_BulkFreelistAllocator;
+
+class Bulk_Test : public Region_Test<Bulk_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<ParticlePoolAllocator> { "bulk/pool", SIZE_KB(16), &s_BulkPoolAllocator },
+			memory_region<FreelistAllocator> { "bulk/freelist", SIZE_KB(256), &s_BulkFreelistAllocator }
+		);
+	}
+};
+
+TEST_F(Bulk_Test, Pool_Typed_Bulk)
+{
+	const size trackedBefore = g_tracking_allocator.get_used_bytes();
+	Particle* particles[100];
+	const u32 allocated = s_BulkPoolAllocator.allocate_bulk(100, particles, "particles");
+	ASSERT_EQ(allocated, 100u);
+
+	std::set<Particle*> unique(particles, particles + allocated);
+	EXPECT_EQ(unique.size(), (size_t)allocated);
+	for (u32 i = 0; i < allocated; i++) {
+		EXPECT_EQ(particles[i]->position, 1.0f);
+	}
+	// every allocation got its own debug entry
+	EXPECT_EQ(g_tracking_allocator.get_used_bytes() - trackedBefore, allocated * g_tracking_allocator.get_element_size());
+
+	Particle::s_destroyed = 0;
+	s_BulkPoolAllocator.free_bulk(particles, allocated);
+	EXPECT_EQ(Particle::s_destroyed, allocated);
+	EXPECT_EQ(s_BulkPoolAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(g_tracking_allocator.get_used_bytes(), trackedBefore);
+}
+
+TEST_F(Bulk_Test, Pool_Bulk_Stops_When_Full)
+{
+	std::vector<voidptr> ptrs(10000);
+	const u32 allocated = s_BulkPoolAllocator.allocate_bulk((u32)ptrs.size(), &ptrs[0]);
+	EXPECT_GT(allocated, 0u);
+	EXPECT_LT(allocated, (u32)ptrs.size());
+	EXPECT_EQ(s_BulkPoolAllocator.get_used_bytes(), allocated * s_BulkPoolAllocator.get_element_size());
+
+	s_BulkPoolAllocator.free_bulk(&ptrs[0], allocated);
+	EXPECT_EQ(s_BulkPoolAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(s_BulkPoolAllocator.allocate_bulk((u32)ptrs.size(), &ptrs[0]), allocated);
+}
+
+TEST_F(Bulk_Test, Freelist_Bulk)
+{
+	voidptr ptrs[300];
+	const u32 allocated = s_BulkFreelistAllocator.allocate_bulk(300, 48, ptrs, "messages");
+	ASSERT_EQ(allocated, 300u);
+	for (u32 i = 0; i < allocated; i++) {
+		memset(ptrs[i], (s32)i, 48);
+	}
+	for (u32 i = 0; i < allocated; i++) {
+		EXPECT_EQ(((p8)ptrs[i])[47], (u8)i);
+	}
+
+	// mixed with single frees, the blocks still coalesce back to one
+	s_BulkFreelistAllocator.free(ptrs[0]);
+	s_BulkFreelistAllocator.free_bulk(ptrs + 1, allocated - 1);
+	EXPECT_EQ(s_BulkFreelistAllocator.get_used_bytes(), 0u);
+	EXPECT_NE(s_BulkFreelistAllocator.allocate(SIZE_KB(200)), nullptr);
+}
+
+TEST_F(Bulk_Test, Freelist_Typed_Bulk)
+{
+	Particle* particles[100];
+	ASSERT_EQ(s_BulkFreelistAllocator.allocate_bulk(100, particles), 100u);
+	EXPECT_EQ(particles[99]->velocity, 2.0f);
+
+	Particle::s_destroyed = 0;
+	s_BulkFreelistAllocator.free_bulk(particles, 100);
+	EXPECT_EQ(Particle::s_destroyed, 100u);
+	EXPECT_EQ(s_BulkFreelistAllocator.get_used_bytes(), 0u);
+}
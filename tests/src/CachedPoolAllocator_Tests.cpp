@@ -0,0 +1,123 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <thread>
+#include <vector>
+
+using namespace helich;
+
+typedef fixed_allocator<cached_pool_scheme, 32, no_tracking_policy>	CachedPoolAllocator;
+typedef fixed_allocator<cached_pool_scheme, 32, default_tracking_policy>	TrackedCachedPoolAllocator;
+
+static CachedPoolAllocator											s_CachedPoolAllocator;
+static TrackedCachedPoolAllocator									s_TrackedCachedPoolAllocator;
+
+class CachedPool_Test : public Region_Test<CachedPool_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<CachedPoolAllocator> { "cached_pool", SIZE_KB(512), &s_CachedPoolAllocator },
+			memory_region<TrackedCachedPoolAllocator> { "cached_pool/tracked", SIZE_KB(64), &s_TrackedCachedPoolAllocator }
+		);
+		s_CachedPoolAllocator.set_thread_cache_size(16);
+	}
+};
+
+TEST_F(CachedPool_Test, Used_Bytes_Exclude_Cached_Slots)
+{
+	int* a = s_CachedPoolAllocator.allocate<int>(1);
+	EXPECT_EQ(*a, 1);
+	EXPECT_EQ(s_CachedPoolAllocator.get_used_bytes(), s_CachedPoolAllocator.get_element_size());
+	// the refill took more than one slot from the pool, the others are cached
+	EXPECT_GT(s_CachedPoolAllocator.get_cached_bytes(), 0u);
+
+	s_CachedPoolAllocator.free(a);
+	EXPECT_EQ(s_CachedPoolAllocator.get_used_bytes(), 0u);
+
+	s_CachedPoolAllocator.flush_thread_cache();
+	EXPECT_EQ(s_CachedPoolAllocator.get_cached_bytes(), 0u);
+	EXPECT_EQ(s_CachedPoolAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(CachedPool_Test, Multiple_Threads)
+{
+	std::vector<std::thread> workers;
+	for (int t = 0; t < 4; t++) {
+		workers.push_back(std::thread([t]() {
+			std::vector<int*> objs;
+			for (int round = 0; round < 100; round++) {
+				for (int i = 0; i < 50; i++) {
+					objs.push_back(s_CachedPoolAllocator.allocate<int>(t * 1000 + i));
+				}
+				for (size_t i = 0; i < objs.size(); i++) {
+					EXPECT_EQ(*objs[i], t * 1000 + (int)i);
+					s_CachedPoolAllocator.free(objs[i]);
+				}
+				objs.clear();
+			}
+			s_CachedPoolAllocator.flush_thread_cache();
+		}));
+	}
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+	EXPECT_EQ(s_CachedPoolAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(s_CachedPoolAllocator.get_cached_bytes(), 0u);
+}
+
+TEST_F(CachedPool_Test, Cache_Size_Is_Per_Thread)
+{
+	// a thread without cache goes straight to the pool
+	std::thread uncached([]() {
+		s_CachedPoolAllocator.set_thread_cache_size(0);
+		int* p = s_CachedPoolAllocator.allocate<int>(0);
+		EXPECT_EQ(s_CachedPoolAllocator.get_cached_bytes(), 0u);
+		s_CachedPoolAllocator.free(p);
+		EXPECT_EQ(s_CachedPoolAllocator.get_cached_bytes(), 0u);
+		EXPECT_EQ(s_CachedPoolAllocator.get_used_bytes(), 0u);
+	});
+	uncached.join();
+
+	// this one still caches
+	int* p = s_CachedPoolAllocator.allocate<int>(0);
+	EXPECT_GT(s_CachedPoolAllocator.get_cached_bytes(), 0u);
+	s_CachedPoolAllocator.free(p);
+
+	// shrinking the cache gives the slots which do not fit back
+	int* ptrs[16];
+	for (u32 i = 0; i < 16; i++) {
+		ptrs[i] = s_CachedPoolAllocator.allocate<int>(i);
+	}
+	for (u32 i = 0; i < 16; i++) {
+		s_CachedPoolAllocator.free(ptrs[i]);
+	}
+	s_CachedPoolAllocator.set_thread_cache_size(4);
+	EXPECT_LE(s_CachedPoolAllocator.get_cached_bytes(), 4 * s_CachedPoolAllocator.get_element_size());
+	EXPECT_EQ(s_CachedPoolAllocator.get_used_bytes(), 0u);
+	s_CachedPoolAllocator.flush_thread_cache();
+}
+
+TEST_F(CachedPool_Test, Refilled_Slots_Keep_The_Description)
+{
+	voidptr p = s_TrackedCachedPoolAllocator.allocate_aligned(alignof(int), "cached-node");
+	ASSERT_NE(p, nullptr);
+
+	// the whole refill is tracked under the description of the request which triggered it
+	debug_memory_block blocks[64];
+	u32 numBlocks = 0;
+	for (u32 i = 0; i < s_MemoryManager.p_mem_regions_count; i++) {
+		const memory_region_info& info = s_MemoryManager.p_mem_regions[i];
+		if (info.allocator_ptr == &s_TrackedCachedPoolAllocator) {
+			info.dbg_info_extractor(info.allocator_ptr, blocks, 64, numBlocks);
+		}
+	}
+	ASSERT_GT(numBlocks, 0u);
+	for (u32 i = 0; i < numBlocks; i++) {
+		EXPECT_STREQ(blocks[i].description, "cached-node");
+	}
+
+	s_TrackedCachedPoolAllocator.free(p);
+	s_TrackedCachedPoolAllocator.flush_thread_cache();
+}
@@ -0,0 +1,125 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+typedef defrag_heap<1024>											DefragHeap;
+
+static const DefragHeap::handle_t									k_NullHandle = DefragHeap::k_null_handle;
+
+static DefragHeap													s_DefragHeap;
+
+class DefragHeap_Test : public Region_Test<DefragHeap_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<DefragHeap> { "defrag/heap", SIZE_KB(256), &s_DefragHeap }
+		);
+	}
+};
+
+static void fill(DefragHeap::handle_t i_handle, const size i_bytes, const u8 i_value)
+{
+	memset(s_DefragHeap.resolve(i_handle), i_value, i_bytes);
+}
+
+static bool check(DefragHeap::handle_t i_handle, const size i_bytes, const u8 i_value)
+{
+	const u8* data = (const u8*)s_DefragHeap.resolve(i_handle);
+	for (size i = 0; i < i_bytes; i++) {
+		if (data[i] != i_value) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_F(DefragHeap_Test, Allocate_Resolve_Free)
+{
+	DefragHeap::handle_t h = s_DefragHeap.allocate(100);
+	ASSERT_NE(h, k_NullHandle);
+	voidptr p = s_DefragHeap.resolve(h);
+	ASSERT_NE(p, nullptr);
+	EXPECT_EQ((aptr)p & (DefragHeap::k_alignment - 1), 0u);
+	EXPECT_GT(s_DefragHeap.get_used_bytes(), 100u);
+
+	s_DefragHeap.free(h);
+	EXPECT_EQ(s_DefragHeap.resolve(h), nullptr);
+	EXPECT_FALSE(s_DefragHeap.is_valid(h));
+	EXPECT_EQ(s_DefragHeap.get_used_bytes(), 0u);
+}
+
+TEST_F(DefragHeap_Test, Defrag_Recovers_Contiguous_Space)
+{
+	std::vector<DefragHeap::handle_t> handles;
+	for (u32 i = 0; i < 200; i++) {
+		DefragHeap::handle_t h = s_DefragHeap.allocate(1000);
+		ASSERT_NE(h, k_NullHandle);
+		fill(h, 1000, (u8)i);
+		handles.push_back(h);
+	}
+	// the rest of the region, so the holes below are all there is
+	DefragHeap::handle_t tail = s_DefragHeap.allocate(s_DefragHeap.get_largest_free_block());
+	ASSERT_NE(tail, k_NullHandle);
+
+	for (u32 i = 0; i < 200; i += 2) {
+		s_DefragHeap.free(handles[i]);
+	}
+	EXPECT_LT(s_DefragHeap.get_largest_free_block(), 2000u);
+	EXPECT_EQ(s_DefragHeap.allocate(SIZE_KB(64)), k_NullHandle);
+
+	DefragHeap::defrag_result result;
+	u32 calls = 0;
+	do {
+		result = s_DefragHeap.defrag(1.0f);
+		EXPECT_GE(result.largest_free_after, result.largest_free_before);
+		calls++;
+	} while (!result.compacted && calls < 1000);
+	EXPECT_TRUE(result.compacted);
+
+	// every live block kept its data through the moves
+	for (u32 i = 1; i < 200; i += 2) {
+		EXPECT_TRUE(check(handles[i], 1000, (u8)i));
+	}
+	EXPECT_GE(s_DefragHeap.get_largest_free_block(), 100u * 1000u);
+	EXPECT_NE(s_DefragHeap.allocate(SIZE_KB(64)), k_NullHandle);
+}
+
+TEST_F(DefragHeap_Test, Pinned_Blocks_Stay)
+{
+	DefragHeap::handle_t a = s_DefragHeap.allocate(512);
+	DefragHeap::handle_t b = s_DefragHeap.allocate(512);
+	DefragHeap::handle_t c = s_DefragHeap.allocate(512);
+	fill(b, 512, 0xB0);
+	fill(c, 512, 0xC0);
+	s_DefragHeap.free(a);
+
+	voidptr pinned = s_DefragHeap.pin(b);
+	voidptr cBefore = s_DefragHeap.resolve(c);
+	DefragHeap::defrag_result result = s_DefragHeap.defrag(1.0f);
+	EXPECT_TRUE(result.compacted);
+	EXPECT_EQ(result.moved_blocks, 0u);
+	EXPECT_EQ(s_DefragHeap.resolve(b), pinned);
+	EXPECT_EQ(s_DefragHeap.resolve(c), cBefore);
+
+	// once unpinned, b slides down over a's hole and c follows
+	s_DefragHeap.unpin(b);
+	result = s_DefragHeap.defrag(1.0f);
+	EXPECT_EQ(result.moved_blocks, 2u);
+	EXPECT_LT(s_DefragHeap.resolve(b), pinned);
+	EXPECT_TRUE(check(b, 512, 0xB0));
+	EXPECT_TRUE(check(c, 512, 0xC0));
+}
+
+TEST_F(DefragHeap_Test, Out_Of_Handles)
+{
+	for (u32 i = 0; i < 1024; i++) {
+		ASSERT_NE(s_DefragHeap.allocate(16), k_NullHandle);
+	}
+	EXPECT_EQ(s_DefragHeap.allocate(16), k_NullHandle);
+	EXPECT_EQ(s_DefragHeap.get_live_count(), 1024u);
+}
@@ -0,0 +1,103 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+using namespace helich;
+
+typedef allocator<double_ended_stack_scheme, default_tracking_policy>	DoubleEndedAllocator;
+
+static DoubleEndedAllocator												s_DEAllocator;
+
+static u32 count_live_blocks()
+{
+	debug_memory_block blocks[256];
+	u32 numBlocks = 0;
+	alloc_region_dbginfo_extractor<DoubleEndedAllocator::alloc_region_t>::extract_info(&s_DEAllocator, blocks, 256, numBlocks);
+	return numBlocks;
+}
+
+class DoubleEndedStack_Test : public Region_Test<DoubleEndedStack_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<DoubleEndedAllocator> { "double_ended", SIZE_KB(64), &s_DEAllocator }
+		);
+	}
+};
+
+TEST_F(DoubleEndedStack_Test, Both_Ends)
+{
+	p8 low = (p8)s_DEAllocator.allocate_low(64, 16, "level");
+	p8 high = (p8)s_DEAllocator.allocate_high(64, 16, "scratch");
+	EXPECT_LT(low, high);
+	EXPECT_EQ((aptr)high & 15, 0u);
+	EXPECT_EQ(s_DEAllocator.get_used_bytes(), s_DEAllocator.get_low_used_bytes() + s_DEAllocator.get_high_used_bytes());
+	EXPECT_EQ(count_live_blocks(), 2u);
+
+	s_DEAllocator.free(high);
+	EXPECT_EQ(s_DEAllocator.get_high_used_bytes(), 0u);
+	s_DEAllocator.free(low);
+	EXPECT_EQ(s_DEAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(count_live_blocks(), 0u);
+}
+
+TEST_F(DoubleEndedStack_Test, Markers_Per_End)
+{
+	s_DEAllocator.allocate_low(100);
+	s_DEAllocator.allocate_high(100);
+	const size lowUsed = s_DEAllocator.get_low_used_bytes();
+	const size highUsed = s_DEAllocator.get_high_used_bytes();
+
+	DoubleEndedAllocator::marker lowMarker = s_DEAllocator.get_low_marker();
+	DoubleEndedAllocator::marker highMarker = s_DEAllocator.get_high_marker();
+	for (u32 i = 0; i < 8; i++) {
+		s_DEAllocator.allocate_low(i * 11 + 1);
+		s_DEAllocator.allocate_high(i * 13 + 1);
+	}
+	EXPECT_EQ(count_live_blocks(), 18u);
+
+	s_DEAllocator.free_to_high_marker(highMarker);
+	EXPECT_EQ(s_DEAllocator.get_high_used_bytes(), highUsed);
+	EXPECT_EQ(count_live_blocks(), 10u);
+
+	s_DEAllocator.free_to_low_marker(lowMarker);
+	EXPECT_EQ(s_DEAllocator.get_low_used_bytes(), lowUsed);
+	EXPECT_EQ(count_live_blocks(), 2u);
+
+	s_DEAllocator.free_all_low();
+	EXPECT_EQ(s_DEAllocator.get_low_used_bytes(), 0u);
+	EXPECT_EQ(count_live_blocks(), 1u);
+	s_DEAllocator.free_all_high();
+	EXPECT_EQ(s_DEAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(count_live_blocks(), 0u);
+}
+
+TEST_F(DoubleEndedStack_Test, Ends_Share_The_Region)
+{
+	// one end can use almost all of the region when the other one is empty
+	voidptr big = s_DEAllocator.allocate_high(SIZE_KB(60));
+	EXPECT_NE(big, nullptr);
+	s_DEAllocator.free(big);
+	big = s_DEAllocator.allocate_low(SIZE_KB(60));
+	EXPECT_NE(big, nullptr);
+	s_DEAllocator.free(big);
+}
+
+TEST_F(DoubleEndedStack_Test, High_Only_Then_Free_All)
+{
+	// the low walk of free_all() has nothing to walk
+	s_DEAllocator.allocate_high(100, 16, "high-only");
+	s_DEAllocator.allocate_high(40);
+	EXPECT_EQ(count_live_blocks(), 2u);
+
+	s_DEAllocator.free_all();
+	EXPECT_EQ(s_DEAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(count_live_blocks(), 0u);
+
+	// and the mirrored case
+	s_DEAllocator.allocate_low(100);
+	s_DEAllocator.free_all();
+	EXPECT_EQ(s_DEAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(count_live_blocks(), 0u);
+}
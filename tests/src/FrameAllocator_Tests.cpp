@@ -0,0 +1,91 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <string.h>
+
+using namespace helich;
+
+typedef frame_allocator<2, no_tracking_policy>						DoubleBufferedAllocator;
+typedef frame_allocator<3, default_tracking_policy>					TripleBufferedAllocator;
+
+static DoubleBufferedAllocator										s_DoubleBufferedAllocator;
+static TripleBufferedAllocator										s_TripleBufferedAllocator;
+
+class FrameAllocator_Test : public Region_Test<FrameAllocator_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<DoubleBufferedAllocator> { "ticks", SIZE_KB(64), &s_DoubleBufferedAllocator },
+			memory_region<TripleBufferedAllocator> { "triple", SIZE_KB(96), &s_TripleBufferedAllocator }
+		);
+	}
+};
+
+TEST_F(FrameAllocator_Test, Previous_Frame_Survives_One_Tick)
+{
+	int* produced = s_DoubleBufferedAllocator.allocate<int>(42);
+	s_DoubleBufferedAllocator.advance_frame();
+
+	// consumed during the next tick
+	EXPECT_EQ(*produced, 42);
+	EXPECT_EQ(s_DoubleBufferedAllocator.get_used_bytes(), 0u);
+	EXPECT_GT(s_DoubleBufferedAllocator.get_previous_frame().get_used_bytes(), 0u);
+
+	// then recycled
+	s_DoubleBufferedAllocator.advance_frame();
+	EXPECT_EQ(s_DoubleBufferedAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(s_DoubleBufferedAllocator.get_current_frame_index(), 0u);
+}
+
+TEST_F(FrameAllocator_Test, Tracked_Frames_Rotate)
+{
+	for (u32 tick = 0; tick < 10; tick++) {
+		for (u32 i = 0; i < 16; i++) {
+			s_TripleBufferedAllocator.allocate(32 * (tick + 1), "tick data");
+		}
+		s_TripleBufferedAllocator.advance_frame();
+	}
+	EXPECT_EQ(s_TripleBufferedAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(s_TripleBufferedAllocator.get_current_frame_index(), 10u % 3);
+}
+
+TEST_F(FrameAllocator_Test, Frames_Are_Reported)
+{
+	int* a = (int*)s_DoubleBufferedAllocator.allocate(SIZE_KB(4));
+	s_DoubleBufferedAllocator.advance_frame();
+	s_DoubleBufferedAllocator.advance_frame();
+	EXPECT_NE(a, nullptr);
+
+	u32 numFrames = 0;
+	for (u32 i = 0; i < s_MemoryManager.p_mem_regions_count; i++) {
+		const memory_region_info& info = s_MemoryManager.p_mem_regions[i];
+		if (strncmp(info.name, "ticks/frame", 11) != 0)
+			continue;
+		ASSERT_NE(info.peak_extractor, nullptr);
+		u32 numBlocks = 0;
+		EXPECT_EQ(info.dbg_info_extractor(info.allocator_ptr, nullptr, 0, numBlocks), 0u);
+		if (info.allocator_ptr == &s_DoubleBufferedAllocator.get_frame(0)) {
+			EXPECT_GE(info.peak_extractor(info.allocator_ptr), SIZE_KB(4));
+		}
+		numFrames++;
+	}
+	EXPECT_EQ(numFrames, 2u);
+}
+
+TEST_F(FrameAllocator_Test, Frames_Fit_An_Unaligned_Base)
+{
+	alignas(HL_CACHE_LINE_SIZE) static u8 buffer[SIZE_KB(4) + HL_CACHE_LINE_SIZE];
+	// a base right past a cache line boundary loses almost a line to the alignment
+	p8 baseAddress = buffer + 8;
+	const size sizeInBytes = SIZE_KB(4);
+	DoubleBufferedAllocator unalignedAllocator;
+	unalignedAllocator.map_to(baseAddress, sizeInBytes, "unaligned");
+
+	for (u32 i = 0; i < 2; i++) {
+		const DoubleBufferedAllocator::frame_t& frame = unalignedAllocator.get_frame(i);
+		EXPECT_GE(frame.get_base_address(), baseAddress);
+		EXPECT_LE(frame.get_base_address() + frame.get_size_in_bytes(), baseAddress + sizeInBytes);
+	}
+}
@@ -1,8 +1,67 @@
-#include "MemoryMap.h"
+#include "RegionTest.h"
 
 #include <gtest/gtest.h>
 #include <helich.h>
 
+#include <vector>
+
+using namespace helich;
+
+typedef allocator<freelist_scheme, no_tracking_policy>	FreelistAllocator;
+
+static FreelistAllocator								s_FreelistAllocator;
+
 // scenarios
 //	1- memory is all free
-//	2- memory is not all free
\ No newline at end of file
+//	2- memory is not all free
+
+class Freelist_Test : public Region_Test<Freelist_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<FreelistAllocator> { "freelist", SIZE_KB(64), &s_FreelistAllocator }
+		);
+	}
+};
+
+TEST_F(Freelist_Test, All_Free_Coalesces_Into_One_Block)
+{
+	std::vector<voidptr> ptrs;
+	for (unsigned int i = 0; i < 128; i++) {
+		voidptr p = s_FreelistAllocator.allocate(8 + (i * 13) % 200);
+		ASSERT_NE(p, nullptr);
+		ptrs.push_back(p);
+	}
+
+	// free in an order which forces both left and right joins
+	for (size_t i = 1; i < ptrs.size(); i += 2) {
+		s_FreelistAllocator.free(ptrs[i]);
+	}
+	for (size_t i = 0; i < ptrs.size(); i += 2) {
+		s_FreelistAllocator.free(ptrs[i]);
+	}
+	EXPECT_EQ(s_FreelistAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(s_FreelistAllocator.p_alloc_count, 128u);
+	EXPECT_EQ(s_FreelistAllocator.p_free_count, 128u);
+
+	// only one block left, it must be able to hold (almost) the whole region
+	voidptr big = s_FreelistAllocator.allocate(SIZE_KB(63));
+	EXPECT_NE(big, nullptr);
+	s_FreelistAllocator.free(big);
+}
+
+TEST_F(Freelist_Test, Not_All_Free_Reuses_Holes)
+{
+	voidptr a = s_FreelistAllocator.allocate(256);
+	voidptr b = s_FreelistAllocator.allocate(256);
+	voidptr c = s_FreelistAllocator.allocate(256);
+
+	s_FreelistAllocator.free(b);
+	voidptr d = s_FreelistAllocator.allocate(200);
+	EXPECT_EQ(d, b);
+
+	s_FreelistAllocator.free(a);
+	s_FreelistAllocator.free(c);
+	s_FreelistAllocator.free(d);
+	EXPECT_EQ(s_FreelistAllocator.get_used_bytes(), 0u);
+}
@@ -0,0 +1,88 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+typedef allocator<stack_scheme, no_tracking_policy>					StackAllocator;
+typedef allocator<freelist_scheme, default_tracking_policy>			FreelistAllocator;
+
+static StackAllocator												s_GrowStackAllocator;
+static FreelistAllocator											s_GrowFreelistAllocator;
+
+class GrowableRegion_Test : public Region_Test<GrowableRegion_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			growable_memory_region<StackAllocator> { "grow/stack", SIZE_MB(256), &s_GrowStackAllocator },
+			growable_memory_region<FreelistAllocator> { "grow/freelist", SIZE_MB(256), &s_GrowFreelistAllocator }
+		);
+	}
+};
+
+TEST_F(GrowableRegion_Test, Only_The_First_Chunk_Is_Committed)
+{
+	EXPECT_EQ(s_GrowStackAllocator.get_size_in_bytes(), SIZE_MB(256));
+	EXPECT_LE(s_GrowStackAllocator.get_committed_bytes(), SIZE_MB(1));
+	EXPECT_LE(s_GrowFreelistAllocator.get_committed_bytes(), SIZE_MB(1));
+}
+
+TEST_F(GrowableRegion_Test, Stack_Commits_As_It_Grows)
+{
+	const size before = s_GrowStackAllocator.get_committed_bytes();
+	p8 data = (p8)s_GrowStackAllocator.allocate(SIZE_MB(8));
+	ASSERT_NE(data, nullptr);
+	memset(data, 0xAB, SIZE_MB(8));
+	EXPECT_GT(s_GrowStackAllocator.get_committed_bytes(), before);
+	EXPECT_GE(s_GrowStackAllocator.get_committed_bytes(), SIZE_MB(8));
+	EXPECT_LT(s_GrowStackAllocator.get_committed_bytes(), SIZE_MB(9));
+
+	// growing the top frame in place commits too
+	data = (p8)s_GrowStackAllocator.reallocate(data, SIZE_MB(12));
+	ASSERT_NE(data, nullptr);
+	data[SIZE_MB(12) - 1] = 1;
+}
+
+TEST_F(GrowableRegion_Test, Freelist_Commits_As_It_Grows)
+{
+	std::vector<p8> ptrs;
+	for (u32 i = 0; i < 64; i++) {
+		p8 p = (p8)s_GrowFreelistAllocator.allocate(SIZE_KB(100));
+		ASSERT_NE(p, nullptr);
+		memset(p, 0xCD, SIZE_KB(100));
+		ptrs.push_back(p);
+	}
+	EXPECT_GE(s_GrowFreelistAllocator.get_committed_bytes(), SIZE_KB(6400));
+	EXPECT_LT(s_GrowFreelistAllocator.get_committed_bytes(), SIZE_MB(8));
+
+	// in-place growth of the last block reaches into uncommitted memory
+	p8 last = (p8)s_GrowFreelistAllocator.reallocate(ptrs.back(), SIZE_MB(2));
+	ASSERT_EQ(last, ptrs.back());
+	memset(last, 0xEF, SIZE_MB(2));
+	ptrs.back() = last;
+
+	for (size_t i = 0; i < ptrs.size(); i++) {
+		s_GrowFreelistAllocator.free(ptrs[i]);
+	}
+	EXPECT_EQ(s_GrowFreelistAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(GrowableRegion_Test, Regions_Report_Reserved_And_Committed)
+{
+	u32 found = 0;
+	for (u32 i = 0; i < s_MemoryManager.p_mem_regions_count; i++) {
+		const memory_region_info& info = s_MemoryManager.p_mem_regions[i];
+		if (strncmp(info.name, "grow/", 5) == 0) {
+			ASSERT_NE(info.committed_extractor, nullptr);
+			EXPECT_EQ(info.size_in_bytes, SIZE_MB(256));
+			EXPECT_LT(info.get_committed_bytes(), info.size_in_bytes);
+			found++;
+		} else {
+			EXPECT_EQ(info.get_committed_bytes(), info.size_in_bytes);
+		}
+	}
+	EXPECT_EQ(found, 2u);
+}
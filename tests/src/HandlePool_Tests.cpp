@@ -0,0 +1,137 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+struct Texture {
+	Texture(u32 i_width, u32 i_height)
+		: width(i_width), height(i_height)
+	{
+		s_LiveCount++;
+	}
+
+	Texture(Texture&& i_other)
+		: width(i_other.width), height(i_other.height)
+	{
+		s_LiveCount++;
+	}
+
+	~Texture() {
+		s_LiveCount--;
+	}
+
+	u32 width;
+	u32 height;
+	u8 texels[200];
+
+	static s32 s_LiveCount;
+};
+
+s32 Texture::s_LiveCount = 0;
+
+typedef handle_pool<Texture>										TexturePool;
+
+static const TexturePool::handle_t									k_NullHandle = TexturePool::k_null_handle;
+
+static TexturePool													s_TexturePool;
+
+class HandlePool_Test : public Region_Test<HandlePool_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<TexturePool> { "handles/textures", SIZE_KB(64), &s_TexturePool }
+		);
+		Texture::s_LiveCount = 0;
+	}
+};
+
+TEST_F(HandlePool_Test, Create_Resolve_Destroy)
+{
+	TexturePool::handle_t h = s_TexturePool.create(256u, 128u);
+	EXPECT_NE(h, k_NullHandle);
+	EXPECT_EQ(s_TexturePool.resolve(k_NullHandle), nullptr);
+
+	Texture* t = s_TexturePool.resolve(h);
+	ASSERT_NE(t, nullptr);
+	EXPECT_EQ(t->width, 256u);
+	EXPECT_EQ(Texture::s_LiveCount, 1);
+	EXPECT_EQ(s_TexturePool.get_used_bytes(), sizeof(Texture));
+
+	s_TexturePool.destroy(h);
+	EXPECT_EQ(Texture::s_LiveCount, 0);
+	EXPECT_FALSE(s_TexturePool.is_valid(h));
+	EXPECT_EQ(s_TexturePool.resolve(h), nullptr);
+
+	// a destroyed handle stays stale even when its slot is reused
+	TexturePool::handle_t h2 = s_TexturePool.create(64u, 64u);
+	EXPECT_EQ(TexturePool::get_index(h2), TexturePool::get_index(h));
+	EXPECT_NE(TexturePool::get_generation(h2), TexturePool::get_generation(h));
+	EXPECT_EQ(s_TexturePool.resolve(h), nullptr);
+	EXPECT_EQ(s_TexturePool.resolve(h2)->width, 64u);
+
+	// and destroying it again does nothing
+	s_TexturePool.destroy(h);
+	EXPECT_TRUE(s_TexturePool.is_valid(h2));
+}
+
+TEST_F(HandlePool_Test, Dense_After_Destroy)
+{
+	std::vector<TexturePool::handle_t> handles;
+	for (u32 i = 0; i < 100; i++) {
+		handles.push_back(s_TexturePool.create(i, i));
+	}
+	for (u32 i = 0; i < 100; i += 3) {
+		s_TexturePool.destroy(handles[i]);
+	}
+
+	// the survivors are packed at the front and still reachable through their handles
+	const u32 count = s_TexturePool.get_count();
+	EXPECT_EQ(count, 66u);
+	EXPECT_EQ(Texture::s_LiveCount, 66);
+	for (u32 i = 0; i < 100; i++) {
+		Texture* t = s_TexturePool.resolve(handles[i]);
+		if (i % 3 == 0) {
+			EXPECT_EQ(t, nullptr);
+		} else {
+			ASSERT_NE(t, nullptr);
+			EXPECT_EQ(t->width, i);
+			EXPECT_LT(t, s_TexturePool.get_objects() + count);
+		}
+	}
+
+	u32 visited = 0;
+	s_TexturePool.for_each([&](Texture& i_texture) {
+		EXPECT_NE(i_texture.width % 3, 0u);
+		visited++;
+	});
+	EXPECT_EQ(visited, count);
+
+	for (u32 i = 0; i < count; i++) {
+		EXPECT_EQ(s_TexturePool.resolve(s_TexturePool.get_handle(i)), s_TexturePool.get_objects() + i);
+	}
+}
+
+TEST_F(HandlePool_Test, Exhaust_And_Free_All)
+{
+	std::vector<TexturePool::handle_t> handles;
+	for (;;) {
+		TexturePool::handle_t h = s_TexturePool.create(1u, 1u);
+		if (h == k_NullHandle) {
+			break;
+		}
+		handles.push_back(h);
+	}
+	EXPECT_EQ(handles.size(), (size_t)s_TexturePool.get_capacity());
+	EXPECT_EQ(s_TexturePool.get_remain_bytes(), 0u);
+
+	s_TexturePool.free_all();
+	EXPECT_EQ(Texture::s_LiveCount, 0);
+	for (size_t i = 0; i < handles.size(); i++) {
+		EXPECT_FALSE(s_TexturePool.is_valid(handles[i]));
+	}
+	EXPECT_NE(s_TexturePool.create(2u, 2u), k_NullHandle);
+}
@@ -0,0 +1,97 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+typedef compact_header_policy<no_tracking_policy>								CompactPolicy;
+
+typedef fixed_allocator<pool_scheme, 27, no_tracking_policy>					FullPoolAllocator;
+typedef fixed_allocator<pool_scheme, 27, CompactPolicy>							CompactPoolAllocator;
+typedef allocator<stack_scheme, CompactPolicy>									CompactStackAllocator;
+typedef allocator<freelist_scheme, CompactPolicy>								CompactFreelistAllocator;
+typedef allocator<tlsf_scheme, CompactPolicy>									CompactTLSFAllocator;
+
+static FullPoolAllocator														s_FullPoolAllocator;
+static CompactPoolAllocator														s_CompactPoolAllocator;
+static CompactStackAllocator													s_CompactStackAllocator;
+static CompactFreelistAllocator													s_CompactFreelistAllocator;
+static CompactTLSFAllocator														s_CompactTLSFAllocator;
+
+struct Payload {
+	char bytes[27];
+};
+
+class HeaderLayout_Test : public Region_Test<HeaderLayout_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<FullPoolAllocator> { "full_pool", SIZE_KB(64), &s_FullPoolAllocator },
+			memory_region<CompactPoolAllocator> { "compact_pool", SIZE_KB(64), &s_CompactPoolAllocator },
+			memory_region<CompactStackAllocator> { "compact_stack", SIZE_KB(64), &s_CompactStackAllocator },
+			memory_region<CompactFreelistAllocator> { "compact_freelist", SIZE_KB(64), &s_CompactFreelistAllocator },
+			memory_region<CompactTLSFAllocator> { "compact_tlsf", SIZE_KB(64), &s_CompactTLSFAllocator }
+		);
+	}
+};
+
+TEST_F(HeaderLayout_Test, Compact_Pool_Has_No_Header_Overhead)
+{
+	EXPECT_EQ(s_CompactPoolAllocator.get_element_size(), 28u);
+	EXPECT_GT(s_FullPoolAllocator.get_element_size(), s_CompactPoolAllocator.get_element_size());
+
+	std::vector<Payload*> objs;
+	while (Payload* p = s_CompactPoolAllocator.allocate<Payload>()) {
+		p->bytes[26] = 'x';
+		objs.push_back(p);
+	}
+	EXPECT_EQ(objs.size(), SIZE_KB(64) / 28);
+	for (size_t i = 0; i < objs.size(); i++) {
+		EXPECT_EQ(objs[i]->bytes[26], 'x');
+		s_CompactPoolAllocator.free(objs[i]);
+	}
+	EXPECT_EQ(s_CompactPoolAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(HeaderLayout_Test, Compact_Variable_Size_Schemes)
+{
+	int* a = s_CompactStackAllocator.allocate<int>(1);
+	int* b = s_CompactStackAllocator.allocate<int>(2);
+	s_CompactStackAllocator.free(b);
+	s_CompactStackAllocator.free(a);
+	EXPECT_EQ(s_CompactStackAllocator.get_used_bytes(), 0u);
+
+	voidptr f1 = s_CompactFreelistAllocator.allocate(100);
+	voidptr f2 = s_CompactFreelistAllocator.allocate(100);
+	s_CompactFreelistAllocator.free(f1);
+	s_CompactFreelistAllocator.free(f2);
+	EXPECT_EQ(s_CompactFreelistAllocator.get_used_bytes(), 0u);
+
+	voidptr t1 = s_CompactTLSFAllocator.allocate(100);
+	voidptr t2 = s_CompactTLSFAllocator.allocate(100);
+	s_CompactTLSFAllocator.free(t2);
+	s_CompactTLSFAllocator.free(t1);
+	EXPECT_EQ(s_CompactTLSFAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(HeaderLayout_Test, Debug_Info_Without_Live_List)
+{
+	voidptr f1 = s_CompactFreelistAllocator.allocate(100, "desc");
+
+	// compact regions only report their usage
+	debug_memory_block blocks[8];
+	u32 numBlocks = 8;
+	size used = 0;
+	for (u32 i = 0; i < s_MemoryManager.p_mem_regions_count; i++) {
+		if (s_MemoryManager.p_mem_regions[i].allocator_ptr == &s_CompactFreelistAllocator) {
+			used = s_MemoryManager.p_mem_regions[i].dbg_info_extractor(&s_CompactFreelistAllocator, blocks, 8, numBlocks);
+		}
+	}
+	EXPECT_EQ(numBlocks, 0u);
+	EXPECT_EQ(used, s_CompactFreelistAllocator.get_used_bytes());
+
+	s_CompactFreelistAllocator.free(f1);
+}
@@ -0,0 +1,107 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace helich;
+
+typedef fixed_allocator<lockfree_pool_scheme, 48, no_tracking_policy>	LockFreePoolAllocator;
+typedef fixed_allocator<lockfree_pool_scheme, 32, default_tracking_policy>	TrackedLockFreePoolAllocator;
+
+static LockFreePoolAllocator											s_LockFreePoolAllocator;
+static TrackedLockFreePoolAllocator										s_TrackedLockFreePoolAllocator;
+
+class LockFreePool_Test : public Region_Test<LockFreePool_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<LockFreePoolAllocator> { "lockfree_pool", SIZE_KB(256), &s_LockFreePoolAllocator },
+			memory_region<TrackedLockFreePoolAllocator> { "lockfree_pool/tracked", SIZE_KB(16), &s_TrackedLockFreePoolAllocator }
+		);
+	}
+};
+
+TEST_F(LockFreePool_Test, Exhaust_And_Reuse)
+{
+	std::vector<int*> slots;
+	while (int* p = s_LockFreePoolAllocator.allocate<int>((int)slots.size())) {
+		slots.push_back(p);
+	}
+	EXPECT_EQ(slots.size() * s_LockFreePoolAllocator.get_element_size(), s_LockFreePoolAllocator.get_used_bytes());
+
+	s_LockFreePoolAllocator.free(slots.back());
+	EXPECT_EQ(s_LockFreePoolAllocator.allocate<int>(0), slots.back());
+	for (size_t i = 0; i < slots.size(); i++) {
+		s_LockFreePoolAllocator.free(slots[i]);
+	}
+	EXPECT_EQ(s_LockFreePoolAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(LockFreePool_Test, Producer_Consumer)
+{
+	// messages are allocated by the producers and freed by the consumers
+	const int k_MessageCount = 20000;
+	std::atomic<int*> mailbox[64];
+	for (int i = 0; i < 64; i++) {
+		mailbox[i].store(nullptr);
+	}
+	std::atomic<int> consumed(0);
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 2; t++) {
+		threads.push_back(std::thread([&, t]() {
+			for (int i = 0; i < k_MessageCount; i++) {
+				int* msg = nullptr;
+				while ((msg = s_LockFreePoolAllocator.allocate<int>(i)) == nullptr) {
+					std::this_thread::yield();
+				}
+				std::atomic<int*>& box = mailbox[(t * 32 + i) % 64];
+				int* expected = nullptr;
+				while (!box.compare_exchange_weak(expected, msg)) {
+					expected = nullptr;
+					std::this_thread::yield();
+				}
+			}
+		}));
+		threads.push_back(std::thread([&]() {
+			while (consumed.load() < 2 * k_MessageCount) {
+				for (int i = 0; i < 64; i++) {
+					int* msg = mailbox[i].exchange(nullptr);
+					if (msg) {
+						s_LockFreePoolAllocator.free(msg);
+						consumed.fetch_add(1);
+					}
+				}
+			}
+		}));
+	}
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+	EXPECT_EQ(consumed.load(), 2 * k_MessageCount);
+	EXPECT_EQ(s_LockFreePoolAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(LockFreePool_Test, Free_All_Unregisters_Live_Slots)
+{
+	TrackedLockFreePoolAllocator::alloc_scheme_t& pool = s_TrackedLockFreePoolAllocator;
+	const size trackedBytes = g_tracking_allocator.get_used_bytes();
+
+	// some slots back on the free stack, the others still live
+	std::vector<voidptr> slots;
+	for (u32 i = 0; i < 40; i++) {
+		slots.push_back(pool.allocate("lockfree-live"));
+		ASSERT_NE(slots.back(), nullptr);
+	}
+	for (u32 i = 0; i < 40; i += 3) {
+		pool.free(slots[i]);
+	}
+
+	s_TrackedLockFreePoolAllocator.free_all();
+	EXPECT_EQ(g_tracking_allocator.get_used_bytes(), trackedBytes);
+	EXPECT_EQ(s_TrackedLockFreePoolAllocator.get_used_bytes(), 0u);
+}
@@ -0,0 +1,75 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <thread>
+#include <vector>
+
+using namespace helich;
+
+typedef allocator<stack_scheme, no_tracking_policy, no_locking_policy>			FrameStackAllocator;
+typedef allocator<freelist_scheme, no_tracking_policy, spinlock_locking_policy>	SpinFreelistAllocator;
+typedef allocator<freelist_scheme, no_tracking_policy, mutex_locking_policy>		MutexFreelistAllocator;
+
+static FrameStackAllocator														s_FrameStackAllocator;
+static SpinFreelistAllocator													s_SpinFreelistAllocator;
+static MutexFreelistAllocator													s_MutexFreelistAllocator;
+
+class LockingPolicy_Test : public Region_Test<LockingPolicy_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<FrameStackAllocator> { "frame_stack", SIZE_KB(64), &s_FrameStackAllocator },
+			memory_region<SpinFreelistAllocator> { "spin_freelist", SIZE_KB(256), &s_SpinFreelistAllocator },
+			memory_region<MutexFreelistAllocator> { "mutex_freelist", SIZE_KB(64), &s_MutexFreelistAllocator }
+		);
+	}
+};
+
+TEST_F(LockingPolicy_Test, Single_Owner_Stack)
+{
+	int* a = s_FrameStackAllocator.allocate<int>(1);
+	int* b = s_FrameStackAllocator.allocate<int>(2);
+	EXPECT_EQ(*a + *b, 3);
+	s_FrameStackAllocator.free(b);
+	s_FrameStackAllocator.free(a);
+	EXPECT_EQ(s_FrameStackAllocator.get_used_bytes(), 0u);
+}
+
+// reallocate used to lock the (non-recursive) region mutex twice
+TEST_F(LockingPolicy_Test, Reallocate_Does_Not_Relock)
+{
+	u8* data = (u8*)s_MutexFreelistAllocator.allocate(16);
+	data[15] = 0x5a;
+	data = (u8*)s_MutexFreelistAllocator.reallocate(data, 256);
+	ASSERT_NE(data, nullptr);
+	EXPECT_EQ(data[15], 0x5a);
+
+	u8* stackData = (u8*)s_FrameStackAllocator.allocate(16);
+	stackData[15] = 0xa5;
+	stackData = (u8*)s_FrameStackAllocator.reallocate(stackData, 64);
+	EXPECT_EQ(stackData[15], 0xa5);
+
+	s_MutexFreelistAllocator.free(data);
+	EXPECT_EQ(s_MutexFreelistAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(LockingPolicy_Test, Spinlock_Multiple_Threads)
+{
+	std::vector<std::thread> workers;
+	for (int t = 0; t < 4; t++) {
+		workers.push_back(std::thread([t]() {
+			for (int i = 0; i < 2000; i++) {
+				int* v = s_SpinFreelistAllocator.allocate<int>(t + i);
+				ASSERT_NE(v, nullptr);
+				EXPECT_EQ(*v, t + i);
+				s_SpinFreelistAllocator.free(v);
+			}
+		}));
+	}
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+	EXPECT_EQ(s_SpinFreelistAllocator.get_used_bytes(), 0u);
+}
@@ -0,0 +1,119 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace helich;
+
+struct Job {
+	u64 payload[8];
+};
+
+typedef allocator<freelist_scheme, no_tracking_policy>				FreelistAllocator;
+typedef fixed_allocator<pool_scheme, sizeof(Job), no_tracking_policy>	JobPoolAllocator;
+typedef numa_replicated_allocator<JobPoolAllocator>					ReplicatedJobPools;
+
+static FreelistAllocator											s_NUMABoundAllocator;
+static FreelistAllocator											s_NUMAInterleavedAllocator;
+static ReplicatedJobPools											s_NUMAJobPools;
+
+class NUMA_Test : public Region_Test<NUMA_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<FreelistAllocator> { "numa/bound", SIZE_MB(1), &s_NUMABoundAllocator,
+				region_page_size::system_default, region_numa_policy::bind_node, 0 },
+			memory_region<FreelistAllocator> { "numa/interleaved", SIZE_MB(1), &s_NUMAInterleavedAllocator,
+				region_page_size::system_default, region_numa_policy::interleave },
+			memory_region<ReplicatedJobPools> { "numa/jobs", SIZE_KB(256), &s_NUMAJobPools }
+		);
+	}
+};
+
+TEST_F(NUMA_Test, Topology)
+{
+	const u32 nodeCount = detail::get_numa_node_count();
+	EXPECT_GE(nodeCount, 1u);
+	EXPECT_LE(nodeCount, (u32)HL_MAX_NUMA_NODES);
+	EXPECT_LT(detail::get_current_numa_node(), nodeCount);
+}
+
+TEST_F(NUMA_Test, Node_Lists)
+{
+	EXPECT_EQ(detail::parse_numa_node_list("0\n"), 0x1ull);
+	EXPECT_EQ(detail::parse_numa_node_list("0-3\n"), 0xFull);
+	EXPECT_EQ(detail::parse_numa_node_list("0,2-3\n"), 0xDull);
+	EXPECT_EQ(detail::parse_numa_node_list("1,4-5,7"), 0xB2ull);
+	EXPECT_EQ(detail::parse_numa_node_list("62-70"), 0xC000000000000000ull);
+	EXPECT_EQ(detail::parse_numa_node_list(""), 0ull);
+}
+
+TEST_F(NUMA_Test, Placed_Regions_Are_Usable)
+{
+	p8 bound = (p8)s_NUMABoundAllocator.allocate(SIZE_KB(512));
+	p8 interleaved = (p8)s_NUMAInterleavedAllocator.allocate(SIZE_KB(512));
+	ASSERT_NE(bound, nullptr);
+	ASSERT_NE(interleaved, nullptr);
+	memset(bound, 0x11, SIZE_KB(512));
+	memset(interleaved, 0x22, SIZE_KB(512));
+
+	u32 found = 0;
+	for (u32 i = 0; i < s_MemoryManager.p_mem_regions_count; i++) {
+		const memory_region_info& info = s_MemoryManager.p_mem_regions[i];
+		if (strcmp(info.name, "numa/bound") == 0) {
+			EXPECT_TRUE(info.numa_policy == region_numa_policy::bind_node);
+			found++;
+		} else if (strcmp(info.name, "numa/interleaved") == 0) {
+			EXPECT_TRUE(info.numa_policy == region_numa_policy::interleave);
+			found++;
+		}
+	}
+	EXPECT_EQ(found, 2u);
+}
+
+TEST_F(NUMA_Test, One_Replica_Per_Node)
+{
+	const u32 nodeCount = detail::get_numa_node_count();
+	EXPECT_EQ(s_NUMAJobPools.get_replica_count(), nodeCount);
+
+	for (u32 node = 0; node < nodeCount; node++) {
+		c8 name[64];
+		snprintf(name, sizeof(name), "numa/jobs/node%u", node);
+		bool found = false;
+		for (u32 i = 0; i < s_MemoryManager.p_mem_regions_count; i++) {
+			const memory_region_info& info = s_MemoryManager.p_mem_regions[i];
+			if (strcmp(info.name, name) == 0) {
+				EXPECT_EQ(info.numa_node, node);
+				EXPECT_EQ(info.allocator_ptr, (voidptr)&s_NUMAJobPools.get_replica(node));
+				found = true;
+			}
+		}
+		EXPECT_TRUE(found);
+	}
+}
+
+TEST_F(NUMA_Test, Replicas_Allocate_Locally_And_Free_To_Owner)
+{
+	std::vector<Job*> jobs(64);
+	for (size_t i = 0; i < jobs.size(); i++) {
+		jobs[i] = s_NUMAJobPools.allocate<Job>();
+		ASSERT_NE(jobs[i], nullptr);
+		EXPECT_EQ(&s_NUMAJobPools.get_owner_replica(jobs[i]), &s_NUMAJobPools.get_local_replica());
+	}
+
+	// freed from another thread, the slots still go back to their replica
+	std::thread worker([&jobs]() {
+		for (size_t i = 0; i < jobs.size(); i++) {
+			s_NUMAJobPools.free(jobs[i]);
+		}
+	});
+	worker.join();
+
+	for (u32 node = 0; node < s_NUMAJobPools.get_replica_count(); node++) {
+		EXPECT_EQ(s_NUMAJobPools.get_replica(node).get_used_bytes(), 0u);
+	}
+}
@@ -0,0 +1,63 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+using namespace helich;
+
+typedef allocator<stack_scheme, no_tracking_policy>					StackAllocator;
+typedef allocator<freelist_scheme, no_tracking_policy>				FreelistAllocator;
+
+static StackAllocator												s_PageStackAllocator;
+static FreelistAllocator											s_PageHugeFreelistAllocator;
+
+class PageBackend_Test : public Region_Test<PageBackend_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<StackAllocator> { "page/stack", SIZE_KB(64), &s_PageStackAllocator },
+			memory_region<FreelistAllocator> { "page/huge_freelist", SIZE_MB(4), &s_PageHugeFreelistAllocator, region_page_size::huge_2mb }
+		);
+	}
+};
+
+TEST_F(PageBackend_Test, Region_Bases_Are_Page_Aligned)
+{
+	const size systemPage = memory_manager::get_page_size_in_bytes(region_page_size::system_default);
+	EXPECT_TRUE(is_aligned(s_PageStackAllocator.get_base_address(), systemPage));
+	EXPECT_TRUE(is_aligned(s_PageHugeFreelistAllocator.get_base_address(), SIZE_MB(2)));
+}
+
+TEST_F(PageBackend_Test, Regions_Report_Page_Size)
+{
+	u32 found = 0;
+	for (u32 i = 0; i < s_MemoryManager.p_mem_regions_count; i++) {
+		const memory_region_info& info = s_MemoryManager.p_mem_regions[i];
+		if (strcmp(info.name, "page/huge_freelist") == 0) {
+			EXPECT_TRUE(info.page_size == region_page_size::huge_2mb);
+			found++;
+		} else {
+			EXPECT_TRUE(info.page_size == region_page_size::system_default);
+		}
+	}
+	EXPECT_EQ(found, 1u);
+}
+
+TEST_F(PageBackend_Test, Huge_Region_Is_Usable)
+{
+	p8 data = (p8)s_PageHugeFreelistAllocator.allocate(SIZE_MB(3));
+	ASSERT_NE(data, nullptr);
+	memset(data, 0xCD, SIZE_MB(3));
+	EXPECT_EQ(data[SIZE_MB(3) - 1], 0xCD);
+	s_PageHugeFreelistAllocator.free(data);
+}
+
+TEST_F(PageBackend_Test, Standalone_Allocator_Round_Trip)
+{
+	StackAllocator standalone;
+	memory_region<StackAllocator> region { "page/standalone", SIZE_KB(12), &standalone, region_page_size::huge_2mb };
+	s_MemoryManager.initialize_allocator(region);
+	EXPECT_TRUE(is_aligned(standalone.get_base_address(), SIZE_MB(2)));
+	EXPECT_NE(standalone.allocate(SIZE_KB(8)), nullptr);
+	s_MemoryManager.destroy_allocator(region);
+}
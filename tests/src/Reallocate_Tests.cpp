@@ -0,0 +1,94 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <string.h>
+
+using namespace helich;
+
+typedef allocator<stack_scheme, no_tracking_policy>					StackAllocator;
+typedef allocator<freelist_scheme, default_tracking_policy>			FreelistAllocator;
+
+static StackAllocator												s_ReallocStackAllocator;
+static FreelistAllocator											s_ReallocFreelistAllocator;
+
+class Reallocate_Test : public Region_Test<Reallocate_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<StackAllocator> { "realloc/stack", SIZE_KB(64), &s_ReallocStackAllocator },
+			memory_region<FreelistAllocator> { "realloc/freelist", SIZE_KB(64), &s_ReallocFreelistAllocator }
+		);
+	}
+};
+
+TEST_F(Reallocate_Test, Stack_Top_Grows_In_Place)
+{
+	p8 p = (p8)s_ReallocStackAllocator.allocate(16);
+	memset(p, 0xab, 16);
+	const size usedBefore = s_ReallocStackAllocator.get_used_bytes();
+
+	EXPECT_EQ(s_ReallocStackAllocator.reallocate(p, 1024), p);
+	EXPECT_EQ(s_ReallocStackAllocator.get_used_bytes(), usedBefore + 1024 - 16);
+	EXPECT_EQ(s_ReallocStackAllocator.reallocate(p, 8), p);
+	EXPECT_EQ(s_ReallocStackAllocator.get_used_bytes(), usedBefore - 8);
+	EXPECT_EQ(p[7], 0xab);
+
+	// not on top anymore: copied
+	s_ReallocStackAllocator.allocate(16);
+	p8 q = (p8)s_ReallocStackAllocator.reallocate(p, 64);
+	EXPECT_NE(q, p);
+	EXPECT_EQ(q[7], 0xab);
+}
+
+TEST_F(Reallocate_Test, Freelist_Grows_Into_Next_Free_Block)
+{
+	p8 p = (p8)s_ReallocFreelistAllocator.allocate(64);
+	voidptr hole = s_ReallocFreelistAllocator.allocate(512);
+	voidptr fence = s_ReallocFreelistAllocator.allocate(64);
+	memset(p, 0xcd, 64);
+	s_ReallocFreelistAllocator.free(hole);
+
+	// the freed neighbour is absorbed
+	EXPECT_EQ(s_ReallocFreelistAllocator.reallocate(p, 400), p);
+	EXPECT_EQ(p[63], 0xcd);
+	// shrinking gives the tail back
+	const size usedBig = s_ReallocFreelistAllocator.get_used_bytes();
+	EXPECT_EQ(s_ReallocFreelistAllocator.reallocate(p, 32), p);
+	EXPECT_LT(s_ReallocFreelistAllocator.get_used_bytes(), usedBig);
+
+	// the fence stops in-place growth
+	p8 q = (p8)s_ReallocFreelistAllocator.reallocate(p, 2048);
+	EXPECT_NE(q, p);
+	EXPECT_EQ(q[31], 0xcd);
+
+	s_ReallocFreelistAllocator.free(q);
+	s_ReallocFreelistAllocator.free(fence);
+	EXPECT_EQ(s_ReallocFreelistAllocator.get_used_bytes(), 0u);
+	EXPECT_NE(s_ReallocFreelistAllocator.allocate(SIZE_KB(60)), nullptr);
+}
+
+TEST_F(Reallocate_Test, In_Place_Updates_The_Tracked_Size)
+{
+	typedef FreelistAllocator::alloc_header_t HeaderType;
+	p8 p = (p8)s_ReallocFreelistAllocator.allocate(64, "resized");
+	const debug_entry* entry = ((HeaderType*)(p - sizeof(HeaderType)))->debug_info;
+	trace_table::trace liveTrace;
+	ASSERT_TRUE(g_tracked_traces.get_trace(entry->trace_id, liveTrace));
+	const u64 liveBytes = liveTrace.live_bytes - 64;
+
+	EXPECT_EQ(s_ReallocFreelistAllocator.reallocate(p, 400), p);
+	EXPECT_EQ(entry->size_in_bytes, 400u);
+	ASSERT_TRUE(g_tracked_traces.get_trace(entry->trace_id, liveTrace));
+	EXPECT_EQ(liveTrace.live_bytes, liveBytes + 400);
+
+	EXPECT_EQ(s_ReallocFreelistAllocator.reallocate(p, 32), p);
+	EXPECT_EQ(entry->size_in_bytes, 32u);
+
+	// the trace gets back exactly what it was given
+	const u32 traceId = entry->trace_id;
+	s_ReallocFreelistAllocator.free(p);
+	ASSERT_TRUE(g_tracked_traces.get_trace(traceId, liveTrace));
+	EXPECT_EQ(liveTrace.live_bytes, liveBytes);
+}
@@ -0,0 +1,51 @@
+#ifndef __HL_UTEST_REGION_TEST_H__
+#define __HL_UTEST_REGION_TEST_H__
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+inline bool is_aligned(voidptr i_ptr, const size i_alignment)
+{
+	return ((aptr)i_ptr & (i_alignment - 1)) == 0;
+}
+
+// base of the test fixtures: every suite has a memory manager of its own, its regions are mapped by
+// the first test and emptied before every test
+// eg.
+//	class Slab_Test : public Region_Test<Slab_Test> {
+//	protected:
+//		virtual void SetUp() {
+//			map_regions(
+//				memory_region<SlabAllocator> { "slab", SIZE_MB(4), &s_SlabAllocator }
+//			);
+//		}
+//	};
+template <class t_suite>
+class Region_Test : public testing::Test {
+protected:
+	template <class ... t_regions>
+	static void map_regions(t_regions ... i_regions)
+	{
+		s_MemoryManager.initialize(i_regions...);
+		free_all(i_regions...);
+	}
+
+	static helich::memory_manager			s_MemoryManager;
+
+private:
+	static void free_all()
+	{
+	}
+
+	template <class t_region, class ... t_regions>
+	static void free_all(const t_region& i_region, const t_regions& ... i_regions)
+	{
+		i_region.allocator_ptr->free_all();
+		free_all(i_regions...);
+	}
+};
+
+template <class t_suite>
+helich::memory_manager Region_Test<t_suite>::s_MemoryManager;
+
+#endif // __HL_UTEST_REGION_TEST_H__
@@ -0,0 +1,157 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+typedef allocator<freelist_scheme, sampled_tracking_policy>					SampledFreelistAllocator;
+typedef fixed_allocator<pool_scheme, 64, sampled_tracking_policy>			SampledPoolAllocator;
+
+static SampledFreelistAllocator												s_SampledFreelistAllocator;
+static SampledPoolAllocator													s_SampledPoolAllocator;
+
+class SampledTracking_Test : public Region_Test<SampledTracking_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<SampledFreelistAllocator> { "sampled/freelist", SIZE_MB(8), &s_SampledFreelistAllocator },
+			memory_region<SampledPoolAllocator> { "sampled/pool", SIZE_KB(256), &s_SampledPoolAllocator }
+		);
+	}
+
+	virtual void TearDown() {
+		sampled_tracking_policy::set_sample_interval(HL_SAMPLE_INTERVAL);
+	}
+};
+
+TEST_F(SampledTracking_Test, Every_Allocation_Sampled_With_Tiny_Interval)
+{
+	sampled_tracking_policy::set_sample_interval(1);
+	const u32 liveBefore = sampled_tracking_policy::get_live_sample_count();
+
+	voidptr blocks[16];
+	for (u32 i = 0; i < 16; i++) {
+		blocks[i] = s_SampledFreelistAllocator.allocate(100 + i, "sampled-block");
+		ASSERT_NE(blocks[i], nullptr);
+	}
+	EXPECT_EQ(sampled_tracking_policy::get_live_sample_count(), liveBefore + 16);
+
+	sample_entry samples[64];
+	const u32 copied = sampled_tracking_policy::copy_live_samples(samples, 64);
+	ASSERT_GE(copied, 16u);
+	// newest first
+	EXPECT_EQ(samples[0].size_in_bytes, 115u);
+	EXPECT_EQ(samples[0].sampled_bytes, 115u);
+	EXPECT_STREQ(samples[0].description, "sampled-block");
+
+	for (u32 i = 0; i < 16; i++) {
+		s_SampledFreelistAllocator.free(blocks[i]);
+	}
+	EXPECT_EQ(sampled_tracking_policy::get_live_sample_count(), liveBefore);
+}
+
+TEST_F(SampledTracking_Test, In_Place_Reallocate_Resizes_The_Sample)
+{
+	sampled_tracking_policy::set_sample_interval(1);
+	const size estimatedBefore = sampled_tracking_policy::get_estimated_live_bytes();
+
+	// alone in the region, it grows in place
+	voidptr block = s_SampledFreelistAllocator.allocate(200, "resized-sample");
+	ASSERT_NE(block, nullptr);
+	EXPECT_EQ(s_SampledFreelistAllocator.reallocate(block, 600), block);
+
+	sample_entry samples[1];
+	ASSERT_EQ(sampled_tracking_policy::copy_live_samples(samples, 1), 1u);
+	EXPECT_EQ(samples[0].size_in_bytes, 600u);
+	EXPECT_EQ(samples[0].sampled_bytes, 600u);
+	EXPECT_EQ(sampled_tracking_policy::get_estimated_live_bytes(), estimatedBefore + 600);
+
+	trace_table::trace sampledTrace;
+	ASSERT_TRUE(g_sampled_traces.get_trace(samples[0].trace_id, sampledTrace));
+	const u64 liveBytes = sampledTrace.live_bytes;
+	EXPECT_GE(liveBytes, 600u);
+
+	s_SampledFreelistAllocator.free(block);
+	EXPECT_EQ(sampled_tracking_policy::get_estimated_live_bytes(), estimatedBefore);
+	ASSERT_TRUE(g_sampled_traces.get_trace(samples[0].trace_id, sampledTrace));
+	EXPECT_EQ(sampledTrace.live_bytes, liveBytes - 600);
+}
+
+TEST_F(SampledTracking_Test, Unsampled_Frees_Leave_Samples_Alone)
+{
+	// one sample per 1GB: none of these is picked
+	sampled_tracking_policy::set_sample_interval(SIZE_GB(1));
+	const u32 liveBefore = sampled_tracking_policy::get_live_sample_count();
+
+	SampledPoolAllocator::alloc_scheme_t& pool = s_SampledPoolAllocator;
+	std::vector<voidptr> blocks;
+	for (u32 i = 0; i < 1000; i++) {
+		blocks.push_back(pool.allocate());
+	}
+	EXPECT_EQ(sampled_tracking_policy::get_live_sample_count(), liveBefore);
+
+	for (size_t i = 0; i < blocks.size(); i++) {
+		pool.free(blocks[i]);
+	}
+	EXPECT_EQ(sampled_tracking_policy::get_live_sample_count(), liveBefore);
+}
+
+TEST_F(SampledTracking_Test, Estimate_Of_Live_Bytes)
+{
+	// ~4MB live with one sample per 8KB: a few hundred samples
+	sampled_tracking_policy::set_sample_interval(SIZE_KB(8));
+	const size estimateBefore = sampled_tracking_policy::get_estimated_live_bytes();
+
+	std::vector<voidptr> blocks;
+	size liveBytes = 0;
+	for (u32 i = 0; i < 4000; i++) {
+		const size bytes = 64 + (i * 37) % 1900;
+		voidptr p = s_SampledFreelistAllocator.allocate(bytes);
+		ASSERT_NE(p, nullptr);
+		blocks.push_back(p);
+		liveBytes += bytes;
+	}
+
+	const f64 estimate = (f64)(sampled_tracking_policy::get_estimated_live_bytes() - estimateBefore);
+	EXPECT_NEAR(estimate / (f64)liveBytes, 1.0, 0.2);
+
+	for (size_t i = 0; i < blocks.size(); i++) {
+		s_SampledFreelistAllocator.free(blocks[i]);
+	}
+	EXPECT_EQ(sampled_tracking_policy::get_estimated_live_bytes(), estimateBefore);
+}
+
+TEST_F(SampledTracking_Test, Bulk_Release_Drops_Samples)
+{
+	sampled_tracking_policy::set_sample_interval(1);
+	const u32 liveBefore = sampled_tracking_policy::get_live_sample_count();
+
+	voidptr slots[32];
+	const u32 allocated = s_SampledPoolAllocator.allocate_bulk(32, slots);
+	ASSERT_EQ(allocated, 32u);
+	EXPECT_EQ(sampled_tracking_policy::get_live_sample_count(), liveBefore + 32);
+
+	s_SampledPoolAllocator.free_bulk(slots, allocated);
+	EXPECT_EQ(sampled_tracking_policy::get_live_sample_count(), liveBefore);
+}
+
+TEST_F(SampledTracking_Test, Free_All_Releases_Samples)
+{
+	sampled_tracking_policy::set_sample_interval(1);
+	SampledPoolAllocator::alloc_scheme_t& pool = s_SampledPoolAllocator;
+	for (u32 round = 0; round < 3; round++) {
+		for (u32 i = 0; i < 100; i++) {
+			ASSERT_NE(s_SampledFreelistAllocator.allocate(64 + i), nullptr);
+			ASSERT_NE(pool.allocate(), nullptr);
+		}
+		EXPECT_EQ(sampled_tracking_policy::get_live_sample_count(), 200u);
+
+		s_SampledFreelistAllocator.free_all();
+		s_SampledPoolAllocator.free_all();
+		EXPECT_EQ(sampled_tracking_policy::get_live_sample_count(), 0u);
+		EXPECT_EQ(sampled_tracking_policy::get_estimated_live_bytes(), 0u);
+	}
+}
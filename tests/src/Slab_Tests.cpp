@@ -0,0 +1,202 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+struct alignas(64) CacheLine {
+	u32 counter;
+};
+
+typedef allocator<slab_scheme, no_tracking_policy>				SlabAllocator;
+typedef allocator<slab_scheme, default_tracking_policy>			TrackedSlabAllocator;
+
+static SlabAllocator											s_SlabAllocator;
+static TrackedSlabAllocator										s_TrackedSlabAllocator;
+
+class Slab_Test : public Region_Test<Slab_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<SlabAllocator> { "slab/untracked", SIZE_MB(4), &s_SlabAllocator },
+			memory_region<TrackedSlabAllocator> { "slab/tracked", SIZE_MB(2), &s_TrackedSlabAllocator }
+		);
+	}
+};
+
+TEST_F(Slab_Test, Size_Classes)
+{
+	EXPECT_EQ(SlabAllocator::get_class_index(1), 0u);
+	EXPECT_EQ(SlabAllocator::get_class_index(8), 0u);
+	EXPECT_EQ(SlabAllocator::get_class_index(9), 1u);
+	EXPECT_EQ(SlabAllocator::get_class_index(128), 8u);
+	EXPECT_EQ(SlabAllocator::get_class_index(129), 9u);
+	EXPECT_EQ(SlabAllocator::get_class_index(4096), (u32)(SlabAllocator::k_class_count - 1));
+	EXPECT_EQ(SlabAllocator::get_class_size(SlabAllocator::k_class_count - 1), 4096u);
+
+	// every size fits its class, and would not fit the class below
+	const u32 classCount = SlabAllocator::k_class_count;
+	for (size bytes = 1; bytes <= SlabAllocator::k_max_small_size; bytes++) {
+		const u32 classIndex = SlabAllocator::get_class_index(bytes);
+		ASSERT_LT(classIndex, classCount);
+		ASSERT_GE(SlabAllocator::get_class_size(classIndex), bytes);
+		if (classIndex > 0) {
+			ASSERT_LT(SlabAllocator::get_class_size(classIndex - 1), bytes);
+		}
+	}
+}
+
+TEST_F(Slab_Test, Mixed_Sizes)
+{
+	std::vector<p8> ptrs;
+	std::vector<size> sizes;
+	for (u32 i = 0; i < 1000; i++) {
+		const size bytes = 8 + (i * 37) % 4089;
+		p8 p = (p8)s_SlabAllocator.allocate(bytes);
+		ASSERT_NE(p, nullptr);
+		EXPECT_TRUE(is_aligned(p, 8));
+		memset(p, (u8)i, bytes);
+		ptrs.push_back(p);
+		sizes.push_back(bytes);
+	}
+
+	for (size_t i = 0; i < ptrs.size(); i++) {
+		EXPECT_EQ(ptrs[i][0], (u8)i);
+		EXPECT_EQ(ptrs[i][sizes[i] - 1], (u8)i);
+		s_SlabAllocator.free(ptrs[i]);
+	}
+	EXPECT_EQ(s_SlabAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(Slab_Test, Slots_Are_Reused)
+{
+	const u32 classIndex = SlabAllocator::get_class_index(48);
+	voidptr a = s_SlabAllocator.allocate(48);
+	voidptr b = s_SlabAllocator.allocate(40);
+	s_SlabAllocator.free(a);
+	EXPECT_EQ(s_SlabAllocator.allocate(33), a);
+
+	SlabAllocator::class_stats stats = s_SlabAllocator.get_class_stats(classIndex);
+	EXPECT_EQ(stats.class_size, 48u);
+	EXPECT_EQ(stats.slab_count, 1u);
+	EXPECT_EQ(stats.live_slots, 2u);
+	EXPECT_EQ(stats.alloc_count, 3u);
+	EXPECT_EQ(stats.free_count, 1u);
+	EXPECT_EQ(s_SlabAllocator.get_used_bytes(), 2 * stats.slot_size);
+	s_SlabAllocator.free(b);
+}
+
+TEST_F(Slab_Test, Empty_Slabs_Go_Back_To_The_Region)
+{
+	const size remainBytes = s_SlabAllocator.get_remain_bytes();
+
+	// 3 slabs worth of 4KB blocks
+	std::vector<voidptr> ptrs;
+	for (u32 i = 0; i < 45; i++) {
+		ptrs.push_back(s_SlabAllocator.allocate(4096));
+	}
+	const u32 lastClass = SlabAllocator::k_class_count - 1;
+	EXPECT_GE(s_SlabAllocator.get_class_stats(lastClass).slab_count, 3u);
+	for (size_t i = 0; i < ptrs.size(); i++) {
+		s_SlabAllocator.free(ptrs[i]);
+	}
+
+	// the class keeps one empty slab, the others can serve any class
+	EXPECT_EQ(s_SlabAllocator.get_class_stats(lastClass).slab_count, 1u);
+	EXPECT_EQ(s_SlabAllocator.get_remain_bytes(), remainBytes - SlabAllocator::k_slab_size);
+	s_SlabAllocator.trim();
+
+	voidptr p = s_SlabAllocator.allocate(24);
+	ASSERT_NE(p, nullptr);
+	memset(p, 0xCD, 24);
+	EXPECT_EQ(s_SlabAllocator.get_remain_bytes(), remainBytes - 2 * SlabAllocator::k_slab_size);
+}
+
+TEST_F(Slab_Test, Allocate_Aligned)
+{
+	for (u32 i = 0; i < 64; i++) {
+		const size alignment = (size)8 << (i % 4);
+		voidptr p = s_SlabAllocator.allocate_aligned(i + 1, alignment);
+		ASSERT_NE(p, nullptr);
+		EXPECT_TRUE(is_aligned(p, alignment));
+	}
+
+	CacheLine* c = s_SlabAllocator.allocate<CacheLine>();
+	ASSERT_NE(c, nullptr);
+	EXPECT_TRUE(is_aligned(c, 64));
+	s_SlabAllocator.free(c);
+}
+
+TEST_F(Slab_Test, Free_Sized)
+{
+	// 24 bytes aligned to 64 comes from a bigger class than plain 24 bytes, the size and alignment find it again
+	voidptr small = s_TrackedSlabAllocator.allocate(24);
+	voidptr aligned = s_TrackedSlabAllocator.allocate_aligned(24, 64);
+	ASSERT_NE(small, nullptr);
+	ASSERT_NE(aligned, nullptr);
+	const u32 smallClass = TrackedSlabAllocator::get_class_index(24);
+	const u32 alignedClass = TrackedSlabAllocator::get_class_index(s_TrackedSlabAllocator.get_usable_size(aligned));
+	EXPECT_NE(smallClass, alignedClass);
+
+	s_TrackedSlabAllocator.free_sized(small, 24, 8);
+	s_TrackedSlabAllocator.free_sized(aligned, 24, 64);
+	EXPECT_EQ(s_TrackedSlabAllocator.get_class_stats(smallClass).live_slots, 0u);
+	EXPECT_EQ(s_TrackedSlabAllocator.get_class_stats(alignedClass).live_slots, 0u);
+	EXPECT_EQ(s_TrackedSlabAllocator.get_used_bytes(), 0u);
+
+	// and the slots are handed out again
+	EXPECT_EQ(s_TrackedSlabAllocator.allocate(24), small);
+	EXPECT_EQ(s_TrackedSlabAllocator.allocate_aligned(24, 64), aligned);
+}
+
+TEST_F(Slab_Test, Tracked_Allocate_Aligned)
+{
+	// the tracked header is not a multiple of the alignments by itself
+	for (u32 i = 0; i < 64; i++) {
+		const size alignment = (size)8 << (i % 4);
+		voidptr p = s_TrackedSlabAllocator.allocate_aligned(i * 7 + 1, alignment);
+		ASSERT_NE(p, nullptr);
+		EXPECT_TRUE(is_aligned(p, alignment));
+	}
+
+	CacheLine* c = s_TrackedSlabAllocator.allocate<CacheLine>();
+	ASSERT_NE(c, nullptr);
+	EXPECT_TRUE(is_aligned(c, 64));
+	s_TrackedSlabAllocator.free(c);
+}
+
+TEST_F(Slab_Test, Reallocate)
+{
+	p8 p = (p8)s_SlabAllocator.allocate(20);
+	memset(p, 0x5A, 20);
+
+	// same class, stays in place
+	EXPECT_EQ(s_SlabAllocator.reallocate(p, 30), p);
+
+	p8 q = (p8)s_SlabAllocator.reallocate(p, 1000);
+	ASSERT_NE(q, nullptr);
+	EXPECT_NE(q, p);
+	for (u32 i = 0; i < 20; i++) {
+		EXPECT_EQ(q[i], 0x5A);
+	}
+	s_SlabAllocator.free(q);
+	EXPECT_EQ(s_SlabAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(Slab_Test, Tracking)
+{
+	const size trackedBytes = g_tracking_allocator.get_used_bytes();
+	std::vector<voidptr> ptrs;
+	for (u32 i = 0; i < 100; i++) {
+		ptrs.push_back(s_TrackedSlabAllocator.allocate(16 + i * 16, "slab-test"));
+	}
+	EXPECT_GT(g_tracking_allocator.get_used_bytes(), trackedBytes);
+	for (size_t i = 0; i < ptrs.size(); i++) {
+		s_TrackedSlabAllocator.free(ptrs[i]);
+	}
+	EXPECT_EQ(g_tracking_allocator.get_used_bytes(), trackedBytes);
+	EXPECT_EQ(s_TrackedSlabAllocator.get_used_bytes(), 0u);
+}
@@ -0,0 +1,59 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+using namespace helich;
+
+typedef allocator<stack_scheme, default_tracking_policy>			TrackedStackAllocator;
+typedef allocator<stack_scheme, compact_header_policy<no_tracking_policy>>	CompactStackAllocator;
+
+static TrackedStackAllocator										s_TrackedStackAllocator;
+static CompactStackAllocator										s_CompactStackAllocator;
+
+class StackMarker_Test : public Region_Test<StackMarker_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<TrackedStackAllocator> { "marker/tracked", SIZE_KB(64), &s_TrackedStackAllocator },
+			memory_region<CompactStackAllocator> { "marker/compact", SIZE_KB(64), &s_CompactStackAllocator }
+		);
+	}
+};
+
+TEST_F(StackMarker_Test, Free_To_Marker)
+{
+	int* keep = s_TrackedStackAllocator.allocate<int>(7);
+	const size usedBefore = s_TrackedStackAllocator.get_used_bytes();
+	TrackedStackAllocator::marker m = s_TrackedStackAllocator.get_marker();
+
+	for (int i = 0; i < 32; i++) {
+		s_TrackedStackAllocator.allocate(i * 3 + 1, "scratch");
+	}
+	EXPECT_GT(s_TrackedStackAllocator.get_used_bytes(), usedBefore);
+
+	s_TrackedStackAllocator.free_to_marker(m);
+	EXPECT_EQ(s_TrackedStackAllocator.get_used_bytes(), usedBefore);
+	EXPECT_EQ(*keep, 7);
+
+	// the remaining allocation is still the top of the stack and can be freed in order
+	s_TrackedStackAllocator.free(keep);
+	EXPECT_EQ(s_TrackedStackAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(StackMarker_Test, Scoped_Stack_Frame)
+{
+	s_CompactStackAllocator.allocate(100);
+	const size usedBefore = s_CompactStackAllocator.get_used_bytes();
+	{
+		scoped_stack_frame<CompactStackAllocator> outer(s_CompactStackAllocator);
+		s_CompactStackAllocator.allocate(200);
+		{
+			scoped_stack_frame<CompactStackAllocator> inner(s_CompactStackAllocator);
+			s_CompactStackAllocator.allocate_podarray<float>(64);
+		}
+		voidptr p = s_CompactStackAllocator.allocate(16);
+		EXPECT_NE(p, nullptr);
+	}
+	EXPECT_EQ(s_CompactStackAllocator.get_used_bytes(), usedBefore);
+}
@@ -0,0 +1,136 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+#include <helich/std_allocator.h>
+
+#include <list>
+#include <map>
+#include <vector>
+
+using namespace helich;
+
+typedef allocator<stack_scheme, no_tracking_policy>					StackAllocator;
+typedef allocator<freelist_scheme, no_tracking_policy>				FreelistAllocator;
+typedef fixed_allocator<pool_scheme, 64, no_tracking_policy>		NodePoolAllocator;
+typedef allocator<slab_scheme, no_tracking_policy>					SlabAllocator;
+
+static StackAllocator												s_StdStackAllocator;
+static FreelistAllocator											s_StdFreelistAllocator;
+static NodePoolAllocator											s_StdPoolAllocator;
+static SlabAllocator												s_StdSlabAllocator;
+
+class StdAllocator_Test : public Region_Test<StdAllocator_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<StackAllocator> { "std/stack", SIZE_KB(256), &s_StdStackAllocator },
+			memory_region<FreelistAllocator> { "std/freelist", SIZE_KB(256), &s_StdFreelistAllocator },
+			memory_region<NodePoolAllocator> { "std/pool", SIZE_KB(64), &s_StdPoolAllocator },
+			memory_region<SlabAllocator> { "std/slab", SIZE_MB(2), &s_StdSlabAllocator }
+		);
+	}
+};
+
+TEST_F(StdAllocator_Test, Pmr_Vector_On_Freelist)
+{
+	memory_resource<FreelistAllocator> resource(&s_StdFreelistAllocator);
+	{
+		std::pmr::vector<u32> values(&resource);
+		for (u32 i = 0; i < 1000; i++) {
+			values.push_back(i);
+		}
+		EXPECT_EQ(values[999], 999u);
+		EXPECT_GE(s_StdFreelistAllocator.get_used_bytes(), 1000 * sizeof(u32));
+	}
+	EXPECT_EQ(s_StdFreelistAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(StdAllocator_Test, Pmr_Map_On_Pool)
+{
+	memory_resource<NodePoolAllocator> resource(&s_StdPoolAllocator);
+	{
+		std::pmr::map<u32, u32> squares(&resource);
+		for (u32 i = 0; i < 100; i++) {
+			squares[i] = i * i;
+		}
+		EXPECT_EQ(squares[12], 144u);
+		EXPECT_EQ(s_StdPoolAllocator.get_used_bytes(), 100 * (s_StdPoolAllocator.get_used_bytes() / 100));
+		EXPECT_NE(s_StdPoolAllocator.get_used_bytes(), 0u);
+	}
+	EXPECT_EQ(s_StdPoolAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(StdAllocator_Test, Stl_Allocator_Alignment_And_Rebind)
+{
+	struct alignas(32) Wide {
+		f32 lanes[8];
+	};
+	typedef stl_allocator<Wide, FreelistAllocator> WideAllocator;
+	EXPECT_EQ(sizeof(WideAllocator), sizeof(voidptr));
+
+	std::vector<Wide, WideAllocator> wides{ WideAllocator(&s_StdFreelistAllocator) };
+	for (u32 i = 0; i < 50; i++) {
+		wides.push_back(Wide());
+		EXPECT_EQ((aptr)wides.data() & 31, 0u);
+	}
+
+	// rebound copies point to the same allocator
+	stl_allocator<u8, FreelistAllocator> bytes(wides.get_allocator());
+	EXPECT_TRUE(bytes == wides.get_allocator());
+	std::list<u32, stl_allocator<u32, FreelistAllocator>> values(bytes);
+	values.push_back(1);
+	values.push_back(2);
+	EXPECT_EQ(values.size(), 2u);
+}
+
+TEST_F(StdAllocator_Test, Sized_Free_On_Stack)
+{
+	// the stack only pops the top frame, the frames a growing vector leaves behind stay until free_to_marker()
+	StackAllocator::marker marker = s_StdStackAllocator.get_marker();
+	memory_resource<StackAllocator> resource(&s_StdStackAllocator);
+	{
+		std::pmr::vector<u64> values(&resource);
+		for (u32 i = 0; i < 1000; i++) {
+			values.push_back(i);
+		}
+		EXPECT_EQ(values[500], 500u);
+	}
+	EXPECT_NE(s_StdStackAllocator.get_used_bytes(), 0u);
+	s_StdStackAllocator.free_to_marker(marker);
+	EXPECT_EQ(s_StdStackAllocator.get_used_bytes(), 0u);
+
+	// a single top frame is popped right away
+	voidptr p = resource.allocate(100, 16);
+	resource.deallocate(p, 100, 16);
+	EXPECT_EQ(s_StdStackAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(StdAllocator_Test, Sized_Free_On_Slab_And_Pool)
+{
+	static_assert(detail::has_sized_free<SlabAllocator::alloc_scheme_t>::value, "slab_scheme has free_sized()");
+	static_assert(detail::has_sized_free<NodePoolAllocator::alloc_scheme_t>::value, "pool_scheme has free_sized()");
+
+	memory_resource<SlabAllocator> slabResource(&s_StdSlabAllocator);
+	{
+		std::pmr::vector<u32> values(&slabResource);
+		std::pmr::map<u32, u64> entries(&slabResource);
+		for (u32 i = 0; i < 500; i++) {
+			values.push_back(i);
+			entries[i] = i;
+		}
+		EXPECT_EQ(values[250], 250u);
+		EXPECT_EQ(entries[499], 499u);
+	}
+	EXPECT_EQ(s_StdSlabAllocator.get_used_bytes(), 0u);
+
+	memory_resource<NodePoolAllocator> poolResource(&s_StdPoolAllocator);
+	{
+		std::pmr::list<u64> values(&poolResource);
+		for (u32 i = 0; i < 100; i++) {
+			values.push_back(i);
+		}
+		EXPECT_EQ(values.size(), 100u);
+	}
+	EXPECT_EQ(s_StdPoolAllocator.get_used_bytes(), 0u);
+}
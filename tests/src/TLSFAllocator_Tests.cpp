@@ -0,0 +1,129 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+#include <string.h>
+
+using namespace helich;
+
+typedef allocator<tlsf_scheme, no_tracking_policy>	TLSFAllocator;
+
+static TLSFAllocator								s_TLSFAllocator;
+
+class TLSF_Test : public Region_Test<TLSF_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<TLSFAllocator> { "tlsf", SIZE_KB(256), &s_TLSFAllocator }
+		);
+	}
+};
+
+TEST_F(TLSF_Test, Allocate_And_Free)
+{
+	int* a = s_TLSFAllocator.allocate<int>(0x11111111);
+	int* b = s_TLSFAllocator.allocate<int>(0x22222222);
+	EXPECT_EQ(*a, 0x11111111);
+	EXPECT_EQ(*b, 0x22222222);
+	EXPECT_GT(s_TLSFAllocator.get_used_bytes(), 0u);
+
+	s_TLSFAllocator.free(a);
+	s_TLSFAllocator.free(b);
+	EXPECT_EQ(s_TLSFAllocator.get_used_bytes(), 0u);
+	EXPECT_EQ(s_TLSFAllocator.p_alloc_count, s_TLSFAllocator.p_free_count);
+}
+
+TEST_F(TLSF_Test, Coalesce_Whole_Region)
+{
+	// fragment the region, free everything out of order, then the whole region must fit again
+	std::vector<voidptr> ptrs;
+	for (unsigned int i = 0; i < 256; i++) {
+		voidptr p = s_TLSFAllocator.allocate(16 + (i * 37) % 400);
+		ASSERT_NE(p, nullptr);
+		ptrs.push_back(p);
+	}
+	for (size_t i = 0; i < ptrs.size(); i += 2) {
+		s_TLSFAllocator.free(ptrs[i]);
+	}
+	for (size_t i = 1; i < ptrs.size(); i += 2) {
+		s_TLSFAllocator.free(ptrs[i]);
+	}
+	EXPECT_EQ(s_TLSFAllocator.get_used_bytes(), 0u);
+
+	voidptr big = s_TLSFAllocator.allocate(SIZE_KB(128));
+	EXPECT_NE(big, nullptr);
+	s_TLSFAllocator.free(big);
+}
+
+TEST_F(TLSF_Test, Reallocate_Keeps_Data)
+{
+	u8* data = (u8*)s_TLSFAllocator.allocate(64);
+	for (u32 i = 0; i < 64; i++) {
+		data[i] = (u8)i;
+	}
+	u8* newData = (u8*)s_TLSFAllocator.reallocate(data, 1024);
+	ASSERT_NE(newData, nullptr);
+	for (u32 i = 0; i < 64; i++) {
+		EXPECT_EQ(newData[i], (u8)i);
+	}
+	s_TLSFAllocator.free(newData);
+	EXPECT_EQ(s_TLSFAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(TLSF_Test, Reallocate_Null_Allocates)
+{
+	voidptr data = s_TLSFAllocator.reallocate(nullptr, 128);
+	ASSERT_NE(data, nullptr);
+	EXPECT_GE(s_TLSFAllocator.get_usable_size(data), 128u);
+	s_TLSFAllocator.free(data);
+	EXPECT_EQ(s_TLSFAllocator.get_used_bytes(), 0u);
+}
+
+TEST_F(TLSF_Test, Reallocate_Shrinks_In_Place)
+{
+	u8* data = (u8*)s_TLSFAllocator.allocate(SIZE_KB(4));
+	voidptr fence = s_TLSFAllocator.allocate(64);
+	memset(data, 0x5e, 256);
+	const size usedBefore = s_TLSFAllocator.get_used_bytes();
+
+	// the tail goes back to the free lists, even with a live block right after it
+	EXPECT_EQ(s_TLSFAllocator.reallocate(data, 256), data);
+	EXPECT_LT(s_TLSFAllocator.get_used_bytes(), usedBefore);
+	EXPECT_EQ(data[255], 0x5e);
+	voidptr tail = s_TLSFAllocator.allocate(SIZE_KB(2));
+	EXPECT_GT((u8*)tail, data);
+	EXPECT_LT((u8*)tail, (u8*)fence);
+
+	s_TLSFAllocator.free(tail);
+	s_TLSFAllocator.free(fence);
+	s_TLSFAllocator.free(data);
+	EXPECT_EQ(s_TLSFAllocator.get_used_bytes(), 0u);
+	EXPECT_NE(s_TLSFAllocator.allocate(SIZE_KB(200)), nullptr);
+}
+
+TEST_F(TLSF_Test, Reallocate_Grows_Into_Next_Free_Block)
+{
+	u8* data = (u8*)s_TLSFAllocator.allocate(64);
+	voidptr hole = s_TLSFAllocator.allocate(SIZE_KB(1));
+	voidptr fence = s_TLSFAllocator.allocate(64);
+	memset(data, 0x7a, 64);
+	s_TLSFAllocator.free(hole);
+
+	// the freed neighbour is absorbed
+	EXPECT_EQ(s_TLSFAllocator.reallocate(data, 512), data);
+	EXPECT_EQ(data[63], 0x7a);
+	EXPECT_GE(s_TLSFAllocator.get_usable_size(data), 512u);
+
+	// the fence stops in-place growth
+	u8* movedData = (u8*)s_TLSFAllocator.reallocate(data, SIZE_KB(4));
+	ASSERT_NE(movedData, nullptr);
+	EXPECT_NE(movedData, data);
+	EXPECT_EQ(movedData[63], 0x7a);
+
+	s_TLSFAllocator.free(movedData);
+	s_TLSFAllocator.free(fence);
+	EXPECT_EQ(s_TLSFAllocator.get_used_bytes(), 0u);
+	EXPECT_NE(s_TLSFAllocator.allocate(SIZE_KB(200)), nullptr);
+}
@@ -0,0 +1,158 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <stdio.h>
+#include <string>
+
+using namespace helich;
+
+typedef allocator<freelist_scheme, sampled_tracking_policy>					SampledFreelistAllocator;
+
+static SampledFreelistAllocator												s_TraceSampledAllocator;
+static trace_table															s_TraceTable;
+
+// EXPECT_* takes its arguments by reference
+static const u32															k_NoTrace = trace_table::k_no_trace;
+
+class TraceTable_Test : public Region_Test<TraceTable_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<SampledFreelistAllocator> { "trace/sampled", SIZE_MB(4), &s_TraceSampledAllocator }
+		);
+	}
+
+	virtual void TearDown() {
+		sampled_tracking_policy::set_sample_interval(HL_SAMPLE_INTERVAL);
+	}
+};
+
+static std::string ReadBack(FILE* file)
+{
+	std::string content;
+	rewind(file);
+	char buffer[1024];
+	size_t readBytes = 0;
+	while ((readBytes = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		content.append(buffer, readBytes);
+	}
+	fclose(file);
+	return content;
+}
+
+static u32 CaptureFromHere(const u32 i_depth)
+{
+	// the volatile store keeps the calls out of tail position, every level stays on the stack
+	volatile u32 id = (i_depth > 0) ? CaptureFromHere(i_depth - 1) : s_TraceTable.capture(0);
+	return id;
+}
+
+TEST_F(TraceTable_Test, Identical_Stacks_Share_An_Id)
+{
+	voidptr stackA[3] = { (voidptr)0x1000, (voidptr)0x2000, (voidptr)0x3000 };
+	voidptr stackB[3] = { (voidptr)0x1000, (voidptr)0x2000, (voidptr)0x3004 };
+	const u32 countBefore = s_TraceTable.get_trace_count();
+
+	const u32 idA = s_TraceTable.intern(stackA, 3);
+	const u32 idB = s_TraceTable.intern(stackB, 3);
+	EXPECT_NE(idA, k_NoTrace);
+	EXPECT_NE(idB, k_NoTrace);
+	EXPECT_NE(idA, idB);
+	EXPECT_EQ(s_TraceTable.intern(stackA, 3), idA);
+	EXPECT_EQ(s_TraceTable.get_trace_count(), countBefore + 2);
+
+	// an empty stack has no id
+	EXPECT_EQ(s_TraceTable.intern(stackA, 0), k_NoTrace);
+}
+
+TEST_F(TraceTable_Test, Captured_Call_Sites)
+{
+	// not a constant, the loop must not be unrolled into two call sites
+	volatile u32 loopCount = 2;
+	u32 ids[2];
+	for (u32 i = 0; i < loopCount; i++) {
+		ids[i] = CaptureFromHere(0);
+	}
+	const u32 otherId = CaptureFromHere(2);
+
+	ASSERT_NE(ids[0], k_NoTrace);
+	EXPECT_EQ(ids[0], ids[1]);
+	EXPECT_NE(ids[0], otherId);
+
+	trace_table::trace capturedTrace;
+	ASSERT_TRUE(s_TraceTable.get_trace(ids[0], capturedTrace));
+	EXPECT_GT(capturedTrace.frame_count, 1u);
+}
+
+TEST_F(TraceTable_Test, Live_And_Total_Counters)
+{
+	voidptr stack[2] = { (voidptr)0x4000, (voidptr)0x5000 };
+	const u32 id = s_TraceTable.intern(stack, 2);
+	ASSERT_NE(id, k_NoTrace);
+
+	s_TraceTable.add_allocation(id, 100, 400);
+	s_TraceTable.add_allocation(id, 50, 50);
+	s_TraceTable.remove_allocation(id, 100, 400);
+
+	trace_table::trace counted;
+	ASSERT_TRUE(s_TraceTable.get_trace(id, counted));
+	EXPECT_EQ(counted.live_count, 1u);
+	EXPECT_EQ(counted.live_bytes, 50u);
+	EXPECT_EQ(counted.live_weighted_bytes, 50u);
+	EXPECT_EQ(counted.total_count, 2u);
+	EXPECT_EQ(counted.total_bytes, 150u);
+
+	EXPECT_FALSE(s_TraceTable.get_trace(k_NoTrace, counted));
+}
+
+TEST_F(TraceTable_Test, Tracked_Allocations_Reference_Their_Stack)
+{
+	tracked_alloc_header memHeader;
+	default_tracking_policy::register_allocation(&memHeader, 96, "traced", __FILE__, __LINE__);
+	const u32 id = memHeader.debug_info->trace_id;
+	ASSERT_NE(id, k_NoTrace);
+
+	trace_table::trace liveTrace;
+	ASSERT_TRUE(g_tracked_traces.get_trace(id, liveTrace));
+	const u64 liveBytes = liveTrace.live_bytes;
+	EXPECT_GE(liveBytes, 96u);
+
+	default_tracking_policy::unregister_allocation(&memHeader);
+	ASSERT_TRUE(g_tracked_traces.get_trace(id, liveTrace));
+	EXPECT_EQ(liveTrace.live_bytes, liveBytes - 96);
+}
+
+TEST_F(TraceTable_Test, Sampled_Exports)
+{
+	sampled_tracking_policy::set_sample_interval(1);
+	voidptr blocks[8];
+	for (u32 i = 0; i < 8; i++) {
+		blocks[i] = s_TraceSampledAllocator.allocate(200, "exported");
+		ASSERT_NE(blocks[i], nullptr);
+	}
+
+	sample_entry samples[1];
+	ASSERT_EQ(sampled_tracking_policy::copy_live_samples(samples, 1), 1u);
+	EXPECT_NE(samples[0].trace_id, k_NoTrace);
+
+	FILE* pprofFile = tmpfile();
+	ASSERT_NE(pprofFile, nullptr);
+	g_sampled_traces.write_pprof_heap(pprofFile, sampled_tracking_policy::get_sample_interval());
+	const std::string pprof = ReadBack(pprofFile);
+	EXPECT_EQ(pprof.compare(0, 14, "heap profile: "), 0);
+	EXPECT_NE(pprof.find("@ heap_v2/1\n"), std::string::npos);
+	EXPECT_NE(pprof.find(" @ 0x"), std::string::npos);
+
+	FILE* foldedFile = tmpfile();
+	ASSERT_NE(foldedFile, nullptr);
+	g_sampled_traces.write_folded_stacks(foldedFile);
+	const std::string folded = ReadBack(foldedFile);
+	EXPECT_NE(folded.find(';'), std::string::npos);
+	EXPECT_NE(folded.find(" 1600\n"), std::string::npos);
+
+	for (u32 i = 0; i < 8; i++) {
+		s_TraceSampledAllocator.free(blocks[i]);
+	}
+}
@@ -0,0 +1,107 @@
+#include "RegionTest.h"
+
+#include <gtest/gtest.h>
+#include <helich.h>
+
+#include <vector>
+
+using namespace helich;
+
+typedef allocator<stack_scheme, no_tracking_policy>					StackAllocator;
+typedef allocator<freelist_scheme, default_tracking_policy>			FreelistAllocator;
+typedef allocator<tlsf_scheme, default_tracking_policy>				TLSFAllocator;
+typedef fixed_allocator<pool_scheme, SIZE_KB(16), no_tracking_policy>	BigSlotPoolAllocator;
+
+static StackAllocator												s_TrimStackAllocator;
+static FreelistAllocator											s_TrimFreelistAllocator;
+static TLSFAllocator												s_TrimTLSFAllocator;
+static BigSlotPoolAllocator											s_TrimPoolAllocator;
+
+class Trim_Test : public Region_Test<Trim_Test> {
+protected:
+	virtual void SetUp() {
+		map_regions(
+			memory_region<StackAllocator> { "trim/stack", SIZE_MB(2), &s_TrimStackAllocator },
+			memory_region<FreelistAllocator> { "trim/freelist", SIZE_MB(4), &s_TrimFreelistAllocator },
+			memory_region<TLSFAllocator> { "trim/tlsf", SIZE_MB(4), &s_TrimTLSFAllocator },
+			memory_region<BigSlotPoolAllocator> { "trim/pool", SIZE_KB(512), &s_TrimPoolAllocator }
+		);
+	}
+};
+
+TEST_F(Trim_Test, Stack_Releases_Pages_Above_Marker)
+{
+	p8 data = (p8)s_TrimStackAllocator.allocate(SIZE_KB(512));
+	memset(data, 0xAA, SIZE_KB(512));
+	s_TrimStackAllocator.free_all();
+
+	EXPECT_GE(s_TrimStackAllocator.trim(), SIZE_MB(2) - SIZE_KB(64));
+	// purged pages read back as zeros
+	EXPECT_EQ(data[SIZE_KB(256)], 0);
+}
+
+template <class t_allocator>
+static void check_free_blocks_are_trimmed(t_allocator& io_allocator)
+{
+	p8 a = (p8)io_allocator.allocate(SIZE_MB(1));
+	p8 b = (p8)io_allocator.allocate(64);
+	p8 c = (p8)io_allocator.allocate(SIZE_MB(1));
+	memset(a, 0xAA, SIZE_MB(1));
+	memset(c, 0xCC, SIZE_MB(1));
+	io_allocator.free(a);
+	io_allocator.free(c);
+
+	EXPECT_GE(io_allocator.trim(), SIZE_MB(2) - SIZE_KB(64));
+	EXPECT_EQ(a[SIZE_KB(512)], 0);
+
+	// the block headers survived, the blocks are reused and coalesce back
+	p8 d = (p8)io_allocator.allocate(SIZE_MB(1));
+	ASSERT_NE(d, nullptr);
+	memset(d, 0xDD, SIZE_MB(1));
+	io_allocator.free(d);
+	io_allocator.free(b);
+	EXPECT_EQ(io_allocator.get_used_bytes(), 0u);
+	EXPECT_NE(io_allocator.allocate(SIZE_MB(3)), nullptr);
+}
+
+TEST_F(Trim_Test, Freelist_Releases_Free_Blocks)
+{
+	check_free_blocks_are_trimmed(s_TrimFreelistAllocator);
+}
+
+TEST_F(Trim_Test, TLSF_Releases_Free_Blocks)
+{
+	check_free_blocks_are_trimmed(s_TrimTLSFAllocator);
+}
+
+TEST_F(Trim_Test, Pool_Keeps_Free_Slot_Links)
+{
+	// raw slots, fixed_allocator only exposes typed allocations
+	BigSlotPoolAllocator::alloc_scheme_t& pool = s_TrimPoolAllocator;
+	std::vector<voidptr> slots;
+	while (voidptr p = pool.allocate()) {
+		memset(p, 0xEE, SIZE_KB(16));
+		slots.push_back(p);
+	}
+	const size slotCount = slots.size();
+	for (size_t i = 0; i < slotCount; i += 2) {
+		pool.free(slots[i]);
+	}
+
+	EXPECT_GT(pool.trim(), 0u);
+
+	size reallocated = 0;
+	while (pool.allocate()) {
+		reallocated++;
+	}
+	EXPECT_EQ(reallocated, (slotCount + 1) / 2);
+}
+
+TEST_F(Trim_Test, Trim_All)
+{
+	p8 data = (p8)s_TrimFreelistAllocator.allocate(SIZE_MB(1));
+	memset(data, 0xAB, SIZE_MB(1));
+	s_TrimFreelistAllocator.free(data);
+
+	EXPECT_GE(s_MemoryManager.trim_all(), SIZE_MB(1));
+}